@@ -0,0 +1,572 @@
+#include <benchmark/benchmark.h>
+
+#include "simd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/*
+ * Every operation runs over arrays in four ways:
+ *
+ *   Scalar   plain loop with auto vectorization turned off
+ *   Auto     the same loop, left to the compiler (-O3 -march=native)
+ *   Simd128  Vect128f / Vect128i
+ *   Native   NativeVectf / NativeVecti, the widest enabled vector
+ *
+ * Arguments are the array length and an offset in values from a 64 byte
+ * boundary, 0 uses aligned load & store, anything else loadu & storeu.
+ * Lengths that aren't a multiple of the vector width end with
+ * load_partial & store_partial.
+ *
+ * Run with --benchmark_filter=Add to compare one operation.
+ */
+
+using namespace sight;
+
+#if defined(__clang__)
+    #define SIGHT_NO_VECTORIZE
+    #define SIGHT_SCALAR_LOOP \
+        _Pragma("clang loop vectorize(disable) interleave(disable)")
+#else
+    #define SIGHT_NO_VECTORIZE __attribute__((optimize("no-tree-vectorize")))
+    #define SIGHT_SCALAR_LOOP
+#endif
+
+namespace {
+
+// Kinds of loops
+struct Scalar {};
+struct Auto {};
+struct Simd128 {};
+struct Native {};
+
+template <typename Kind, typename T>
+struct VectOf;
+
+template <typename T>
+struct VectOf<Simd128, T> {
+    typedef Vect<T, 16 / sizeof(T)> type;
+};
+
+template <typename T>
+struct VectOf<Native, T> {
+    typedef NativeVect<T> type;
+};
+
+// Bits of a float or int32, so the scalar loops can do bitwise operations
+template <typename T>
+uint32_t bitsOf(T v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+template <typename T>
+T fromBits(uint32_t bits) {
+    T v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+// Comparison results as stored by the vectors, every bit set or none
+template <typename T>
+T laneMask(bool set) {
+    return fromBits<T>(set ? ~0u : 0u);
+}
+
+template <typename V, typename M>
+V laneMask(const M& m) {
+    return m;
+}
+
+#ifdef HAVE_AVX512F
+// Comparisons of 512 bit vectors give a mask register instead
+template <typename V>
+V laneMask(const Mask512& m) {
+    return select(m, ~V(0), V(0));
+}
+#endif
+
+// Binary operations
+
+struct Add {
+    template <typename T>
+    static T scalar(T a, T b) {
+        return a + b;
+    }
+    template <typename V>
+    static V vect(const V& a, const V& b) {
+        return a + b;
+    }
+};
+
+struct Sub {
+    template <typename T>
+    static T scalar(T a, T b) {
+        return a - b;
+    }
+    template <typename V>
+    static V vect(const V& a, const V& b) {
+        return a - b;
+    }
+};
+
+struct Mul {
+    template <typename T>
+    static T scalar(T a, T b) {
+        return a * b;
+    }
+    template <typename V>
+    static V vect(const V& a, const V& b) {
+        return a * b;
+    }
+};
+
+struct Div {
+    template <typename T>
+    static T scalar(T a, T b) {
+        return a / b;
+    }
+    template <typename V>
+    static V vect(const V& a, const V& b) {
+        return a / b;
+    }
+};
+
+struct And {
+    template <typename T>
+    static T scalar(T a, T b) {
+        return fromBits<T>(bitsOf(a) & bitsOf(b));
+    }
+    template <typename V>
+    static V vect(const V& a, const V& b) {
+        return a & b;
+    }
+};
+
+struct Or {
+    template <typename T>
+    static T scalar(T a, T b) {
+        return fromBits<T>(bitsOf(a) | bitsOf(b));
+    }
+    template <typename V>
+    static V vect(const V& a, const V& b) {
+        return a | b;
+    }
+};
+
+struct Xor {
+    template <typename T>
+    static T scalar(T a, T b) {
+        return fromBits<T>(bitsOf(a) ^ bitsOf(b));
+    }
+    template <typename V>
+    static V vect(const V& a, const V& b) {
+        return a ^ b;
+    }
+};
+
+struct Lowest {
+    template <typename T>
+    static T scalar(T a, T b) {
+        return std::min(a, b);
+    }
+    template <typename V>
+    static V vect(const V& a, const V& b) {
+        return lowest(a, b);
+    }
+};
+
+struct Highest {
+    template <typename T>
+    static T scalar(T a, T b) {
+        return std::max(a, b);
+    }
+    template <typename V>
+    static V vect(const V& a, const V& b) {
+        return highest(a, b);
+    }
+};
+
+struct Equal {
+    template <typename T>
+    static T scalar(T a, T b) {
+        return laneMask<T>(a == b);
+    }
+    template <typename V>
+    static V vect(const V& a, const V& b) {
+        return laneMask<V>(a == b);
+    }
+};
+
+struct NotEqual {
+    template <typename T>
+    static T scalar(T a, T b) {
+        return laneMask<T>(a != b);
+    }
+    template <typename V>
+    static V vect(const V& a, const V& b) {
+        return laneMask<V>(a != b);
+    }
+};
+
+struct Less {
+    template <typename T>
+    static T scalar(T a, T b) {
+        return laneMask<T>(a < b);
+    }
+    template <typename V>
+    static V vect(const V& a, const V& b) {
+        return laneMask<V>(a < b);
+    }
+};
+
+struct LessEqual {
+    template <typename T>
+    static T scalar(T a, T b) {
+        return laneMask<T>(a <= b);
+    }
+    template <typename V>
+    static V vect(const V& a, const V& b) {
+        return laneMask<V>(a <= b);
+    }
+};
+
+struct Greater {
+    template <typename T>
+    static T scalar(T a, T b) {
+        return laneMask<T>(a > b);
+    }
+    template <typename V>
+    static V vect(const V& a, const V& b) {
+        return laneMask<V>(a > b);
+    }
+};
+
+struct GreaterEqual {
+    template <typename T>
+    static T scalar(T a, T b) {
+        return laneMask<T>(a >= b);
+    }
+    template <typename V>
+    static V vect(const V& a, const V& b) {
+        return laneMask<V>(a >= b);
+    }
+};
+
+// Unary operations, the result type can be different
+
+struct Copy {
+    template <typename T>
+    static T scalar(T a) {
+        return a;
+    }
+    template <typename V>
+    static V vect(const V& a) {
+        return a;
+    }
+};
+
+struct Sqrt {
+    static float scalar(float a) {
+        return std::sqrt(a);
+    }
+    template <typename V>
+    static V vect(const V& a) {
+        return sqrt(a);
+    }
+};
+
+struct Rsqrt {
+    static float scalar(float a) {
+        return 1 / std::sqrt(a);
+    }
+    template <typename V>
+    static V vect(const V& a) {
+        return rsqrt(a);
+    }
+};
+
+struct Reciprocal {
+    static float scalar(float a) {
+        return 1 / a;
+    }
+    template <typename V>
+    static V vect(const V& a) {
+        return reciprocal(a);
+    }
+};
+
+struct SqrtPrecise {
+    static float scalar(float a) {
+        return std::sqrt(a);
+    }
+    template <typename V>
+    static V vect(const V& a) {
+        return sqrt_precise(a);
+    }
+};
+
+struct RsqrtPrecise {
+    static float scalar(float a) {
+        return 1 / std::sqrt(a);
+    }
+    template <typename V>
+    static V vect(const V& a) {
+        return rsqrt_precise(a);
+    }
+};
+
+struct ReciprocalPrecise {
+    static float scalar(float a) {
+        return 1 / a;
+    }
+    template <typename V>
+    static V vect(const V& a) {
+        return reciprocal_precise(a);
+    }
+};
+
+struct RsqrtRefined {
+    static float scalar(float a) {
+        return 1 / std::sqrt(a);
+    }
+    template <typename V>
+    static V vect(const V& a) {
+        return rsqrt_refined(a);
+    }
+};
+
+struct ReciprocalRefined {
+    static float scalar(float a) {
+        return 1 / a;
+    }
+    template <typename V>
+    static V vect(const V& a) {
+        return reciprocal_refined(a);
+    }
+};
+
+struct ToInt {
+    static int32_t scalar(float a) {
+        return static_cast<int32_t>(a);
+    }
+    template <typename V>
+    static Vect<int32_t, V::lanes> vect(const V& a) {
+        return a.to_int();
+    }
+};
+
+struct ToFloat {
+    static float scalar(int32_t a) {
+        return static_cast<float>(a);
+    }
+    template <typename V>
+    static Vect<float, V::lanes> vect(const V& a) {
+        return a;
+    }
+};
+
+// Loops
+
+template <typename Op, typename T>
+SIGHT_NO_VECTORIZE void run(Scalar, const T* __restrict a,
+                            const T* __restrict b, T* __restrict r,
+                            size_t n, bool) {
+    SIGHT_SCALAR_LOOP
+    for (size_t i = 0; i < n; i++) {
+        r[i] = Op::scalar(a[i], b[i]);
+    }
+}
+
+template <typename Op, typename T>
+void run(Auto, const T* __restrict a, const T* __restrict b,
+         T* __restrict r, size_t n, bool) {
+    for (size_t i = 0; i < n; i++) {
+        r[i] = Op::scalar(a[i], b[i]);
+    }
+}
+
+template <typename Op, typename T, typename Kind>
+void run(Kind, const T* a, const T* b, T* r, size_t n, bool aligned) {
+    typedef typename VectOf<Kind, T>::type V;
+    size_t i = 0;
+    if (aligned) {
+        for (; i + V::lanes <= n; i += V::lanes) {
+            Op::vect(V::load(a + i), V::load(b + i)).store(r + i);
+        }
+    } else {
+        for (; i + V::lanes <= n; i += V::lanes) {
+            Op::vect(V::loadu(a + i), V::loadu(b + i)).storeu(r + i);
+        }
+    }
+    if (i < n) {
+        int rest = static_cast<int>(n - i);
+        Op::vect(V::load_partial(a + i, rest), V::load_partial(b + i, rest))
+            .store_partial(r + i, rest);
+    }
+}
+
+template <typename Op, typename T, typename R>
+SIGHT_NO_VECTORIZE void run(Scalar, const T* __restrict a, R* __restrict r,
+                            size_t n, bool) {
+    SIGHT_SCALAR_LOOP
+    for (size_t i = 0; i < n; i++) {
+        r[i] = Op::scalar(a[i]);
+    }
+}
+
+template <typename Op, typename T, typename R>
+void run(Auto, const T* __restrict a, R* __restrict r, size_t n, bool) {
+    for (size_t i = 0; i < n; i++) {
+        r[i] = Op::scalar(a[i]);
+    }
+}
+
+template <typename Op, typename T, typename R, typename Kind>
+void run(Kind, const T* a, R* r, size_t n, bool aligned) {
+    typedef typename VectOf<Kind, T>::type V;
+    size_t i = 0;
+    if (aligned) {
+        for (; i + V::lanes <= n; i += V::lanes) {
+            Op::vect(V::load(a + i)).store(r + i);
+        }
+    } else {
+        for (; i + V::lanes <= n; i += V::lanes) {
+            Op::vect(V::loadu(a + i)).storeu(r + i);
+        }
+    }
+    if (i < n) {
+        int rest = static_cast<int>(n - i);
+        Op::vect(V::load_partial(a + i, rest)).store_partial(r + i, rest);
+    }
+}
+
+// Benchmarks
+
+template <typename T>
+void fill(AlignedStorage<T, 64>& s) {
+    for (size_t i = 0; i < s.length(); i++) {
+        s[i] = static_cast<T>(1 + i % 97);  // positive, never 0
+    }
+}
+
+template <typename T>
+void count(benchmark::State& state, size_t n, int arrays) {
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetBytesProcessed(state.iterations() * n * arrays * sizeof(T));
+}
+
+template <typename Op, typename T, typename Kind>
+void binary(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const int offset = static_cast<int>(state.range(1));
+    AlignedStorage<T, 64> a(n + 16), b(n + 16), r(n + 16);
+    fill(a);
+    fill(b);
+    for (auto _ : state) {
+        run<Op>(Kind(), a + offset, b + offset, r + offset, n, offset == 0);
+        benchmark::DoNotOptimize(static_cast<T*>(r));
+        benchmark::ClobberMemory();
+    }
+    count<T>(state, n, 3);
+}
+
+template <typename Op, typename T, typename R, typename Kind>
+void unary(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const int offset = static_cast<int>(state.range(1));
+    AlignedStorage<T, 64> a(n + 16);
+    AlignedStorage<R, 64> r(n + 16);
+    fill(a);
+    for (auto _ : state) {
+        run<Op>(Kind(), a + offset, r + offset, n, offset == 0);
+        benchmark::DoNotOptimize(static_cast<R*>(r));
+        benchmark::ClobberMemory();
+    }
+    count<T>(state, n, 2);
+}
+
+// Streaming stores only exist for aligned vectors
+template <typename Kind>
+void stream(benchmark::State& state) {
+    typedef typename VectOf<Kind, float>::type V;
+    const size_t n = state.range(0);
+    AlignedStorage<float, 64> a(n + 16), r(n + 16);
+    fill(a);
+    for (auto _ : state) {
+        for (size_t i = 0; i + V::lanes <= n; i += V::lanes) {
+            V::load(a + i).stream(r + i);
+        }
+        streamFence();
+        benchmark::DoNotOptimize(static_cast<float*>(r));
+        benchmark::ClobberMemory();
+    }
+    count<float>(state, n, 2);
+}
+
+// From L1 to well past the last level cache, aligned and not
+void arrays(benchmark::internal::Benchmark* b) {
+    for (int64_t n : {16, 1023, 1 << 16, 1 << 22}) {
+        for (int64_t offset : {0, 1}) {
+            b->Args({n, offset});
+        }
+    }
+}
+
+}  // namespace
+
+#define SIGHT_BENCH_KINDS(name, ...)                                     \
+    BENCHMARK_TEMPLATE(name, __VA_ARGS__, Scalar)->Apply(arrays);        \
+    BENCHMARK_TEMPLATE(name, __VA_ARGS__, Auto)->Apply(arrays);          \
+    BENCHMARK_TEMPLATE(name, __VA_ARGS__, Simd128)->Apply(arrays);       \
+    BENCHMARK_TEMPLATE(name, __VA_ARGS__, Native)->Apply(arrays)
+
+SIGHT_BENCH_KINDS(binary, Add, float);
+SIGHT_BENCH_KINDS(binary, Sub, float);
+SIGHT_BENCH_KINDS(binary, Mul, float);
+SIGHT_BENCH_KINDS(binary, Div, float);
+SIGHT_BENCH_KINDS(binary, Lowest, float);
+SIGHT_BENCH_KINDS(binary, Highest, float);
+SIGHT_BENCH_KINDS(binary, And, float);
+SIGHT_BENCH_KINDS(binary, Or, float);
+SIGHT_BENCH_KINDS(binary, Xor, float);
+SIGHT_BENCH_KINDS(binary, Equal, float);
+SIGHT_BENCH_KINDS(binary, NotEqual, float);
+SIGHT_BENCH_KINDS(binary, Less, float);
+SIGHT_BENCH_KINDS(binary, LessEqual, float);
+SIGHT_BENCH_KINDS(binary, Greater, float);
+SIGHT_BENCH_KINDS(binary, GreaterEqual, float);
+
+SIGHT_BENCH_KINDS(binary, Add, int32_t);
+SIGHT_BENCH_KINDS(binary, Sub, int32_t);
+SIGHT_BENCH_KINDS(binary, Mul, int32_t);
+SIGHT_BENCH_KINDS(binary, And, int32_t);
+SIGHT_BENCH_KINDS(binary, Or, int32_t);
+SIGHT_BENCH_KINDS(binary, Xor, int32_t);
+SIGHT_BENCH_KINDS(binary, Lowest, int32_t);
+SIGHT_BENCH_KINDS(binary, Highest, int32_t);
+SIGHT_BENCH_KINDS(binary, Equal, int32_t);
+SIGHT_BENCH_KINDS(binary, NotEqual, int32_t);
+SIGHT_BENCH_KINDS(binary, Less, int32_t);
+SIGHT_BENCH_KINDS(binary, LessEqual, int32_t);
+SIGHT_BENCH_KINDS(binary, Greater, int32_t);
+SIGHT_BENCH_KINDS(binary, GreaterEqual, int32_t);
+
+SIGHT_BENCH_KINDS(unary, Copy, float, float);
+SIGHT_BENCH_KINDS(unary, Sqrt, float, float);
+SIGHT_BENCH_KINDS(unary, Rsqrt, float, float);
+SIGHT_BENCH_KINDS(unary, Reciprocal, float, float);
+SIGHT_BENCH_KINDS(unary, SqrtPrecise, float, float);
+SIGHT_BENCH_KINDS(unary, RsqrtPrecise, float, float);
+SIGHT_BENCH_KINDS(unary, ReciprocalPrecise, float, float);
+SIGHT_BENCH_KINDS(unary, RsqrtRefined, float, float);
+SIGHT_BENCH_KINDS(unary, ReciprocalRefined, float, float);
+SIGHT_BENCH_KINDS(unary, ToInt, float, int32_t);
+SIGHT_BENCH_KINDS(unary, ToFloat, int32_t, float);
+
+BENCHMARK_TEMPLATE(stream, Simd128)->Arg(1 << 16)->Arg(1 << 22);
+BENCHMARK_TEMPLATE(stream, Native)->Arg(1 << 16)->Arg(1 << 22);
+
+BENCHMARK_MAIN();
@@ -22,177 +22,143 @@
 #ifdef __AVX2__
     #define HAVE_AVX2
 #endif
+#ifdef __FMA__
+    #define HAVE_FMA
+#endif
+#ifdef __AVX512F__
+    #define HAVE_AVX512F
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    #define HAVE_NEON
+    #define HAVE_FMA
+#endif
 
 #if defined(HAVE_SSE) \
     || defined(HAVE_AVX) \
-    || defined(HAVE_AVX2)
+    || defined(HAVE_AVX2) \
+    || defined(HAVE_AVX512F)
     #include <x86intrin.h>
+#elif defined(HAVE_NEON)
+    #include <arm_neon.h>
+#else
+    #error "SSE/AVX or NEON is required for compiling"
+#endif
+
+/*
+ * GCC 12 warns at -O2 -Wall that the _mm512_undefined_* values some AVX-512
+ * intrinsics use for their unused lanes may be used uninitialized, also in
+ * the target("avx512f") kernels of builds without AVX-512. Code using those
+ * intrinsics is wrapped in these
+ */
+#if defined(__GNUC__) && !defined(__clang__)
+    #define SIGHT_AVX512_WARNINGS_BEGIN \
+        _Pragma("GCC diagnostic push") \
+        _Pragma("GCC diagnostic ignored \"-Wmaybe-uninitialized\"") \
+        _Pragma("GCC diagnostic ignored \"-Wuninitialized\"")
+    #define SIGHT_AVX512_WARNINGS_END _Pragma("GCC diagnostic pop")
 #else
-    #error "SSE/AVX is required for compiling"
+    #define SIGHT_AVX512_WARNINGS_BEGIN
+    #define SIGHT_AVX512_WARNINGS_END
 #endif
 
-#include <memory>
+#include <cstdint>
 
 namespace sight {
 
 /**
- * @brief Smart pointer that aligns to boundary for fast load & store
+ * @brief SIMD vector of Lanes values of type T
  *
- * @param T type of underlying data
- * @param Align alignment in memory
- */
-template <typename T, int Align>
-class AlignedStorage {
-  public:
-    /// Length of allocated data
-    const size_t length;
-
-    /**
-     * @brief Allocates data
-     *
-     * @param length amount of data to allocate (how many T's)
-     */
-    explicit AlignedStorage(size_t length)
-        : length(length),
-          raw(static_cast<T*>(malloc((length * sizeof(T)) + Align)), free),
-          raw_val(reinterpret_cast<uintptr_t>(raw.get())),
-          aligned(reinterpret_cast<T*>(raw_val + (Align - (raw_val % Align)))) {
-    }
-
-    /// Sets all data to 0
-    inline void clear() const {
-        memset(aligned, 0, length * sizeof(T));
-    }
-
-    /// Casts to a non-const pointer
-    inline operator T*() {
-        return aligned;
-    }
-
-    /// Casts to a const pointer
-    inline operator const T*() const {
-        return aligned;
-    }
-
-    /**
-     * @brief Returns an offset pointer
-     *
-     * @param i offset from main pointer
-     * @return pointer of data + i
-     */
-    inline T* operator+(int i) {
-        return static_cast<T*>(aligned + i);
-    }
-
-    /**
-     * @brief Returns an offset const pointer
-     *
-     * @param i offset from main pointer
-     * @return pointer of data + i
-     */
-    inline const T* operator+(int i) const {
-        return static_cast<const T*>(aligned + i);
-    }
-
-    /**
-     * @brief Returns an offset pointer
-     *
-     * @param i offset from main pointer
-     * @return pointer of data - i
-     */
-    inline T* operator-(int i) {
-        return aligned - i;
-    }
-
-    /**
-     * @brief Returns an offset const pointer
-     *
-     * @param i offset from main pointer
-     * @return pointer of data - i
-     */
-    inline const T* operator-(int i) const {
-        return aligned - i;
-    }
-
-    /**
-     * @brief Returns data at an index
-     *
-     * @param i index of data
-     * @return writable reference to data
-     */
-    inline T& operator[](int i) {
-        return aligned[i];
-    }
-
-    /**
-     * @brief Returns data at an index
-     *
-     * @param i index of data
-     * @return data found at index
-     */
-    inline const T& operator[](int i) const {
-        return aligned[i];
-    }
-
-    /**
-     * @brief Returns data at an index, with a bounds check
-     *
-     * @param i index of data
-     * @return writable reference to data
-     */
-    inline T& at(int i) {
-        if (i < 0 || i >= length) {
-            throw std::out_of_range("outside of aligned storage boundary");
-        }
-        return aligned[i];
-    }
-
-    /**
-     * @brief Returns data at an index, with a bounds check
-     *
-     * @param i index of data
-     * @return data found at index
-     */
-    inline const T& at(int i) const {
-        if (i < 0 || i >= length) {
-            throw std::out_of_range("outside of aligned storage boundary");
-        }
-        return aligned[i];
-    }
-
-  private:
-    const std::shared_ptr<T> raw;
-    const uintptr_t raw_val;
-    T* aligned;
-};
-
-/**
- * @brief Checks if a pointer is properly aligned to a boundary
+ * Only the widths enabled for the target are specialized, see simd_128.hpp,
+ * simd_256.hpp and simd_512.hpp, or simd_neon.hpp on ARM. Each one has the
+ * same interface, so code can be written once against Vect<T, Lanes> (or
+ * NativeVect<T>)
  *
- * @param Align alignment of pointer
- * @param T type of data to be used
- * @param ptr pointer to data you want to be aligned
- * @return if ptr is aligned to Align (ie. ptr % Align == 0)
+ * @param T type of each lane
+ * @param Lanes amount of values in the vector
  */
-template <int Align, typename T>
-inline bool isAligned(const T* ptr) {
-    return reinterpret_cast<uintptr_t>(ptr) % Align == 0;
-}
+template <typename T, int Lanes>
+class Vect;
+
+/// Width in bytes of the widest vector enabled at compile time
+#if defined(HAVE_AVX512F)
+constexpr int native_width = 64;
+#elif defined(HAVE_AVX)
+constexpr int native_width = 32;
+#else
+constexpr int native_width = 16;
+#endif
+
+/// Widest vector of T enabled at compile time
+template <typename T>
+using NativeVect = Vect<T, native_width / sizeof(T)>;
+
+/// Widest float32 vector enabled at compile time
+using NativeVectf = NativeVect<float>;
+
+/// Widest int32 vector enabled at compile time
+using NativeVecti = NativeVect<int32_t>;
+
+namespace detail {
 
 /**
- * @brief Checks if there is enough room in length for M more elements
+ * @brief Widest vector of T lanes that exists for every T
  *
- * @param M elements in a "leap"
- * @param index current index inside of length
- * @param length total length
- * @return index + M <= length
+ * Only float and int32 have 256 and 512 bit vectors, bytes, shorts, int64
+ * and doubles come in 128 bits, so this is the default of every kernel
+ * that takes any T
  */
-template <int M>
-inline bool room(int index, int length) {
-    return index + M <= length;
-}
+template <typename T>
+struct Widest {
+    typedef Vect<T, 16 / sizeof(T)> type;
+};
+
+template <>
+struct Widest<float> {
+    typedef NativeVectf type;
+};
+
+template <>
+struct Widest<int32_t> {
+    typedef NativeVecti type;
+};
+
+}  // namespace detail
 
 }  // namespace sight
 
+// Aligned memory
+#include "simd_memory.hpp"
+#include "simd_pages.hpp"
+
+// Counters, see SIGHT_INSTRUMENT
+#include "simd_stats.hpp"
+
 // SIMD implementations
-#include "simd_128.hpp"
+#ifdef HAVE_NEON
+    #include "simd_neon.hpp"
+#else
+    #include "simd_128.hpp"
+    #include "simd_128d.hpp"
+    #include "simd_128_int.hpp"
+    #include "simd_256.hpp"
+    #include "simd_512.hpp"
+#endif
+
+// Math functions
+#include "simd_convert.hpp"
+#include "simd_math.hpp"
+#include "simd_divisor.hpp"
+
+// Kernels over arrays
+#include "simd_unroll.hpp"
+#ifdef HAVE_SSE
+    #include "simd_dispatch.hpp"
+#endif
+#include "simd_bulk.hpp"
+#include "simd_parallel.hpp"
+#include "simd_expr.hpp"
+#include "simd_scan.hpp"
+#include "simd_matrix.hpp"
+
+// Containers
+#include "simd_soa.hpp"
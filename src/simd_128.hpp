@@ -2,30 +2,77 @@
 
 #include "simd.hpp"
 #include <cstdint>
+#include <cstring>
 #include <algorithm>
 
 namespace sight {
-class Vect128f;  // forward declared
+using Vect128i = Vect<int32_t, 4>;
+using Vect128f = Vect<float, 4>;
+
+namespace detail {
+
+/**
+ * @brief n all-ones 32 bit values followed by zeros (n from 0 to 16)
+ *
+ * Loading a vector from here gives the mask for maskload & maskstore of
+ * the first n lanes
+ */
+inline const int32_t* firstLanes(int n) {
+    alignas(64) static const int32_t masks[32] = {
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    return masks + 16 - n;
+}
+
+/// Mask for _mm_maskload & maskstore of the first n (0 to 4) lanes
+inline __m128i laneMask128(int n) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(firstLanes(n)));
+}
+
+/// load_partial() through a zeroed buffer, for when there's no maskload
+template <typename V, typename T>
+inline V loadPartial(const T* p, int n) {
+    alignas(V) T buf[V::lanes] = {};
+    memcpy(buf, p, n * sizeof(T));
+    return V::load(buf);
+}
+
+/// store_partial() through a buffer, for when there's no maskstore
+template <typename V, typename T>
+inline void storePartial(const V& v, T* p, int n) {
+    alignas(V) T buf[V::lanes];
+    v.store(buf);
+    memcpy(p, buf, n * sizeof(T));
+}
+
+}  // namespace detail
 
 /**
  * @brief 128 bit vector of int32
  */
-class Vect128i {
+template <>
+class Vect<int32_t, 4> {
   private:
     __m128i val;
 
   public:
+    /// Type of each lane
+    typedef int32_t value_type;
+
+    /// Number of lanes in the vector
+    enum { lanes = 4 };
+
     /**
      * @brief Empty vector
      */
-    inline Vect128i() {}
+    inline Vect() {}
 
     /**
      * @brief Fill vector with i
      *
      * @param i value to set every entry to
      */
-    inline explicit Vect128i(int32_t i) {
+    inline explicit Vect(int32_t i) {
         val = _mm_set1_epi32(i);
     }
 
@@ -34,14 +81,14 @@ class Vect128i {
      *
      * @param v vector to use
      */
-    inline Vect128i(__m128i v) : val(v) {}  // NOLINT(runtime/explicit)
+    inline Vect(__m128i v) : val(v) {}  // NOLINT(runtime/explicit)
 
     /**
      * @brief Fill vector with values
      *
      * @param i0, i1, i2, i3 values to use
      */
-    inline Vect128i(int32_t i0, int32_t i1, int32_t i2, int32_t i3) {
+    inline Vect(int32_t i0, int32_t i1, int32_t i2, int32_t i3) {
         val = _mm_setr_epi32(i0, i1, i2, i3);
     }
 
@@ -69,6 +116,7 @@ class Vect128i {
      * @param p loads 128 bits starting at p
      */
     static inline Vect128i loadu(const int32_t* p) {
+        SIGHT_COUNT(UnalignedLoad);
         return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
     }
 
@@ -81,9 +129,29 @@ class Vect128i {
      * @param p loads 128 bits starting at p
      */
     static inline Vect128i load(const int32_t* p) {
+        SIGHT_COUNT(AlignedLoad);
         return _mm_load_si128(reinterpret_cast<const __m128i*>(p));
     }
 
+    /**
+     * @brief Loads the first n values from p, the other lanes are 0
+     *
+     * Nothing past p + n is read, so this is safe at the end of an array
+     *
+     * @param p values to load, no alignment needed
+     * @param n amount of values, 0 to 4
+     */
+    static inline Vect128i load_partial(const int32_t* p, int n) {
+        SIGHT_COUNT(PartialLoad);
+        #ifdef HAVE_AVX
+        __m128i mask = detail::laneMask128(n);
+        return _mm_castps_si128(
+            _mm_maskload_ps(reinterpret_cast<const float*>(p), mask));
+        #else
+        return detail::loadPartial<Vect128i>(p, n);
+        #endif
+    }
+
     /**
      * @brief Inserts the vector in a point in memory
      *
@@ -93,6 +161,7 @@ class Vect128i {
      * @param p stores 128 bits starting at p
      */
     inline void storeu(int32_t* p) const {
+        SIGHT_COUNT(UnalignedStore);
         _mm_storeu_si128(reinterpret_cast<__m128i*>(p), val);
     }
 
@@ -105,9 +174,44 @@ class Vect128i {
      * @param p stores 128 bits starting at p
      */
     inline void store(int32_t* p) const {
+        SIGHT_COUNT(AlignedStore);
         _mm_store_si128(reinterpret_cast<__m128i*>(p), val);
     }
 
+    /**
+     * @brief Inserts this vector in a aligned point in memory, bypassing
+     * the cache
+     *
+     * A non-temporal store, for results that won't be read again soon
+     * (ie. arrays larger than the last level cache). Call streamFence()
+     * before other threads read the data
+     *
+     * @param p stores 128 bits starting at p
+     */
+    inline void stream(int32_t* p) const {
+        SIGHT_COUNT(StreamStore);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(p), val);
+    }
+
+    /**
+     * @brief Stores the first n values to p
+     *
+     * Nothing past p + n is written, so this is safe at the end of an array
+     *
+     * @param p where to store, no alignment needed
+     * @param n amount of values, 0 to 4
+     */
+    inline void store_partial(int32_t* p, int n) const {
+        SIGHT_COUNT(PartialStore);
+        #ifdef HAVE_AVX
+        __m128i mask = detail::laneMask128(n);
+        _mm_maskstore_ps(reinterpret_cast<float*>(p), mask,
+                         _mm_castsi128_ps(val));
+        #else
+        detail::storePartial(*this, p, n);
+        #endif
+    }
+
     /**
      * @brief Sets vector values to native __m128i
      *
@@ -312,22 +416,29 @@ class Vect128i {
 /**
  * @brief 128 bit vector of float32
  */
-class Vect128f {
+template <>
+class Vect<float, 4> {
   private:
     __m128 val;
 
   public:
+    /// Type of each lane
+    typedef float value_type;
+
+    /// Number of lanes in the vector
+    enum { lanes = 4 };
+
     /**
      * @brief Empty vector
      */
-    inline Vect128f() {}
+    inline Vect() {}
 
     /**
      * @brief Fill vector with i
      *
      * @param i value to set every entry to
      */
-    inline explicit Vect128f(float i) {
+    inline explicit Vect(float i) {
         val = _mm_set1_ps(i);
     }
 
@@ -336,14 +447,14 @@ class Vect128f {
      *
      * @param v vector to use
      */
-    inline Vect128f(__m128 v) : val(v) {}  // NOLINT(runtime/explicit)
+    inline Vect(__m128 v) : val(v) {}  // NOLINT(runtime/explicit)
 
     /**
      * @brief Fill vector with values
      *
      * @param i0, i1, i2, i3 values to use
      */
-    inline Vect128f(float i0, float i1, float i2, float i3) {
+    inline Vect(float i0, float i1, float i2, float i3) {
         val = _mm_setr_ps(i0, i1, i2, i3);
     }
 
@@ -371,6 +482,7 @@ class Vect128f {
      * @param p loads 128 bits starting at p
      */
     static inline Vect128f loadu(const float* p) {
+        SIGHT_COUNT(UnalignedLoad);
         return _mm_loadu_ps(p);
     }
 
@@ -383,9 +495,28 @@ class Vect128f {
      * @param p loads 128 bits starting at p
      */
     static inline Vect128f load(const float* p) {
+        SIGHT_COUNT(AlignedLoad);
         return _mm_load_ps(p);
     }
 
+    /**
+     * @brief Loads the first n values from p, the other lanes are 0
+     *
+     * Nothing past p + n is read, so this is safe at the end of an array
+     *
+     * @param p values to load, no alignment needed
+     * @param n amount of values, 0 to 4
+     */
+    static inline Vect128f load_partial(const float* p, int n) {
+        SIGHT_COUNT(PartialLoad);
+        #ifdef HAVE_AVX
+        __m128i mask = detail::laneMask128(n);
+        return _mm_maskload_ps(p, mask);
+        #else
+        return detail::loadPartial<Vect128f>(p, n);
+        #endif
+    }
+
     /**
      * @brief Inserts the vector in a point in memory
      *
@@ -395,6 +526,7 @@ class Vect128f {
      * @param p stores 128 bits starting at p
      */
     inline void storeu(float* p) const {
+        SIGHT_COUNT(UnalignedStore);
         _mm_storeu_ps(p, val);
     }
 
@@ -407,9 +539,43 @@ class Vect128f {
      * @param p stores 128 bits starting at p
      */
     inline void store(float* p) const {
+        SIGHT_COUNT(AlignedStore);
         _mm_store_ps(p, val);
     }
 
+    /**
+     * @brief Inserts this vector in a aligned point in memory, bypassing
+     * the cache
+     *
+     * A non-temporal store, for results that won't be read again soon
+     * (ie. arrays larger than the last level cache). Call streamFence()
+     * before other threads read the data
+     *
+     * @param p stores 128 bits starting at p
+     */
+    inline void stream(float* p) const {
+        SIGHT_COUNT(StreamStore);
+        _mm_stream_ps(p, val);
+    }
+
+    /**
+     * @brief Stores the first n values to p
+     *
+     * Nothing past p + n is written, so this is safe at the end of an array
+     *
+     * @param p where to store, no alignment needed
+     * @param n amount of values, 0 to 4
+     */
+    inline void store_partial(float* p, int n) const {
+        SIGHT_COUNT(PartialStore);
+        #ifdef HAVE_AVX
+        __m128i mask = detail::laneMask128(n);
+        _mm_maskstore_ps(p, mask, val);
+        #else
+        detail::storePartial(*this, p, n);
+        #endif
+    }
+
     /**
      * @brief Sets vector values to native __m128
      *
@@ -427,7 +593,8 @@ class Vect128f {
     }
 
     /**
-     * @brief Converts to a integer representation (flooring)
+     * @brief Converts to a integer representation (truncating towards zero,
+     * INT32_MIN when out of range)
      */
     inline Vect128i to_int() const;
 
@@ -611,6 +778,103 @@ class Vect128f {
     }
 };
 
+/**
+ * @brief Lane mask for 128 bit vectors
+ *
+ * Comparisons return vectors with all ones in the lanes that match, those
+ * convert to a Mask128 implicitly, so select(a < b, a, b) or any(v == v2)
+ * work without spelling out the mask
+ */
+class Mask128 {
+  private:
+    __m128 val;
+
+  public:
+    /**
+     * @brief Empty mask
+     */
+    inline Mask128() {}
+
+    /**
+     * @brief Convert native __m128 lanes (all ones or zeros) to Mask128
+     *
+     * @param m mask to use
+     */
+    inline Mask128(__m128 m) : val(m) {}  // NOLINT(runtime/explicit)
+
+    /**
+     * @brief Use the result of a float comparison as a mask
+     *
+     * @param v vector with every lane all ones or all zeros
+     */
+    inline Mask128(const Vect128f& v) : val(v) {}  // NOLINT(runtime/explicit)
+
+    /**
+     * @brief Use the result of an integer comparison as a mask
+     *
+     * @param v vector with every lane all ones or all zeros
+     */
+    inline Mask128(const Vect128i& v)  // NOLINT(runtime/explicit)
+        : val(_mm_castsi128_ps(v)) {}
+
+    /**
+     * @brief Converts to a native __m128
+     */
+    inline operator __m128() const {
+        return val;
+    }
+
+    /**
+     * @brief Bits of the mask, lane i is bit i
+     */
+    inline uint32_t bits() const {
+        return _mm_movemask_ps(val);
+    }
+
+    /**
+     * @brief Checks whether a lane is set
+     *
+     * @param idx index in vector
+     */
+    inline bool operator[](unsigned int idx) const {
+        return (bits() >> idx) & 1;
+    }
+
+    /**
+     * @brief Performs NOT (r[i] = !this[i])
+     */
+    inline Mask128 operator~() const {
+        return _mm_xor_ps(val, _mm_castsi128_ps(_mm_set1_epi32(-1)));
+    }
+
+    /**
+     * @brief Performs AND (r[i] = this[i] & m[i])
+     *
+     * @param m mask to use
+     */
+    inline Mask128 operator&(const Mask128& m) const {
+        return _mm_and_ps(val, m.val);
+    }
+
+    /**
+     * @brief Performs OR (r[i] = this[i] | m[i])
+     *
+     * @param m mask to use
+     */
+    inline Mask128 operator|(const Mask128& m) const {
+        return _mm_or_ps(val, m.val);
+    }
+
+    /**
+     * @brief Performs XOR (r[i] = this[i] ^ m[i])
+     *
+     * @param m mask to use
+     */
+    inline Mask128 operator^(const Mask128& m) const {
+        return _mm_xor_ps(val, m.val);
+    }
+};
+
 Vect128i::operator Vect128f() const {
     return _mm_cvtepi32_ps(val);
 }
@@ -619,6 +883,29 @@ Vect128i Vect128f::to_int() const {
     return _mm_cvttps_epi32(val);
 }
 
+/**
+ * @brief Reinterprets the bits of a float vector as int32
+ *
+ * Unlike to_int() nothing is converted, ie. 1.0f gives 0x3F800000
+ *
+ * @param v vector to reinterpret
+ */
+inline Vect128i as_int(const Vect128f& v) {
+    return _mm_castps_si128(v);
+}
+
+/**
+ * @brief Reinterprets the bits of an int32 vector as float
+ *
+ * Unlike the Vect128i to Vect128f conversion nothing is converted, ie.
+ * 0x3F800000 gives 1.0f
+ *
+ * @param v vector to reinterpret
+ */
+inline Vect128f as_float(const Vect128i& v) {
+    return _mm_castsi128_ps(v);
+}
+
 /**
  * @brief Returns lowest of each value
  *
@@ -678,13 +965,82 @@ inline Vect128f highest(const Vect128f& v, const Vect128f& v2) {
 }
 
 /**
- * @brief Rounds each value to closest integer
+ * @brief Rounds each value to the closest integer, ties to even
+ *
+ * Like std::nearbyint in the default rounding mode, ie. 2.5 gives 2 and
+ * -0.4 gives -0
  *
  * @param v vector of values to round
- * @return rounded values of v[i]
  */
-inline Vect128i round(const Vect128f& v) {
-    return (v + Vect128f(0.5)).to_int();
+inline Vect128f round_nearest(const Vect128f& v) {
+    #ifdef HAVE_SSE41
+    return _mm_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    #else
+    // floats of 2^23 and up have no fraction, below that adding 2^23 has the
+    // FPU round the fraction away
+    const Vect128f sign(-0.0f), big(8388608.0f);
+    Vect128f a = _mm_andnot_ps(sign, v);
+    Vect128f r = ((a + big) - big) | (v & sign);
+    Vect128f small = a < big;  // NaN isn't
+    return (r & small) | Vect128f(_mm_andnot_ps(small, v));
+    #endif
+}
+
+/**
+ * @brief Rounds each value towards zero (like std::trunc)
+ *
+ * @param v vector of values to round
+ */
+inline Vect128f trunc(const Vect128f& v) {
+    #ifdef HAVE_SSE41
+    return _mm_round_ps(v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    #else
+    const Vect128f sign(-0.0f), big(8388608.0f);
+    Vect128f a = _mm_andnot_ps(sign, v);
+    Vect128f t = v.to_int();
+    Vect128f small = a < big;
+    return ((t | (v & sign)) & small) | Vect128f(_mm_andnot_ps(small, v));
+    #endif
+}
+
+/**
+ * @brief Rounds each value down (like std::floor)
+ *
+ * @param v vector of values to round
+ */
+inline Vect128f floor(const Vect128f& v) {
+    #ifdef HAVE_SSE41
+    return _mm_round_ps(v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    #else
+    Vect128f t = trunc(v);
+    return t - (Vect128f(1) & (t > v));
+    #endif
+}
+
+/**
+ * @brief Rounds each value up (like std::ceil), ie. -0.5 gives -0
+ *
+ * @param v vector of values to round
+ */
+inline Vect128f ceil(const Vect128f& v) {
+    #ifdef HAVE_SSE41
+    return _mm_round_ps(v, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC);
+    #else
+    Vect128f t = trunc(v);
+    return (t + (Vect128f(1) & (t < v))) | (v & Vect128f(-0.0f));
+    #endif
+}
+
+/**
+ * @brief Converts to int32 with the current rounding mode
+ *
+ * Ties go to even in the default mode. Faster than round(), values outside
+ * of the int32 range and NaN give INT32_MIN like to_int()
+ *
+ * @param v vector of values to convert
+ */
+inline Vect128i to_int_nearest(const Vect128f& v) {
+    return _mm_cvtps_epi32(v);
 }
 
 /**
@@ -710,7 +1066,7 @@ inline Vect128f reciprocal(const Vect128f& v) {
 /**
  * @brief The square root of values in a vector
  *
- * This method isn't guaranteed to be accurate
+ * This method isn't guaranteed to be accurate, see sqrt_precise()
  *
  * @param v starting values
  * @return the square root of v[i]
@@ -719,4 +1075,659 @@ inline Vect128f sqrt(const Vect128f& v) {
     return reciprocal(rsqrt(v));
 }
 
+/**
+ * @brief Fused multiply-add (r[i] = a[i] * b[i] + c[i])
+ *
+ * Rounds once with FMA, without it the multiply and add round separately
+ *
+ * @param a, b values to multiply
+ * @param c value to add (or subtract)
+ */
+inline Vect128f fma(const Vect128f& a, const Vect128f& b,
+                    const Vect128f& c) {
+    #ifdef HAVE_FMA
+    return _mm_fmadd_ps(a, b, c);
+    #else
+    return a * b + c;
+    #endif
+}
+
+/**
+ * @brief Fused multiply-subtract (r[i] = a[i] * b[i] - c[i])
+ *
+ * Rounds once with FMA, without it the multiply and add round separately
+ *
+ * @param a, b values to multiply
+ * @param c value to add (or subtract)
+ */
+inline Vect128f fms(const Vect128f& a, const Vect128f& b,
+                    const Vect128f& c) {
+    #ifdef HAVE_FMA
+    return _mm_fmsub_ps(a, b, c);
+    #else
+    return a * b - c;
+    #endif
+}
+
+/**
+ * @brief Fused negated multiply-add (r[i] = c[i] - a[i] * b[i])
+ *
+ * Rounds once with FMA, without it the multiply and add round separately
+ *
+ * @param a, b values to multiply
+ * @param c value to add (or subtract)
+ */
+inline Vect128f fnma(const Vect128f& a, const Vect128f& b,
+                     const Vect128f& c) {
+    #ifdef HAVE_FMA
+    return _mm_fnmadd_ps(a, b, c);
+    #else
+    return c - a * b;
+    #endif
+}
+
+/**
+ * @brief The square root of values in a vector, correctly rounded
+ *
+ * Uses the native square root instruction, which is slower than sqrt()
+ *
+ * @param v starting values
+ * @return the square root of v[i]
+ */
+inline Vect128f sqrt_precise(const Vect128f& v) {
+    return _mm_sqrt_ps(v);
+}
+
+/**
+ * @brief The reciprocal square root of values in a vector, correctly rounded
+ *
+ * Uses the native square root and divide instructions
+ *
+ * @param v starting values
+ * @return 1 / sqrt(v[i])
+ */
+inline Vect128f rsqrt_precise(const Vect128f& v) {
+    return Vect128f(1) / sqrt_precise(v);
+}
+
+/**
+ * @brief The reciprocal of values in a vector, correctly rounded
+ *
+ * Uses the native divide instruction
+ *
+ * @param v starting values
+ * @return 1 / v[i]
+ */
+inline Vect128f reciprocal_precise(const Vect128f& v) {
+    return Vect128f(1) / v;
+}
+
+/**
+ * @brief The reciprocal square root of values in a vector, refined once
+ *
+ * One Newton-Raphson step on top of rsqrt(), which gets close to full float
+ * precision for much less than a square root and divide. 0 and infinity
+ * give NaN, use rsqrt_precise() if those can happen
+ *
+ * @param v starting values
+ * @return 1 / sqrt(v[i])
+ */
+inline Vect128f rsqrt_refined(const Vect128f& v) {
+    Vect128f y = rsqrt(v);
+    Vect128f half_y = Vect128f(0.5) * y;
+    return half_y * fnma(v * y, y, Vect128f(3));
+}
+
+/**
+ * @brief The reciprocal of values in a vector, refined once
+ *
+ * One Newton-Raphson step on top of reciprocal(), which gets close to full
+ * float precision for much less than a divide. 0 and infinity give NaN, use
+ * reciprocal_precise() if those can happen
+ *
+ * @param v starting values
+ * @return 1 / v[i]
+ */
+inline Vect128f reciprocal_refined(const Vect128f& v) {
+    Vect128f y = reciprocal(v);
+    return fma(y, fnma(v, y, Vect128f(1)), y);
+}
+
+/**
+ * @brief Reads one value of a vector without going through memory
+ *
+ * @param I index in vector (0 - 3)
+ * @param v vector to read from
+ * @return v[I]
+ */
+template <int I>
+inline int32_t extract(const Vect128i& v) {
+    static_assert(I >= 0 && I < 4, "index outside of vector");
+    #ifdef HAVE_SSE41
+    return _mm_extract_epi32(v, I);
+    #else
+    return _mm_cvtsi128_si32(_mm_shuffle_epi32(v, I));
+    #endif
+}
+
+/**
+ * @brief Reads one value of a vector without going through memory
+ *
+ * @param I index in vector (0 - 3)
+ * @param v vector to read from
+ * @return v[I]
+ */
+template <int I>
+inline float extract(const Vect128f& v) {
+    static_assert(I >= 0 && I < 4, "index outside of vector");
+    return _mm_cvtss_f32(_mm_shuffle_ps(v, v, I));
+}
+
+/**
+ * @brief Adds every value of a vector together
+ *
+ * @param v values to add
+ * @return v[0] + v[1] + v[2] + v[3]
+ */
+inline int32_t hsum(const Vect128i& v) {
+    Vect128i swapped = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    Vect128i pairs = v + swapped;
+    Vect128i halves = _mm_shuffle_epi32(pairs, _MM_SHUFFLE(1, 0, 3, 2));
+    return extract<0>(pairs + halves);
+}
+
+/**
+ * @brief Adds every value of a vector together
+ *
+ * @param v values to add
+ * @return v[0] + v[1] + v[2] + v[3]
+ */
+inline float hsum(const Vect128f& v) {
+    __m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(v, shuf);
+    return _mm_cvtss_f32(_mm_add_ss(sums, _mm_movehl_ps(shuf, sums)));
+}
+
+/**
+ * @brief Lowest value of a vector
+ *
+ * @param v values to compare
+ * @return minimum of v[0], v[1], v[2] and v[3]
+ */
+inline int32_t hmin(const Vect128i& v) {
+    Vect128i swapped = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    Vect128i pairs = lowest(v, swapped);
+    Vect128i halves = _mm_shuffle_epi32(pairs, _MM_SHUFFLE(1, 0, 3, 2));
+    return extract<0>(lowest(pairs, halves));
+}
+
+/**
+ * @brief Lowest value of a vector
+ *
+ * @param v values to compare
+ * @return minimum of v[0], v[1], v[2] and v[3]
+ */
+inline float hmin(const Vect128f& v) {
+    __m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 mins = _mm_min_ps(v, shuf);
+    return _mm_cvtss_f32(_mm_min_ss(mins, _mm_movehl_ps(shuf, mins)));
+}
+
+/**
+ * @brief Highest value of a vector
+ *
+ * @param v values to compare
+ * @return maximum of v[0], v[1], v[2] and v[3]
+ */
+inline int32_t hmax(const Vect128i& v) {
+    Vect128i swapped = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    Vect128i pairs = highest(v, swapped);
+    Vect128i halves = _mm_shuffle_epi32(pairs, _MM_SHUFFLE(1, 0, 3, 2));
+    return extract<0>(highest(pairs, halves));
+}
+
+/**
+ * @brief Highest value of a vector
+ *
+ * @param v values to compare
+ * @return maximum of v[0], v[1], v[2] and v[3]
+ */
+inline float hmax(const Vect128f& v) {
+    __m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 maxs = _mm_max_ps(v, shuf);
+    return _mm_cvtss_f32(_mm_max_ss(maxs, _mm_movehl_ps(shuf, maxs)));
+}
+
+/**
+ * @brief Dot product of two vectors
+ *
+ * @param v first vector
+ * @param v2 second vector
+ * @return v[0] * v2[0] + v[1] * v2[1] + v[2] * v2[2] + v[3] * v2[3]
+ */
+inline float dot(const Vect128f& v, const Vect128f& v2) {
+    #ifdef HAVE_SSE41
+    return _mm_cvtss_f32(_mm_dp_ps(v, v2, 0xF1));
+    #else
+    return hsum(v * v2);
+    #endif
+}
+
+/**
+ * @brief Reorders the values of a vector (r = {v[A], v[B], v[C], v[D]})
+ *
+ * @param A, B, C, D indices to take each lane from
+ * @param v vector to reorder
+ */
+template <int A, int B, int C, int D>
+inline Vect128i shuffle(const Vect128i& v) {
+    static_assert(A >= 0 && A < 4 && B >= 0 && B < 4 && C >= 0 && C < 4
+                  && D >= 0 && D < 4, "index outside of vector");
+    return _mm_shuffle_epi32(v, _MM_SHUFFLE(D, C, B, A));
+}
+
+/**
+ * @brief Reorders the values of a vector (r = {v[A], v[B], v[C], v[D]})
+ *
+ * @param A, B, C, D indices to take each lane from
+ * @param v vector to reorder
+ */
+template <int A, int B, int C, int D>
+inline Vect128f shuffle(const Vect128f& v) {
+    static_assert(A >= 0 && A < 4 && B >= 0 && B < 4 && C >= 0 && C < 4
+                  && D >= 0 && D < 4, "index outside of vector");
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(D, C, B, A));
+}
+
+/**
+ * @brief Picks two values of each vector (r = {v[A], v[B], v2[C], v2[D]})
+ *
+ * @param A, B indices into v for lanes 0 and 1
+ * @param C, D indices into v2 for lanes 2 and 3
+ * @param v, v2 vectors to take values from
+ */
+template <int A, int B, int C, int D>
+inline Vect128f shuffle(const Vect128f& v, const Vect128f& v2) {
+    static_assert(A >= 0 && A < 4 && B >= 0 && B < 4 && C >= 0 && C < 4
+                  && D >= 0 && D < 4, "index outside of vector");
+    return _mm_shuffle_ps(v, v2, _MM_SHUFFLE(D, C, B, A));
+}
+
+/**
+ * @brief Interleaves the lower halves (r = {v[0], v2[0], v[1], v2[1]})
+ *
+ * @param v, v2 vectors to interleave
+ */
+inline Vect128i unpacklo(const Vect128i& v, const Vect128i& v2) {
+    return _mm_unpacklo_epi32(v, v2);
+}
+
+/**
+ * @brief Interleaves the upper halves (r = {v[2], v2[2], v[3], v2[3]})
+ *
+ * @param v, v2 vectors to interleave
+ */
+inline Vect128i unpackhi(const Vect128i& v, const Vect128i& v2) {
+    return _mm_unpackhi_epi32(v, v2);
+}
+
+/**
+ * @brief Interleaves the lower halves (r = {v[0], v2[0], v[1], v2[1]})
+ *
+ * @param v, v2 vectors to interleave
+ */
+inline Vect128f unpacklo(const Vect128f& v, const Vect128f& v2) {
+    return _mm_unpacklo_ps(v, v2);
+}
+
+/**
+ * @brief Interleaves the upper halves (r = {v[2], v2[2], v[3], v2[3]})
+ *
+ * @param v, v2 vectors to interleave
+ */
+inline Vect128f unpackhi(const Vect128f& v, const Vect128f& v2) {
+    return _mm_unpackhi_ps(v, v2);
+}
+
+/**
+ * @brief Transposes the 4x4 matrix made of four rows in place
+ *
+ * Afterwards r0 holds the first column, r1 the second and so on. Turns four
+ * xyzw structs into one vector per field, and back
+ *
+ * @param r0, r1, r2, r3 rows of the matrix
+ */
+inline void transpose(Vect128f& r0, Vect128f& r1, Vect128f& r2,
+                      Vect128f& r3) {
+    Vect128f t0 = unpacklo(r0, r1), t1 = unpacklo(r2, r3);
+    Vect128f t2 = unpackhi(r0, r1), t3 = unpackhi(r2, r3);
+    r0 = _mm_movelh_ps(t0, t1);
+    r1 = _mm_movehl_ps(t1, t0);
+    r2 = _mm_movelh_ps(t2, t3);
+    r3 = _mm_movehl_ps(t3, t2);
+}
+
+/**
+ * @brief Transposes the 4x4 matrix made of four rows in place
+ *
+ * @param r0, r1, r2, r3 rows of the matrix
+ */
+inline void transpose(Vect128i& r0, Vect128i& r1, Vect128i& r2,
+                      Vect128i& r3) {
+    Vect128i t0 = unpacklo(r0, r1), t1 = unpacklo(r2, r3);
+    Vect128i t2 = unpackhi(r0, r1), t3 = unpackhi(r2, r3);
+    r0 = _mm_unpacklo_epi64(t0, t1);
+    r1 = _mm_unpackhi_epi64(t0, t1);
+    r2 = _mm_unpacklo_epi64(t2, t3);
+    r3 = _mm_unpackhi_epi64(t2, t3);
+}
+
+/**
+ * @brief Shifts each value left by N bits (r[i] = v[i] << N)
+ *
+ * @param N amount of bits, 32 or more gives 0
+ * @param v vector to shift
+ */
+template <int N>
+inline Vect128i shl(const Vect128i& v) {
+    static_assert(N >= 0, "negative shift");
+    return _mm_slli_epi32(v, N);
+}
+
+/**
+ * @brief Shifts each value right by N bits, filling with zeros
+ *
+ * @param N amount of bits, 32 or more gives 0
+ * @param v vector to shift
+ */
+template <int N>
+inline Vect128i shr(const Vect128i& v) {
+    static_assert(N >= 0, "negative shift");
+    return _mm_srli_epi32(v, N);
+}
+
+/**
+ * @brief Shifts each value right by N bits, filling with the sign bit
+ *
+ * @param N amount of bits, 32 or more fills every bit with the sign
+ * @param v vector to shift
+ */
+template <int N>
+inline Vect128i sar(const Vect128i& v) {
+    static_assert(N >= 0, "negative shift");
+    return _mm_srai_epi32(v, N);
+}
+
+/**
+ * @brief Shifts each value left by the same runtime amount
+ *
+ * @param v vector to shift
+ * @param count amount of bits, 32 or more gives 0
+ */
+inline Vect128i shl(const Vect128i& v, int count) {
+    return _mm_sll_epi32(v, _mm_cvtsi32_si128(count));
+}
+
+/**
+ * @brief Shifts each value right by the same runtime amount, filling with
+ * zeros
+ *
+ * @param v vector to shift
+ * @param count amount of bits, 32 or more gives 0
+ */
+inline Vect128i shr(const Vect128i& v, int count) {
+    return _mm_srl_epi32(v, _mm_cvtsi32_si128(count));
+}
+
+/**
+ * @brief Shifts each value right by the same runtime amount, filling with
+ * the sign bit
+ *
+ * @param v vector to shift
+ * @param count amount of bits, 32 or more fills every bit with the sign
+ */
+inline Vect128i sar(const Vect128i& v, int count) {
+    return _mm_sra_epi32(v, _mm_cvtsi32_si128(count));
+}
+
+namespace detail {
+
+/// Lane i of counts, zero extended to the 64 bits that _mm_sll_epi32 reads
+template <int I>
+inline __m128i shift_count(__m128i counts) {
+    return _mm_and_si128(_mm_srli_si128(counts, I * 4),
+                         _mm_setr_epi32(-1, 0, 0, 0));
+}
+
+/// Applies a uniform shift per lane and keeps lane i of the i-th result
+template <__m128i (*Shift)(__m128i, __m128i)>
+inline Vect128i shift_lanes(const Vect128i& v, const Vect128i& counts) {
+    __m128i r0 = Shift(v, shift_count<0>(counts));
+    __m128i r1 = Shift(v, shift_count<1>(counts));
+    __m128i r2 = Shift(v, shift_count<2>(counts));
+    __m128i r3 = Shift(v, shift_count<3>(counts));
+    return _mm_castps_si128(
+        _mm_shuffle_ps(_mm_castsi128_ps(_mm_unpacklo_epi32(r0, r1)),
+                       _mm_castsi128_ps(_mm_unpackhi_epi32(r2, r3)),
+                       _MM_SHUFFLE(3, 0, 3, 0)));
+}
+
+inline __m128i sll(__m128i v, __m128i c) {
+    return _mm_sll_epi32(v, c);
+}
+inline __m128i srl(__m128i v, __m128i c) {
+    return _mm_srl_epi32(v, c);
+}
+inline __m128i sra(__m128i v, __m128i c) {
+    return _mm_sra_epi32(v, c);
+}
+
+}  // namespace detail
+
+/**
+ * @brief Shifts each value left by its own amount (r[i] = v[i] << c[i])
+ *
+ * Needs AVX2 for a single instruction, otherwise it costs four shifts
+ *
+ * @param v vector to shift
+ * @param counts amount of bits per lane, 32 or more (as unsigned) gives 0
+ */
+inline Vect128i shl(const Vect128i& v, const Vect128i& counts) {
+    #ifdef HAVE_AVX2
+    return _mm_sllv_epi32(v, counts);
+    #else
+    return detail::shift_lanes<detail::sll>(v, counts);
+    #endif
+}
+
+/**
+ * @brief Shifts each value right by its own amount, filling with zeros
+ *
+ * @param v vector to shift
+ * @param counts amount of bits per lane, 32 or more (as unsigned) gives 0
+ */
+inline Vect128i shr(const Vect128i& v, const Vect128i& counts) {
+    #ifdef HAVE_AVX2
+    return _mm_srlv_epi32(v, counts);
+    #else
+    return detail::shift_lanes<detail::srl>(v, counts);
+    #endif
+}
+
+/**
+ * @brief Shifts each value right by its own amount, filling with the sign
+ * bit
+ *
+ * @param v vector to shift
+ * @param counts amount of bits per lane, 32 or more (as unsigned) fills
+ * every bit with the sign
+ */
+inline Vect128i sar(const Vect128i& v, const Vect128i& counts) {
+    #ifdef HAVE_AVX2
+    return _mm_srav_epi32(v, counts);
+    #else
+    return detail::shift_lanes<detail::sra>(v, counts);
+    #endif
+}
+
+/**
+ * @brief Picks values from two vectors using a mask (r[i] = m[i] ? a[i] : b[i])
+ *
+ * @param m lanes to take from a
+ * @param a values used where m is set
+ * @param b values used where m is not set
+ */
+inline Vect128i select(const Mask128& m, const Vect128i& a, const Vect128i& b) {
+    __m128i mi = _mm_castps_si128(m);
+    #ifdef HAVE_SSE41
+    return _mm_blendv_epi8(b, a, mi);
+    #else
+    return _mm_or_si128(_mm_and_si128(mi, a), _mm_andnot_si128(mi, b));
+    #endif
+}
+
+/**
+ * @brief Picks values from two vectors using a mask (r[i] = m[i] ? a[i] : b[i])
+ *
+ * @param m lanes to take from a
+ * @param a values used where m is set
+ * @param b values used where m is not set
+ */
+inline Vect128f select(const Mask128& m, const Vect128f& a, const Vect128f& b) {
+    #ifdef HAVE_SSE41
+    return _mm_blendv_ps(b, a, m);
+    #else
+    return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+    #endif
+}
+
+/**
+ * @brief Bits of a mask, lane i is bit i (like _mm_movemask_ps)
+ *
+ * @param m mask, ie. the result of a comparison
+ */
+inline uint32_t movemask(const Mask128& m) {
+    return m.bits();
+}
+
+/**
+ * @brief Checks if any lane of a mask is set
+ *
+ * @param m mask, ie. the result of a comparison
+ */
+inline bool any(const Mask128& m) {
+    return m.bits() != 0;
+}
+
+/**
+ * @brief Checks if every lane of a mask is set
+ *
+ * @param m mask, ie. the result of a comparison
+ */
+inline bool all(const Mask128& m) {
+    return m.bits() == 0xF;
+}
+
+/**
+ * @brief Checks if no lane of a mask is set
+ *
+ * @param m mask, ie. the result of a comparison
+ */
+inline bool none(const Mask128& m) {
+    return m.bits() == 0;
+}
+
+/**
+ * @brief High 32 bits of each signed 64 bit product (a[i] * b[i] >> 32)
+ *
+ * @param a, b vectors to multiply
+ */
+inline Vect128i mulhi(const Vect128i& a, const Vect128i& b) {
+    // products of the even lanes, then of the odd lanes moved down
+    __m128i aodd = _mm_srli_epi64(a, 32), bodd = _mm_srli_epi64(b, 32);
+    #ifdef HAVE_SSE41
+    __m128i even = _mm_mul_epi32(a, b), odd = _mm_mul_epi32(aodd, bodd);
+    #else
+    __m128i even = _mm_mul_epu32(a, b), odd = _mm_mul_epu32(aodd, bodd);
+    #endif
+    __m128i oddMask = _mm_setr_epi32(0, -1, 0, -1);
+    Vect128i hi = _mm_or_si128(_mm_srli_epi64(even, 32),
+                               _mm_and_si128(odd, oddMask));
+    #ifndef HAVE_SSE41
+    // unsigned products are too high by b for negative a and a for negative b
+    hi = hi - (sar<31>(a) & b) - (sar<31>(b) & a);
+    #endif
+    return hi;
+}
+
+/**
+ * @brief Loads base[idx[i]] into each lane
+ *
+ * @param base start of the table
+ * @param idx index of each value, counted in int32's from base
+ */
+inline Vect128i gather(const int32_t* base, const Vect128i& idx) {
+    #ifdef HAVE_AVX2
+    return _mm_i32gather_epi32(base, idx, 4);
+    #else
+    alignas(16) int32_t i[4];
+    idx.store(i);
+    return Vect128i(base[i[0]], base[i[1]], base[i[2]], base[i[3]]);
+    #endif
+}
+
+/**
+ * @brief Loads base[idx[i]] into each lane
+ *
+ * @param base start of the table
+ * @param idx index of each value, counted in floats from base
+ */
+inline Vect128f gather(const float* base, const Vect128i& idx) {
+    #ifdef HAVE_AVX2
+    return _mm_i32gather_ps(base, idx, 4);
+    #else
+    alignas(16) int32_t i[4];
+    idx.store(i);
+    return Vect128f(base[i[0]], base[i[1]], base[i[2]], base[i[3]]);
+    #endif
+}
+
+/**
+ * @brief Stores each lane to base[idx[i]]
+ *
+ * There is no scatter instruction for 128 bit vectors, so the lanes are
+ * stored one by one, in order (the last lane wins for repeated indices)
+ *
+ * @param base start of the table
+ * @param idx index of each value, counted in int32's from base
+ * @param v values to store
+ */
+inline void scatter(int32_t* base, const Vect128i& idx, const Vect128i& v) {
+    alignas(16) int32_t i[4], values[4];
+    idx.store(i);
+    v.store(values);
+    for (int l = 0; l < 4; l++) {
+        base[i[l]] = values[l];
+    }
+}
+
+/**
+ * @brief Stores each lane to base[idx[i]]
+ *
+ * Same as the int32 version
+ *
+ * @param base start of the table
+ * @param idx index of each value, counted in floats from base
+ * @param v values to store
+ */
+inline void scatter(float* base, const Vect128i& idx, const Vect128f& v) {
+    alignas(16) int32_t i[4];
+    alignas(16) float values[4];
+    idx.store(i);
+    v.store(values);
+    for (int l = 0; l < 4; l++) {
+        base[i[l]] = values[l];
+    }
+}
+
 }  // namespace sight
@@ -0,0 +1,1019 @@
+#pragma once
+
+#include "simd.hpp"
+#include "simd_128.hpp"
+#include <cstdint>
+
+namespace sight {
+using Vect128i8 = Vect<int8_t, 16>;
+using Vect128u8 = Vect<uint8_t, 16>;
+using Vect128i16 = Vect<int16_t, 8>;
+using Vect128u16 = Vect<uint16_t, 8>;
+using Vect128i64 = Vect<int64_t, 2>;
+
+namespace detail {
+
+/// Bitwise select of __m128i (r = m ? a : b)
+inline __m128i blend(__m128i m, __m128i a, __m128i b) {
+    #ifdef HAVE_SSE41
+    return _mm_blendv_epi8(b, a, m);
+    #else
+    return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+    #endif
+}
+
+/**
+ * @brief Intrinsics for one lane type of the 128 bit integer vectors
+ *
+ * Every specialization has set1, add, sub, mul, eq, gt, min and max, the 8
+ * and 16 bit ones also have saturating adds and subs
+ */
+template <typename T>
+struct Int128;
+
+template <>
+struct Int128<int8_t> {
+    static inline __m128i set1(int8_t i) {
+        return _mm_set1_epi8(i);
+    }
+    static inline __m128i add(__m128i a, __m128i b) {
+        return _mm_add_epi8(a, b);
+    }
+    static inline __m128i sub(__m128i a, __m128i b) {
+        return _mm_sub_epi8(a, b);
+    }
+    static inline __m128i mul(__m128i a, __m128i b) {
+        // multiply even and odd bytes as 16 bit, keep the low byte of each
+        __m128i even = _mm_mullo_epi16(a, b);
+        __m128i odd = _mm_mullo_epi16(_mm_srli_epi16(a, 8),
+                                      _mm_srli_epi16(b, 8));
+        return _mm_or_si128(_mm_slli_epi16(odd, 8),
+                            _mm_and_si128(even, _mm_set1_epi16(0xFF)));
+    }
+    static inline __m128i eq(__m128i a, __m128i b) {
+        return _mm_cmpeq_epi8(a, b);
+    }
+    static inline __m128i gt(__m128i a, __m128i b) {
+        return _mm_cmpgt_epi8(a, b);
+    }
+    static inline __m128i min(__m128i a, __m128i b) {
+        #ifdef HAVE_SSE41
+        return _mm_min_epi8(a, b);
+        #else
+        return blend(gt(a, b), b, a);
+        #endif
+    }
+    static inline __m128i max(__m128i a, __m128i b) {
+        #ifdef HAVE_SSE41
+        return _mm_max_epi8(a, b);
+        #else
+        return blend(gt(a, b), a, b);
+        #endif
+    }
+    static inline __m128i adds(__m128i a, __m128i b) {
+        return _mm_adds_epi8(a, b);
+    }
+    static inline __m128i subs(__m128i a, __m128i b) {
+        return _mm_subs_epi8(a, b);
+    }
+};
+
+template <>
+struct Int128<uint8_t> : Int128<int8_t> {
+    static inline __m128i set1(uint8_t i) {
+        return _mm_set1_epi8(static_cast<char>(i));
+    }
+    static inline __m128i gt(__m128i a, __m128i b) {
+        // flipping the sign bit maps unsigned order onto signed order
+        __m128i sign = _mm_set1_epi8(static_cast<char>(0x80));
+        return _mm_cmpgt_epi8(_mm_xor_si128(a, sign), _mm_xor_si128(b, sign));
+    }
+    static inline __m128i min(__m128i a, __m128i b) {
+        return _mm_min_epu8(a, b);
+    }
+    static inline __m128i max(__m128i a, __m128i b) {
+        return _mm_max_epu8(a, b);
+    }
+    static inline __m128i adds(__m128i a, __m128i b) {
+        return _mm_adds_epu8(a, b);
+    }
+    static inline __m128i subs(__m128i a, __m128i b) {
+        return _mm_subs_epu8(a, b);
+    }
+};
+
+template <>
+struct Int128<int16_t> {
+    static inline __m128i set1(int16_t i) {
+        return _mm_set1_epi16(i);
+    }
+    static inline __m128i add(__m128i a, __m128i b) {
+        return _mm_add_epi16(a, b);
+    }
+    static inline __m128i sub(__m128i a, __m128i b) {
+        return _mm_sub_epi16(a, b);
+    }
+    static inline __m128i mul(__m128i a, __m128i b) {
+        return _mm_mullo_epi16(a, b);
+    }
+    static inline __m128i eq(__m128i a, __m128i b) {
+        return _mm_cmpeq_epi16(a, b);
+    }
+    static inline __m128i gt(__m128i a, __m128i b) {
+        return _mm_cmpgt_epi16(a, b);
+    }
+    static inline __m128i min(__m128i a, __m128i b) {
+        return _mm_min_epi16(a, b);
+    }
+    static inline __m128i max(__m128i a, __m128i b) {
+        return _mm_max_epi16(a, b);
+    }
+    static inline __m128i adds(__m128i a, __m128i b) {
+        return _mm_adds_epi16(a, b);
+    }
+    static inline __m128i subs(__m128i a, __m128i b) {
+        return _mm_subs_epi16(a, b);
+    }
+};
+
+template <>
+struct Int128<uint16_t> : Int128<int16_t> {
+    static inline __m128i set1(uint16_t i) {
+        return _mm_set1_epi16(static_cast<int16_t>(i));
+    }
+    static inline __m128i gt(__m128i a, __m128i b) {
+        __m128i sign = _mm_set1_epi16(static_cast<int16_t>(0x8000));
+        return _mm_cmpgt_epi16(_mm_xor_si128(a, sign), _mm_xor_si128(b, sign));
+    }
+    static inline __m128i min(__m128i a, __m128i b) {
+        #ifdef HAVE_SSE41
+        return _mm_min_epu16(a, b);
+        #else
+        return _mm_sub_epi16(a, _mm_subs_epu16(a, b));
+        #endif
+    }
+    static inline __m128i max(__m128i a, __m128i b) {
+        #ifdef HAVE_SSE41
+        return _mm_max_epu16(a, b);
+        #else
+        return _mm_add_epi16(b, _mm_subs_epu16(a, b));
+        #endif
+    }
+    static inline __m128i adds(__m128i a, __m128i b) {
+        return _mm_adds_epu16(a, b);
+    }
+    static inline __m128i subs(__m128i a, __m128i b) {
+        return _mm_subs_epu16(a, b);
+    }
+};
+
+template <>
+struct Int128<int64_t> {
+    static inline __m128i set1(int64_t i) {
+        return _mm_set1_epi64x(i);
+    }
+    static inline __m128i add(__m128i a, __m128i b) {
+        return _mm_add_epi64(a, b);
+    }
+    static inline __m128i sub(__m128i a, __m128i b) {
+        return _mm_sub_epi64(a, b);
+    }
+    static inline __m128i mul(__m128i a, __m128i b) {
+        // lo * lo + ((hi * lo + lo * hi) << 32), the hi * hi part overflows
+        __m128i lo = _mm_mul_epu32(a, b);
+        __m128i cross = _mm_add_epi64(
+            _mm_mul_epu32(_mm_srli_epi64(a, 32), b),
+            _mm_mul_epu32(a, _mm_srli_epi64(b, 32)));
+        return _mm_add_epi64(lo, _mm_slli_epi64(cross, 32));
+    }
+    static inline __m128i eq(__m128i a, __m128i b) {
+        #ifdef HAVE_SSE41
+        return _mm_cmpeq_epi64(a, b);
+        #else
+        __m128i e = _mm_cmpeq_epi32(a, b);
+        return _mm_and_si128(e, _mm_shuffle_epi32(e, _MM_SHUFFLE(2, 3, 0, 1)));
+        #endif
+    }
+    static inline __m128i gt(__m128i a, __m128i b) {
+        #ifdef HAVE_SSE42
+        return _mm_cmpgt_epi64(a, b);
+        #else
+        // signed compare of the high halves, unsigned of the low halves
+        __m128i sign = _mm_set1_epi32(static_cast<int32_t>(0x80000000));
+        __m128i hi_gt = _mm_cmpgt_epi32(a, b);
+        __m128i hi_eq = _mm_cmpeq_epi32(a, b);
+        __m128i lo_gt = _mm_cmpgt_epi32(_mm_xor_si128(a, sign),
+                                        _mm_xor_si128(b, sign));
+        lo_gt = _mm_shuffle_epi32(lo_gt, _MM_SHUFFLE(2, 2, 0, 0));
+        __m128i r = _mm_or_si128(hi_gt, _mm_and_si128(hi_eq, lo_gt));
+        return _mm_shuffle_epi32(r, _MM_SHUFFLE(3, 3, 1, 1));
+        #endif
+    }
+    static inline __m128i min(__m128i a, __m128i b) {
+        return blend(gt(a, b), b, a);
+    }
+    static inline __m128i max(__m128i a, __m128i b) {
+        return blend(gt(a, b), a, b);
+    }
+};
+
+/**
+ * @brief Shared implementation of the 8, 16 and 64 bit integer vectors
+ *
+ * V is the vector type deriving from this (so operators return it) and T
+ * its lane type. The interface is the same as Vect128i
+ */
+template <typename V, typename T>
+class Vect128Int {
+  private:
+    typedef Int128<T> ops;
+
+  protected:
+    __m128i val;
+
+    inline Vect128Int() {}
+    inline Vect128Int(__m128i v) : val(v) {}  // NOLINT(runtime/explicit)
+
+  public:
+    /// Type of each lane
+    typedef T value_type;
+
+    /// Number of lanes in the vector
+    enum { lanes = 16 / sizeof(T) };
+
+    /**
+     * @brief Access value directly
+     *
+     * Be aware that this method does not do bounds checking, and that it is
+     * probably the most inefficient way to do anything - only use for
+     * debugging
+     *
+     * @param idx index in vector
+     */
+    inline T operator[](unsigned int idx) const {
+        T array[lanes];
+        storeu(array);
+        return array[idx];
+    }
+
+    /**
+     * @brief Loads vector values from an arbitrary point
+     *
+     * @param p loads 128 bits starting at p
+     */
+    static inline V loadu(const T* p) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    }
+
+    /**
+     * @brief Loads vector values from an aligned pointer in memory
+     *
+     * @param p loads 128 bits starting at p
+     */
+    static inline V load(const T* p) {
+        return _mm_load_si128(reinterpret_cast<const __m128i*>(p));
+    }
+
+    /**
+     * @brief Loads the first n values from p, the other lanes are 0
+     *
+     * Nothing past p + n is read, so this is safe at the end of an array
+     *
+     * @param p values to load, no alignment needed
+     * @param n amount of values, 0 to lanes
+     */
+    static inline V load_partial(const T* p, int n) {
+        return detail::loadPartial<V>(p, n);
+    }
+
+    /**
+     * @brief Inserts the vector in a point in memory
+     *
+     * @param p stores 128 bits starting at p
+     */
+    inline void storeu(T* p) const {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), val);
+    }
+
+    /**
+     * @brief Inserts this vector in a aligned point in memory
+     *
+     * @param p stores 128 bits starting at p
+     */
+    inline void store(T* p) const {
+        _mm_store_si128(reinterpret_cast<__m128i*>(p), val);
+    }
+
+    /**
+     * @brief Inserts this vector in a aligned point in memory, bypassing
+     * the cache
+     *
+     * A non-temporal store, for results that won't be read again soon
+     * (ie. arrays larger than the last level cache). Call streamFence()
+     * before other threads read the data
+     *
+     * @param p stores 128 bits starting at p
+     */
+    inline void stream(T* p) const {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(p), val);
+    }
+
+    /**
+     * @brief Stores the first n values to p
+     *
+     * Nothing past p + n is written, so this is safe at the end of an array
+     *
+     * @param p where to store, no alignment needed
+     * @param n amount of values, 0 to lanes
+     */
+    inline void store_partial(T* p, int n) const {
+        detail::storePartial(static_cast<const V&>(*this), p, n);
+    }
+
+    /**
+     * @brief Converts to a native __m128i
+     */
+    inline operator __m128i() const {
+        return val;
+    }
+
+    /**
+     * @brief Performs NOT (r[i] = ~this[i])
+     */
+    inline V operator~() const {
+        return _mm_xor_si128(val, _mm_set1_epi32(-1));
+    }
+
+    /**
+     * @brief Adds vectors together, wrapping (r[i] = this[i] + v[i])
+     *
+     * @param v vector to add
+     */
+    inline V operator+(const V& v) const {
+        return ops::add(val, v);
+    }
+
+    /**
+     * @brief Subtracts vector, wrapping (r[i] = this[i] - v[i])
+     *
+     * @param v vector to subtract
+     */
+    inline V operator-(const V& v) const {
+        return ops::sub(val, v);
+    }
+
+    /**
+     * @brief Multiplies vectors together, keeping the low bits
+     * (r[i] = this[i] * v[i])
+     *
+     * @param v vector to multiply
+     */
+    inline V operator*(const V& v) const {
+        return ops::mul(val, v);
+    }
+
+    /**
+     * @brief Performs AND comparison (r[i] = this[i] & v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline V operator&(const V& v) const {
+        return _mm_and_si128(val, v);
+    }
+
+    /**
+     * @brief Performs OR comparison (r[i] = this[i] | v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline V operator|(const V& v) const {
+        return _mm_or_si128(val, v);
+    }
+
+    /**
+     * @brief Performs XOR comparison (r[i] = this[i] ^ v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline V operator^(const V& v) const {
+        return _mm_xor_si128(val, v);
+    }
+
+    /**
+     * @brief Performs less-than comparison (r[i] = this[i] < v[i])
+     *
+     * @param v vector to compare
+     */
+    inline V operator<(const V& v) const {
+        return ops::gt(v, val);
+    }
+
+    /**
+     * @brief Performs less-than-or-equal-to comparison (r[i] = this[i] <= v[i])
+     *
+     * @param v vector to compare
+     */
+    inline V operator<=(const V& v) const {
+        return ~(operator>(v));
+    }
+
+    /**
+     * @brief Performs larger-than comparison (r[i] = this[i] > v[i])
+     *
+     * @param v vector to compare
+     */
+    inline V operator>(const V& v) const {
+        return ops::gt(val, v);
+    }
+
+    /**
+     * @brief Performs greater-than-or-equal-to comparison
+     * (r[i] = this[i] >= v[i])
+     *
+     * @param v vector to compare
+     */
+    inline V operator>=(const V& v) const {
+        return ~(operator<(v));
+    }
+
+    /**
+     * @brief Performs equal-to comparison (r[i] = this[i] == v[i])
+     *
+     * @param v vector to compare
+     */
+    inline V operator==(const V& v) const {
+        return ops::eq(val, v);
+    }
+
+    /**
+     * @brief Performs not-equal-to comparison (r[i] = this[i] != v[i])
+     *
+     * @param v vector to compare
+     */
+    inline V operator!=(const V& v) const {
+        return ~(operator==(v));
+    }
+
+    /**
+     * @brief Add vector (this[i] = this[i] + v[i])
+     *
+     * @param v vector to add
+     */
+    inline void operator+=(const V& v) {
+        val = operator+(v);
+    }
+
+    /**
+     * @brief Subtracts vector (this[i] = this[i] - v[i])
+     *
+     * @param v vector to subtract
+     */
+    inline void operator-=(const V& v) {
+        val = operator-(v);
+    }
+
+    /**
+     * @brief Multiples vector (this[i] = this[i] * v[i])
+     *
+     * @param v vector to multiply
+     */
+    inline void operator*=(const V& v) {
+        val = operator*(v);
+    }
+
+    /**
+     * @brief AND operation with vector (this[i] = this[i] & v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator&=(const V& v) {
+        val = operator&(v);
+    }
+
+    /**
+     * @brief OR operation with vector (this[i] = this[i] | v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator|=(const V& v) {
+        val = operator|(v);
+    }
+
+    /**
+     * @brief XOR operation with vector (this[i] = this[i] ^ v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator^=(const V& v) {
+        val = operator^(v);
+    }
+};
+
+}  // namespace detail
+
+/**
+ * @brief 128 bit vector of int8
+ */
+template <>
+class Vect<int8_t, 16> : public detail::Vect128Int<Vect<int8_t, 16>, int8_t> {
+  public:
+    /**
+     * @brief Empty vector
+     */
+    inline Vect() {}
+
+    /**
+     * @brief Fill vector with i
+     *
+     * @param i value to set every entry to
+     */
+    inline explicit Vect(int8_t i)
+        : Vect128Int(detail::Int128<int8_t>::set1(i)) {}
+
+    /**
+     * @brief Convert native __m128i to abstract Vect128i8
+     *
+     * @param v vector to use
+     */
+    inline Vect(__m128i v) : Vect128Int(v) {}  // NOLINT(runtime/explicit)
+
+    /**
+     * @brief Fill vector with values
+     *
+     * @param i0, ..., i15 values to use
+     */
+    inline Vect(int8_t i0, int8_t i1, int8_t i2, int8_t i3, int8_t i4,
+                int8_t i5, int8_t i6, int8_t i7, int8_t i8, int8_t i9,
+                int8_t i10, int8_t i11, int8_t i12, int8_t i13, int8_t i14,
+                int8_t i15)
+        : Vect128Int(_mm_setr_epi8(i0, i1, i2, i3, i4, i5, i6, i7, i8, i9,
+                                   i10, i11, i12, i13, i14, i15)) {}
+};
+
+/**
+ * @brief 128 bit vector of uint8, ie. image pixels
+ */
+template <>
+class Vect<uint8_t, 16>
+    : public detail::Vect128Int<Vect<uint8_t, 16>, uint8_t> {
+  public:
+    /**
+     * @brief Empty vector
+     */
+    inline Vect() {}
+
+    /**
+     * @brief Fill vector with i
+     *
+     * @param i value to set every entry to
+     */
+    inline explicit Vect(uint8_t i)
+        : Vect128Int(detail::Int128<uint8_t>::set1(i)) {}
+
+    /**
+     * @brief Convert native __m128i to abstract Vect128u8
+     *
+     * @param v vector to use
+     */
+    inline Vect(__m128i v) : Vect128Int(v) {}  // NOLINT(runtime/explicit)
+
+    /**
+     * @brief Fill vector with values
+     *
+     * @param i0, ..., i15 values to use
+     */
+    inline Vect(uint8_t i0, uint8_t i1, uint8_t i2, uint8_t i3, uint8_t i4,
+                uint8_t i5, uint8_t i6, uint8_t i7, uint8_t i8, uint8_t i9,
+                uint8_t i10, uint8_t i11, uint8_t i12, uint8_t i13,
+                uint8_t i14, uint8_t i15)
+        : Vect128Int(_mm_setr_epi8(i0, i1, i2, i3, i4, i5, i6, i7, i8, i9,
+                                   i10, i11, i12, i13, i14, i15)) {}
+};
+
+/**
+ * @brief 128 bit vector of int16, ie. audio samples
+ */
+template <>
+class Vect<int16_t, 8> : public detail::Vect128Int<Vect<int16_t, 8>, int16_t> {
+  public:
+    /**
+     * @brief Empty vector
+     */
+    inline Vect() {}
+
+    /**
+     * @brief Fill vector with i
+     *
+     * @param i value to set every entry to
+     */
+    inline explicit Vect(int16_t i)
+        : Vect128Int(detail::Int128<int16_t>::set1(i)) {}
+
+    /**
+     * @brief Convert native __m128i to abstract Vect128i16
+     *
+     * @param v vector to use
+     */
+    inline Vect(__m128i v) : Vect128Int(v) {}  // NOLINT(runtime/explicit)
+
+    /**
+     * @brief Fill vector with values
+     *
+     * @param i0, ..., i7 values to use
+     */
+    inline Vect(int16_t i0, int16_t i1, int16_t i2, int16_t i3, int16_t i4,
+                int16_t i5, int16_t i6, int16_t i7)
+        : Vect128Int(_mm_setr_epi16(i0, i1, i2, i3, i4, i5, i6, i7)) {}
+};
+
+/**
+ * @brief 128 bit vector of uint16
+ */
+template <>
+class Vect<uint16_t, 8>
+    : public detail::Vect128Int<Vect<uint16_t, 8>, uint16_t> {
+  public:
+    /**
+     * @brief Empty vector
+     */
+    inline Vect() {}
+
+    /**
+     * @brief Fill vector with i
+     *
+     * @param i value to set every entry to
+     */
+    inline explicit Vect(uint16_t i)
+        : Vect128Int(detail::Int128<uint16_t>::set1(i)) {}
+
+    /**
+     * @brief Convert native __m128i to abstract Vect128u16
+     *
+     * @param v vector to use
+     */
+    inline Vect(__m128i v) : Vect128Int(v) {}  // NOLINT(runtime/explicit)
+
+    /**
+     * @brief Fill vector with values
+     *
+     * @param i0, ..., i7 values to use
+     */
+    inline Vect(uint16_t i0, uint16_t i1, uint16_t i2, uint16_t i3,
+                uint16_t i4, uint16_t i5, uint16_t i6, uint16_t i7)
+        : Vect128Int(_mm_setr_epi16(i0, i1, i2, i3, i4, i5, i6, i7)) {}
+};
+
+/**
+ * @brief 128 bit vector of int64
+ *
+ * Comparisons need SSE4.2 (equality SSE4.1) and are emulated without it,
+ * multiplication is always emulated
+ */
+template <>
+class Vect<int64_t, 2> : public detail::Vect128Int<Vect<int64_t, 2>, int64_t> {
+  public:
+    /**
+     * @brief Empty vector
+     */
+    inline Vect() {}
+
+    /**
+     * @brief Fill vector with i
+     *
+     * @param i value to set every entry to
+     */
+    inline explicit Vect(int64_t i)
+        : Vect128Int(detail::Int128<int64_t>::set1(i)) {}
+
+    /**
+     * @brief Convert native __m128i to abstract Vect128i64
+     *
+     * @param v vector to use
+     */
+    inline Vect(__m128i v) : Vect128Int(v) {}  // NOLINT(runtime/explicit)
+
+    /**
+     * @brief Fill vector with values
+     *
+     * @param i0, i1 values to use
+     */
+    inline Vect(int64_t i0, int64_t i1) : Vect128Int(_mm_set_epi64x(i1, i0)) {}
+};
+
+/**
+ * @brief Returns lowest of each value
+ *
+ * @param v first vector to compare
+ * @param v2 second vector to compare
+ * @return lowest of v[i] and v2[i]
+ */
+template <typename V, typename T>
+inline V lowest(const detail::Vect128Int<V, T>& v,
+                const detail::Vect128Int<V, T>& v2) {
+    return detail::Int128<T>::min(v, v2);
+}
+
+/**
+ * @brief Returns highest of each value
+ *
+ * @param v first vector to compare
+ * @param v2 second vector to compare
+ * @return highest of v[i] and v2[i]
+ */
+template <typename V, typename T>
+inline V highest(const detail::Vect128Int<V, T>& v,
+                 const detail::Vect128Int<V, T>& v2) {
+    return detail::Int128<T>::max(v, v2);
+}
+
+/**
+ * @brief Adds, clamping to the range of the lane type instead of wrapping
+ *
+ * Only for 8 and 16 bit lanes, ie. Vect128u8(250) + 10 gives 255
+ *
+ * @param v, v2 vectors to add
+ */
+template <typename V, typename T>
+inline V add_saturated(const detail::Vect128Int<V, T>& v,
+                       const detail::Vect128Int<V, T>& v2) {
+    return detail::Int128<T>::adds(v, v2);
+}
+
+/**
+ * @brief Subtracts, clamping to the range of the lane type
+ *
+ * Only for 8 and 16 bit lanes, ie. Vect128u8(5) - 10 gives 0
+ *
+ * @param v vector to subtract from
+ * @param v2 vector to subtract
+ */
+template <typename V, typename T>
+inline V sub_saturated(const detail::Vect128Int<V, T>& v,
+                       const detail::Vect128Int<V, T>& v2) {
+    return detail::Int128<T>::subs(v, v2);
+}
+
+/**
+ * @brief Picks values from two vectors using a comparison result
+ * (r[i] = m[i] ? a[i] : b[i])
+ *
+ * @param m comparison result, lanes all ones or all zeros
+ * @param a values used where m is set
+ * @param b values used where m is not set
+ */
+template <typename V, typename T>
+inline V select(const detail::Vect128Int<V, T>& m, const V& a, const V& b) {
+    return detail::blend(m, a, b);
+}
+
+/**
+ * @brief Bits of a comparison result, lane i is bit i
+ *
+ * One bit per lane whatever the lane size, unlike _mm_movemask_epi8
+ *
+ * @param m comparison result, lanes all ones or all zeros
+ */
+template <typename V, typename T>
+inline uint32_t movemask(const detail::Vect128Int<V, T>& m) {
+    if (sizeof(T) == 2) {
+        return _mm_movemask_epi8(_mm_packs_epi16(m, _mm_setzero_si128()));
+    }
+    if (sizeof(T) == 8) {
+        return _mm_movemask_pd(_mm_castsi128_pd(m));
+    }
+    return _mm_movemask_epi8(m);
+}
+
+/**
+ * @brief Checks if any lane of a comparison result is set
+ *
+ * @param m comparison result
+ */
+template <typename V, typename T>
+inline bool any(const detail::Vect128Int<V, T>& m) {
+    return _mm_movemask_epi8(m) != 0;
+}
+
+/**
+ * @brief Checks if every lane of a comparison result is set
+ *
+ * @param m comparison result
+ */
+template <typename V, typename T>
+inline bool all(const detail::Vect128Int<V, T>& m) {
+    return _mm_movemask_epi8(m) == 0xFFFF;
+}
+
+/**
+ * @brief Checks if no lane of a comparison result is set
+ *
+ * @param m comparison result
+ */
+template <typename V, typename T>
+inline bool none(const detail::Vect128Int<V, T>& m) {
+    return _mm_movemask_epi8(m) == 0;
+}
+
+/**
+ * @brief Zero extends the lower 8 values to 16 bit
+ *
+ * @param v vector to widen
+ */
+inline Vect128u16 widen_lo(const Vect128u8& v) {
+    return _mm_unpacklo_epi8(v, _mm_setzero_si128());
+}
+
+/**
+ * @brief Zero extends the upper 8 values to 16 bit
+ *
+ * @param v vector to widen
+ */
+inline Vect128u16 widen_hi(const Vect128u8& v) {
+    return _mm_unpackhi_epi8(v, _mm_setzero_si128());
+}
+
+/**
+ * @brief Sign extends the lower 8 values to 16 bit
+ *
+ * @param v vector to widen
+ */
+inline Vect128i16 widen_lo(const Vect128i8& v) {
+    return _mm_unpacklo_epi8(v, _mm_cmpgt_epi8(_mm_setzero_si128(), v));
+}
+
+/**
+ * @brief Sign extends the upper 8 values to 16 bit
+ *
+ * @param v vector to widen
+ */
+inline Vect128i16 widen_hi(const Vect128i8& v) {
+    return _mm_unpackhi_epi8(v, _mm_cmpgt_epi8(_mm_setzero_si128(), v));
+}
+
+/**
+ * @brief Zero extends the lower 4 values to 32 bit
+ *
+ * @param v vector to widen
+ */
+inline Vect128i widen_lo(const Vect128u16& v) {
+    return _mm_unpacklo_epi16(v, _mm_setzero_si128());
+}
+
+/**
+ * @brief Zero extends the upper 4 values to 32 bit
+ *
+ * @param v vector to widen
+ */
+inline Vect128i widen_hi(const Vect128u16& v) {
+    return _mm_unpackhi_epi16(v, _mm_setzero_si128());
+}
+
+/**
+ * @brief Sign extends the lower 4 values to 32 bit
+ *
+ * @param v vector to widen
+ */
+inline Vect128i widen_lo(const Vect128i16& v) {
+    return _mm_unpacklo_epi16(v, _mm_cmpgt_epi16(_mm_setzero_si128(), v));
+}
+
+/**
+ * @brief Sign extends the upper 4 values to 32 bit
+ *
+ * @param v vector to widen
+ */
+inline Vect128i widen_hi(const Vect128i16& v) {
+    return _mm_unpackhi_epi16(v, _mm_cmpgt_epi16(_mm_setzero_si128(), v));
+}
+
+/**
+ * @brief Sign extends the lower 2 values to 64 bit
+ *
+ * @param v vector to widen
+ */
+inline Vect128i64 widen_lo(const Vect128i& v) {
+    return _mm_unpacklo_epi32(v, _mm_cmpgt_epi32(_mm_setzero_si128(), v));
+}
+
+/**
+ * @brief Sign extends the upper 2 values to 64 bit
+ *
+ * @param v vector to widen
+ */
+inline Vect128i64 widen_hi(const Vect128i& v) {
+    return _mm_unpackhi_epi32(v, _mm_cmpgt_epi32(_mm_setzero_si128(), v));
+}
+
+/**
+ * @brief Narrows two vectors to 8 bit, saturating to [-128, 127]
+ *
+ * @param lo values for lanes 0 to 7
+ * @param hi values for lanes 8 to 15
+ */
+inline Vect128i8 narrow(const Vect128i16& lo, const Vect128i16& hi) {
+    return _mm_packs_epi16(lo, hi);
+}
+
+/**
+ * @brief Narrows two vectors to 8 bit, saturating to [0, 255]
+ *
+ * @param lo values for lanes 0 to 7
+ * @param hi values for lanes 8 to 15
+ */
+inline Vect128u8 narrow(const Vect128u16& lo, const Vect128u16& hi) {
+    // packus reads its input as signed, so clamp to 255 first
+    const Vect128u16 limit(255);
+    return _mm_packus_epi16(lowest(lo, limit), lowest(hi, limit));
+}
+
+/**
+ * @brief Narrows two signed vectors to unsigned 8 bit, saturating to
+ * [0, 255]
+ *
+ * The usual last step of image filters that work on 16 bit
+ *
+ * @param lo values for lanes 0 to 7
+ * @param hi values for lanes 8 to 15
+ */
+inline Vect128u8 narrow_unsigned(const Vect128i16& lo, const Vect128i16& hi) {
+    return _mm_packus_epi16(lo, hi);
+}
+
+/**
+ * @brief Narrows two vectors to 16 bit, saturating to [-32768, 32767]
+ *
+ * @param lo values for lanes 0 to 3
+ * @param hi values for lanes 4 to 7
+ */
+inline Vect128i16 narrow(const Vect128i& lo, const Vect128i& hi) {
+    return _mm_packs_epi32(lo, hi);
+}
+
+/**
+ * @brief Narrows two signed vectors to unsigned 16 bit, saturating to
+ * [0, 65535]
+ *
+ * @param lo values for lanes 0 to 3
+ * @param hi values for lanes 4 to 7
+ */
+inline Vect128u16 narrow_unsigned(const Vect128i& lo, const Vect128i& hi) {
+    #ifdef HAVE_SSE41
+    return _mm_packus_epi32(lo, hi);
+    #else
+    // clamp to [0, 65535], then bias into int16 range for packs
+    Vect128i bias(32768);
+    Vect128i l = highest(lowest(lo, Vect128i(65535)), Vect128i(0)) - bias;
+    Vect128i h = highest(lowest(hi, Vect128i(65535)), Vect128i(0)) - bias;
+    return _mm_xor_si128(_mm_packs_epi32(l, h),
+                         _mm_set1_epi16(static_cast<int16_t>(0x8000)));
+    #endif
+}
+
+/**
+ * @brief Narrows two vectors to 32 bit, keeping the low bits
+ *
+ * @param lo values for lanes 0 and 1
+ * @param hi values for lanes 2 and 3
+ */
+inline Vect128i narrow(const Vect128i64& lo, const Vect128i64& hi) {
+    return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo),
+                                           _mm_castsi128_ps(hi),
+                                           _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+/**
+ * @brief Looks up each lane in a 16 entry table (r[i] = table[idx[i] & 15])
+ *
+ * A single pshufb with HAVE_SSE3 (SSSE3), so tables that fit a register
+ * (nibble counts, small palettes) cost about as much as an add
+ *
+ * @param table values to pick from
+ * @param idx index of each lane, only the low 4 bits are used
+ */
+inline Vect128u8 lookup(const Vect128u8& table, const Vect128u8& idx) {
+    __m128i i = _mm_and_si128(idx, _mm_set1_epi8(15));
+    #ifdef HAVE_SSE3
+    return _mm_shuffle_epi8(table, i);
+    #else
+    alignas(16) uint8_t t[16], j[16];
+    table.store(t);
+    _mm_store_si128(reinterpret_cast<__m128i*>(j), i);
+    for (int l = 0; l < 16; l++) {
+        j[l] = t[j[l]];
+    }
+    return Vect128u8::load(j);
+    #endif
+}
+
+/**
+ * @brief Looks up each lane in a 16 entry table (r[i] = table[idx[i] & 15])
+ *
+ * @param table values to pick from
+ * @param idx index of each lane, only the low 4 bits are used
+ */
+inline Vect128i8 lookup(const Vect128i8& table, const Vect128u8& idx) {
+    return static_cast<__m128i>(
+        lookup(Vect128u8(static_cast<__m128i>(table)), idx));
+}
+
+}  // namespace sight
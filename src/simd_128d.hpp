@@ -0,0 +1,516 @@
+#pragma once
+
+#include "simd.hpp"
+#include "simd_128.hpp"
+#include <cstdint>
+
+namespace sight {
+using Vect128d = Vect<double, 2>;
+
+/**
+ * @brief 128 bit vector of float64
+ */
+template <>
+class Vect<double, 2> {
+  private:
+    __m128d val;
+
+  public:
+    /// Type of each lane
+    typedef double value_type;
+
+    /// Number of lanes in the vector
+    enum { lanes = 2 };
+
+    /**
+     * @brief Empty vector
+     */
+    inline Vect() {}
+
+    /**
+     * @brief Fill vector with i
+     *
+     * @param i value to set every entry to
+     */
+    inline explicit Vect(double i) {
+        val = _mm_set1_pd(i);
+    }
+
+    /**
+     * @brief Convert native __m128d to abstract Vect128d
+     *
+     * @param v vector to use
+     */
+    inline Vect(__m128d v) : val(v) {}  // NOLINT(runtime/explicit)
+
+    /**
+     * @brief Fill vector with values
+     *
+     * @param i0, i1 values to use
+     */
+    inline Vect(double i0, double i1) {
+        val = _mm_setr_pd(i0, i1);
+    }
+
+    /**
+     * @brief Access value directly
+     *
+     * Be aware that this method does not do bounds checking, and that it is
+     * probably the most inefficient way to do anything - only use for
+     * debugging
+     *
+     * @param idx index in vector
+     */
+    inline double operator[](unsigned int idx) const {
+        double array[2];
+        storeu(array);
+        return array[idx];
+    }
+
+    /**
+     * @brief Loads vector values from an arbitrary point
+     *
+     * It is preferable to use an aligned pointer, as it can use the aligned
+     * load operator, which performs operations much faster in most CPUs
+     *
+     * @param p loads 128 bits starting at p
+     */
+    static inline Vect128d loadu(const double* p) {
+        return _mm_loadu_pd(p);
+    }
+
+    /**
+     * @brief Loads vector values from an aligned pointer in memory
+     *
+     * This operation is preferable because the compiler can guarantee an
+     * aligned load operation, which is faster on most CPUs
+     *
+     * @param p loads 128 bits starting at p
+     */
+    static inline Vect128d load(const double* p) {
+        return _mm_load_pd(p);
+    }
+
+    /**
+     * @brief Loads the first n values from p, the other lanes are 0
+     *
+     * Nothing past p + n is read, so this is safe at the end of an array
+     *
+     * @param p values to load, no alignment needed
+     * @param n amount of values, 0 to 2
+     */
+    static inline Vect128d load_partial(const double* p, int n) {
+        #ifdef HAVE_AVX
+        // two 32 bit mask lanes per double
+        __m128i mask = detail::laneMask128(2 * n);
+        return _mm_maskload_pd(p, mask);
+        #else
+        return detail::loadPartial<Vect128d>(p, n);
+        #endif
+    }
+
+    /**
+     * @brief Inserts the vector in a point in memory
+     *
+     * It is preferable to use an aligned pointer, as it can use the aligned
+     * store operator, which performs operations much faster in most CPUs
+     *
+     * @param p stores 128 bits starting at p
+     */
+    inline void storeu(double* p) const {
+        _mm_storeu_pd(p, val);
+    }
+
+    /**
+     * @brief Inserts this vector in a aligned point in memory
+     *
+     * This operation is preferable because the compiler can guarantee an
+     * aligned store operation, which is faster on most CPUs
+     *
+     * @param p stores 128 bits starting at p
+     */
+    inline void store(double* p) const {
+        _mm_store_pd(p, val);
+    }
+
+    /**
+     * @brief Inserts this vector in a aligned point in memory, bypassing
+     * the cache
+     *
+     * A non-temporal store, for results that won't be read again soon
+     * (ie. arrays larger than the last level cache). Call streamFence()
+     * before other threads read the data
+     *
+     * @param p stores 128 bits starting at p
+     */
+    inline void stream(double* p) const {
+        _mm_stream_pd(p, val);
+    }
+
+    /**
+     * @brief Stores the first n values to p
+     *
+     * Nothing past p + n is written, so this is safe at the end of an array
+     *
+     * @param p where to store, no alignment needed
+     * @param n amount of values, 0 to 2
+     */
+    inline void store_partial(double* p, int n) const {
+        #ifdef HAVE_AVX
+        __m128i mask = detail::laneMask128(2 * n);
+        _mm_maskstore_pd(p, mask, val);
+        #else
+        detail::storePartial(*this, p, n);
+        #endif
+    }
+
+    /**
+     * @brief Sets vector values to native __m128d
+     *
+     * @param v vector to use
+     */
+    inline void operator=(__m128d v) {
+        val = v;
+    }
+
+    /**
+     * @brief Converts to a native __m128d
+     */
+    inline operator __m128d() const {
+        return val;
+    }
+
+    /**
+     * @brief Performs NOT (r[i] = ~this[i])
+     */
+    inline Vect128d operator~() const {
+        return operator^(_mm_castsi128_pd(_mm_set1_epi32(-1)));
+    }
+
+    /**
+     * @brief Adds vectors together (r[i] = this[i] + v[i])
+     *
+     * @param v vector to add
+     */
+    inline Vect128d operator+(const Vect128d& v) const {
+        return _mm_add_pd(val, v);
+    }
+
+    /**
+     * @brief Subtracts vector (r[i] = this[i] - v[i])
+     *
+     * @param v vector to subtract
+     */
+    inline Vect128d operator-(const Vect128d& v) const {
+        return _mm_sub_pd(val, v);
+    }
+
+    /**
+     * @brief Multiplies vectors together (r[i] = this[i] * v[i])
+     *
+     * @param v vector to multiply
+     */
+    inline Vect128d operator*(const Vect128d& v) const {
+        return _mm_mul_pd(val, v);
+    }
+
+    /**
+     * @brief Divides vectors (r[i] = this[i] / v[i])
+     *
+     * @param v vector to divide by
+     */
+    inline Vect128d operator/(const Vect128d& v) const {
+        return _mm_div_pd(val, v);
+    }
+
+    /**
+     * @brief Performs AND comparison (r[i] = this[i] & v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect128d operator&(const Vect128d& v) const {
+        return _mm_and_pd(val, v);
+    }
+
+    /**
+     * @brief Performs OR comparison (r[i] = this[i] | v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect128d operator|(const Vect128d& v) const {
+        return _mm_or_pd(val, v);
+    }
+
+    /**
+     * @brief Performs XOR comparison (r[i] = this[i] ^ v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect128d operator^(const Vect128d& v) const {
+        return _mm_xor_pd(val, v);
+    }
+
+    /**
+     * @brief Performs less-than comparison (r[i] = this[i] < v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect128d operator<(const Vect128d& v) const {
+        return _mm_cmplt_pd(val, v);
+    }
+
+    /**
+     * @brief Performs less-than-or-equal-to comparison (r[i] = this[i] <= v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect128d operator<=(const Vect128d& v) const {
+        return _mm_cmpngt_pd(val, v);
+    }
+
+    /**
+     * @brief Performs larger-than comparison (r[i] = this[i] > v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect128d operator>(const Vect128d& v) const {
+        return _mm_cmpgt_pd(val, v);
+    }
+
+    /**
+     * @brief Performs greater-than-or-equal-to comparison
+     * (r[i] = this[i] >= v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect128d operator>=(const Vect128d& v) const {
+        return _mm_cmpnlt_pd(val, v);
+    }
+
+    /**
+     * @brief Performs equal-to comparison (r[i] = this[i] == v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect128d operator==(const Vect128d& v) const {
+        return _mm_cmpeq_pd(val, v);
+    }
+
+    /**
+     * @brief Performs not-equal-to comparison (r[i] = this[i] != v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect128d operator!=(const Vect128d& v) const {
+        return _mm_cmpneq_pd(val, v);
+    }
+
+    /**
+     * @brief Add vector (this[i] = this[i] + v[i])
+     *
+     * @param v vector to add
+     */
+    inline void operator+=(const Vect128d& v) {
+        val = operator+(v);
+    }
+
+    /**
+     * @brief Subtracts vector (this[i] = this[i] - v[i])
+     *
+     * @param v vector to subtract
+     */
+    inline void operator-=(const Vect128d& v) {
+        val = operator-(v);
+    }
+
+    /**
+     * @brief Multiples vector (this[i] = this[i] * v[i])
+     *
+     * @param v vector to multiply
+     */
+    inline void operator*=(const Vect128d& v) {
+        val = operator*(v);
+    }
+
+    /**
+     * @brief AND operation with vector (this[i] = this[i] & v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator&=(const Vect128d& v) {
+        val = operator&(v);
+    }
+
+    /**
+     * @brief OR operation with vector (this[i] = this[i] | v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator|=(const Vect128d& v) {
+        val = operator|(v);
+    }
+
+    /**
+     * @brief XOR operation with vector (this[i] = this[i] ^ v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator^=(const Vect128d& v) {
+        val = operator^(v);
+    }
+};
+
+/**
+ * @brief Returns lowest of each value
+ *
+ * @param v first vector to compare
+ * @param v2 second vector to compare
+ * @return lowest of v[i] and v2[i]
+ */
+inline Vect128d lowest(const Vect128d& v, const Vect128d& v2) {
+    return _mm_min_pd(v, v2);
+}
+
+/**
+ * @brief Returns highest of each value
+ *
+ * @param v first vector to compare
+ * @param v2 second vector to compare
+ * @return highest of v[i] and v2[i]
+ */
+inline Vect128d highest(const Vect128d& v, const Vect128d& v2) {
+    return _mm_max_pd(v, v2);
+}
+
+/**
+ * @brief The square root of values in a vector
+ *
+ * @param v vector of values
+ * @return sqrt(v[i]), correctly rounded
+ */
+inline Vect128d sqrt(const Vect128d& v) {
+    return _mm_sqrt_pd(v);
+}
+
+/**
+ * @brief Fused multiply-add (r[i] = a[i] * b[i] + c[i])
+ *
+ * Rounded once when HAVE_FMA is set, otherwise a multiply and an add
+ *
+ * @param a, b vectors to multiply
+ * @param c vector to add
+ */
+inline Vect128d fma(const Vect128d& a, const Vect128d& b,
+                    const Vect128d& c) {
+    #ifdef HAVE_FMA
+    return _mm_fmadd_pd(a, b, c);
+    #else
+    return a * b + c;
+    #endif
+}
+
+/**
+ * @brief Picks values from two vectors using a comparison result
+ * (r[i] = m[i] ? a[i] : b[i])
+ *
+ * @param m comparison result, lanes all ones or all zeros
+ * @param a values used where m is set
+ * @param b values used where m is not set
+ */
+inline Vect128d select(const Vect128d& m, const Vect128d& a,
+                       const Vect128d& b) {
+    #ifdef HAVE_SSE41
+    return _mm_blendv_pd(b, a, m);
+    #else
+    return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b));
+    #endif
+}
+
+/**
+ * @brief Bits of a comparison result, lane i is bit i
+ *
+ * @param m comparison result
+ */
+inline uint32_t movemask(const Vect128d& m) {
+    return _mm_movemask_pd(m);
+}
+
+/**
+ * @brief Checks if any lane of a comparison result is set
+ *
+ * @param m comparison result
+ */
+inline bool any(const Vect128d& m) {
+    return _mm_movemask_pd(m) != 0;
+}
+
+/**
+ * @brief Checks if every lane of a comparison result is set
+ *
+ * @param m comparison result
+ */
+inline bool all(const Vect128d& m) {
+    return _mm_movemask_pd(m) == 0x3;
+}
+
+/**
+ * @brief Checks if no lane of a comparison result is set
+ *
+ * @param m comparison result
+ */
+inline bool none(const Vect128d& m) {
+    return _mm_movemask_pd(m) == 0;
+}
+
+/**
+ * @brief Sum of every value in a vector
+ *
+ * @param v vector to sum
+ * @return v[0] + v[1]
+ */
+inline double hsum(const Vect128d& v) {
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+/**
+ * @brief Converts the lower two floats to double
+ *
+ * @param v vector to convert
+ * @return v[0], v[1] as doubles
+ */
+inline Vect128d widen_lo(const Vect128f& v) {
+    return _mm_cvtps_pd(v);
+}
+
+/**
+ * @brief Converts the upper two floats to double
+ *
+ * @param v vector to convert
+ * @return v[2], v[3] as doubles
+ */
+inline Vect128d widen_hi(const Vect128f& v) {
+    return _mm_cvtps_pd(_mm_movehl_ps(v, v));
+}
+
+/**
+ * @brief Converts two vectors of double to one vector of float
+ *
+ * @param lo values for lanes 0 and 1
+ * @param hi values for lanes 2 and 3
+ * @return lo[0], lo[1], hi[0], hi[1] rounded to float
+ */
+inline Vect128f narrow(const Vect128d& lo, const Vect128d& hi) {
+    return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+}
+
+/**
+ * @brief Converts the lower two int32 to double (exact)
+ *
+ * @param v vector to convert
+ * @return v[0], v[1] as doubles
+ */
+inline Vect128d to_double(const Vect128i& v) {
+    return _mm_cvtepi32_pd(v);
+}
+
+}  // namespace sight
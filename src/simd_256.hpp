@@ -0,0 +1,1506 @@
+#pragma once
+
+#include "simd.hpp"
+#include "simd_128.hpp"
+#include <cstdint>
+#include <algorithm>
+
+#ifdef HAVE_AVX
+
+namespace sight {
+using Vect256i = Vect<int32_t, 8>;
+using Vect256f = Vect<float, 8>;
+
+namespace detail {
+
+/// Mask for _mm256_maskload & maskstore of the first n (0 to 8) lanes
+inline __m256i laneMask256(int n) {
+    return _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(firstLanes(n)));
+}
+
+/// Joins two 128 bit halves into one 256 bit integer vector
+inline __m256i combine(const Vect128i& lo, const Vect128i& hi) {
+    return _mm256_insertf128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+/// Joins two 128 bit halves into one 256 bit float vector
+inline __m256 combine(const Vect128f& lo, const Vect128f& hi) {
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+/// Lower 128 bits of a 256 bit integer vector
+inline Vect128i low(__m256i v) {
+    return _mm256_castsi256_si128(v);
+}
+
+/// Upper 128 bits of a 256 bit integer vector
+inline Vect128i high(__m256i v) {
+    return _mm256_extractf128_si256(v, 1);
+}
+
+/// Lower 128 bits of a 256 bit float vector
+inline Vect128f low(__m256 v) {
+    return _mm256_castps256_ps128(v);
+}
+
+/// Upper 128 bits of a 256 bit float vector
+inline Vect128f high(__m256 v) {
+    return _mm256_extractf128_ps(v, 1);
+}
+
+}  // namespace detail
+
+/**
+ * @brief 256 bit vector of int32
+ *
+ * Integer arithmetic needs AVX2, when only AVX is available the operations
+ * are split into two 128 bit halves
+ */
+template <>
+class Vect<int32_t, 8> {
+  private:
+    __m256i val;
+
+  public:
+    /// Type of each lane
+    typedef int32_t value_type;
+
+    /// Number of lanes in the vector
+    enum { lanes = 8 };
+
+    /**
+     * @brief Empty vector
+     */
+    inline Vect() {}
+
+    /**
+     * @brief Fill vector with i
+     *
+     * @param i value to set every entry to
+     */
+    inline explicit Vect(int32_t i) {
+        val = _mm256_set1_epi32(i);
+    }
+
+    /**
+     * @brief Convert native __m256i to abstract Vect256i
+     *
+     * @param v vector to use
+     */
+    inline Vect(__m256i v) : val(v) {}  // NOLINT(runtime/explicit)
+
+    /**
+     * @brief Fill vector with values
+     *
+     * @param i0, i1, i2, i3, i4, i5, i6, i7 values to use
+     */
+    inline Vect(int32_t i0, int32_t i1, int32_t i2, int32_t i3,
+                int32_t i4, int32_t i5, int32_t i6, int32_t i7) {
+        val = _mm256_setr_epi32(i0, i1, i2, i3, i4, i5, i6, i7);
+    }
+
+    /**
+     * @brief Access value directly
+     *
+     * Be aware that this method does not do bounds checking, and that it is
+     * probably the most inefficient way to do anything - only use for
+     * debugging
+     *
+     * @param idx index in vector
+     */
+    inline int32_t operator[](unsigned int idx) const {
+        int32_t array[8];
+        storeu(array);
+        return array[idx];
+    }
+
+    /**
+     * @brief Loads vector values from an arbitrary point
+     *
+     * It is preferable to use an aligned pointer, as it can use the aligned
+     * load operator, which performs operations much faster in most CPUs
+     *
+     * @param p loads 256 bits starting at p
+     */
+    static inline Vect256i loadu(const int32_t* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+
+    /**
+     * @brief Loads vector values from an aligned pointer in memory
+     *
+     * This operation is preferable because the compiler can guarantee an
+     * aligned load operation, which is faster on most CPUs
+     *
+     * @param p loads 256 bits starting at p (must be aligned to 32 bytes)
+     */
+    static inline Vect256i load(const int32_t* p) {
+        return _mm256_load_si256(reinterpret_cast<const __m256i*>(p));
+    }
+
+    /**
+     * @brief Loads the first n values from p, the other lanes are 0
+     *
+     * Nothing past p + n is read, so this is safe at the end of an array
+     *
+     * @param p values to load, no alignment needed
+     * @param n amount of values, 0 to 8
+     */
+    static inline Vect256i load_partial(const int32_t* p, int n) {
+        __m256i mask = detail::laneMask256(n);
+        return _mm256_castps_si256(
+            _mm256_maskload_ps(reinterpret_cast<const float*>(p), mask));
+    }
+
+    /**
+     * @brief Inserts the vector in a point in memory
+     *
+     * It is preferable to use an aligned pointer, as it can use the aligned
+     * store operator, which performs operations much faster in most CPUs
+     *
+     * @param p stores 256 bits starting at p
+     */
+    inline void storeu(int32_t* p) const {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), val);
+    }
+
+    /**
+     * @brief Inserts this vector in a aligned point in memory
+     *
+     * This operation is preferable because the compiler can guarantee an
+     * aligned store operation, which is faster on most CPUs
+     *
+     * @param p stores 256 bits starting at p (must be aligned to 32 bytes)
+     */
+    inline void store(int32_t* p) const {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(p), val);
+    }
+
+    /**
+     * @brief Inserts this vector in a aligned point in memory, bypassing
+     * the cache
+     *
+     * A non-temporal store, for results that won't be read again soon
+     * (ie. arrays larger than the last level cache). Call streamFence()
+     * before other threads read the data
+     *
+     * @param p stores 256 bits starting at p
+     */
+    inline void stream(int32_t* p) const {
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(p), val);
+    }
+
+    /**
+     * @brief Stores the first n values to p
+     *
+     * Nothing past p + n is written, so this is safe at the end of an array
+     *
+     * @param p where to store, no alignment needed
+     * @param n amount of values, 0 to 8
+     */
+    inline void store_partial(int32_t* p, int n) const {
+        __m256i mask = detail::laneMask256(n);
+        _mm256_maskstore_ps(reinterpret_cast<float*>(p), mask,
+                            _mm256_castsi256_ps(val));
+    }
+
+    /**
+     * @brief Sets vector values to native __m256i
+     *
+     * @param v vector to use
+     */
+    inline void operator=(__m256i v) {
+        val = v;
+    }
+
+    /**
+     * @brief Converts to a native __m256i
+     */
+    inline operator __m256i() const {
+        return val;
+    }
+
+    /**
+     * @brief Converts to a floating point representation
+     */
+    inline operator Vect256f() const;
+
+    /**
+     * @brief Performs NOT (r[i] = ~this[i])
+     */
+    inline Vect256i operator~() const {
+        return operator^(Vect256i(0xFFFFFFFF));
+    }
+
+    /**
+     * @brief Adds vectors together (r[i] = this[i] + v[i])
+     *
+     * @param v vector to add
+     */
+    inline Vect256i operator+(const Vect256i& v) const {
+        #ifdef HAVE_AVX2
+        return _mm256_add_epi32(val, v);
+        #else
+        return detail::combine(detail::low(val) + detail::low(v),
+                               detail::high(val) + detail::high(v));
+        #endif
+    }
+
+    /**
+     * @brief Subtracts vector (r[i] = this[i] - v[i])
+     *
+     * @param v vector to subtract
+     */
+    inline Vect256i operator-(const Vect256i& v) const {
+        #ifdef HAVE_AVX2
+        return _mm256_sub_epi32(val, v);
+        #else
+        return detail::combine(detail::low(val) - detail::low(v),
+                               detail::high(val) - detail::high(v));
+        #endif
+    }
+
+    /**
+     * @brief Multiplies vectors together (r[i] = this[i] * v[i])
+     *
+     * @param v vector to multiply
+     */
+    inline Vect256i operator*(const Vect256i& v) const {
+        #ifdef HAVE_AVX2
+        return _mm256_mullo_epi32(val, v);
+        #else
+        return detail::combine(detail::low(val) * detail::low(v),
+                               detail::high(val) * detail::high(v));
+        #endif
+    }
+
+    /**
+     * @brief Performs AND comparison (r[i] = this[i] & v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect256i operator&(const Vect256i& v) const {
+        #ifdef HAVE_AVX2
+        return _mm256_and_si256(val, v);
+        #else
+        return _mm256_castps_si256(_mm256_and_ps(_mm256_castsi256_ps(val),
+                                                 _mm256_castsi256_ps(v)));
+        #endif
+    }
+
+    /**
+     * @brief Performs OR comparison (r[i] = this[i] | v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect256i operator|(const Vect256i& v) const {
+        #ifdef HAVE_AVX2
+        return _mm256_or_si256(val, v);
+        #else
+        return _mm256_castps_si256(_mm256_or_ps(_mm256_castsi256_ps(val),
+                                                _mm256_castsi256_ps(v)));
+        #endif
+    }
+
+    /**
+     * @brief Performs XOR comparison (r[i] = this[i] ^ v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect256i operator^(const Vect256i& v) const {
+        #ifdef HAVE_AVX2
+        return _mm256_xor_si256(val, v);
+        #else
+        return _mm256_castps_si256(_mm256_xor_ps(_mm256_castsi256_ps(val),
+                                                 _mm256_castsi256_ps(v)));
+        #endif
+    }
+
+    /**
+     * @brief Performs less-than comparison (r[i] = this[i] < v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect256i operator<(const Vect256i& v) const {
+        #ifdef HAVE_AVX2
+        return _mm256_cmpgt_epi32(v, val);
+        #else
+        return detail::combine(detail::low(val) < detail::low(v),
+                               detail::high(val) < detail::high(v));
+        #endif
+    }
+
+    /**
+     * @brief Performs less-than-or-equal-to comparison (r[i] = this[i] <= v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect256i operator<=(const Vect256i& v) const {
+        return ~(operator>(v));
+    }
+
+    /**
+     * @brief Performs larger-than comparison (r[i] = this[i] > v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect256i operator>(const Vect256i& v) const {
+        #ifdef HAVE_AVX2
+        return _mm256_cmpgt_epi32(val, v);
+        #else
+        return detail::combine(detail::low(val) > detail::low(v),
+                               detail::high(val) > detail::high(v));
+        #endif
+    }
+
+    /**
+     * @brief Performs greater-than-or-equal-to comparison
+     * (r[i] = this[i] >= v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect256i operator>=(const Vect256i& v) const {
+        return ~(operator<(v));
+    }
+
+    /**
+     * @brief Performs equal-to comparison (r[i] = this[i] == v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect256i operator==(const Vect256i& v) const {
+        #ifdef HAVE_AVX2
+        return _mm256_cmpeq_epi32(val, v);
+        #else
+        return detail::combine(detail::low(val) == detail::low(v),
+                               detail::high(val) == detail::high(v));
+        #endif
+    }
+
+    /**
+     * @brief Performs not-equal-to comparison (r[i] = this[i] != v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect256i operator!=(const Vect256i& v) const {
+        return ~(operator==(v));
+    }
+
+    /**
+     * @brief Add vector (this[i] = this[i] + v[i])
+     *
+     * @param v vector to add
+     */
+    inline void operator+=(const Vect256i& v) {
+        val = operator+(v);
+    }
+
+    /**
+     * @brief Subtracts vector (this[i] = this[i] - v[i])
+     *
+     * @param v vector to subtract
+     */
+    inline void operator-=(const Vect256i& v) {
+        val = operator-(v);
+    }
+
+    /**
+     * @brief Multiples vector (this[i] = this[i] * v[i])
+     *
+     * @param v vector to multiply
+     */
+    inline void operator*=(const Vect256i& v) {
+        val = operator*(v);
+    }
+
+    /**
+     * @brief AND operation with vector (this[i] = this[i] & v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator&=(const Vect256i& v) {
+        val = operator&(v);
+    }
+
+    /**
+     * @brief OR operation with vector (this[i] = this[i] | v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator|=(const Vect256i& v) {
+        val = operator|(v);
+    }
+
+    /**
+     * @brief XOR operation with vector (this[i] = this[i] ^ v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator^=(const Vect256i& v) {
+        val = operator^(v);
+    }
+};
+
+/**
+ * @brief 256 bit vector of float32
+ */
+template <>
+class Vect<float, 8> {
+  private:
+    __m256 val;
+
+  public:
+    /// Type of each lane
+    typedef float value_type;
+
+    /// Number of lanes in the vector
+    enum { lanes = 8 };
+
+    /**
+     * @brief Empty vector
+     */
+    inline Vect() {}
+
+    /**
+     * @brief Fill vector with i
+     *
+     * @param i value to set every entry to
+     */
+    inline explicit Vect(float i) {
+        val = _mm256_set1_ps(i);
+    }
+
+    /**
+     * @brief Convert native __m256 to abstract Vect256f
+     *
+     * @param v vector to use
+     */
+    inline Vect(__m256 v) : val(v) {}  // NOLINT(runtime/explicit)
+
+    /**
+     * @brief Fill vector with values
+     *
+     * @param i0, i1, i2, i3, i4, i5, i6, i7 values to use
+     */
+    inline Vect(float i0, float i1, float i2, float i3,
+                float i4, float i5, float i6, float i7) {
+        val = _mm256_setr_ps(i0, i1, i2, i3, i4, i5, i6, i7);
+    }
+
+    /**
+     * @brief Access value directly
+     *
+     * Be aware that this method does not do bounds checking, and that it is
+     * probably the most inefficient way to do anything - only use for
+     * debugging
+     *
+     * @param idx index in vector
+     */
+    inline float operator[](unsigned int idx) const {
+        float array[8];
+        storeu(array);
+        return array[idx];
+    }
+
+    /**
+     * @brief Loads vector values from an arbitrary point
+     *
+     * It is preferable to use an aligned pointer, as it can use the aligned
+     * load operator, which performs operations much faster in most CPUs
+     *
+     * @param p loads 256 bits starting at p
+     */
+    static inline Vect256f loadu(const float* p) {
+        return _mm256_loadu_ps(p);
+    }
+
+    /**
+     * @brief Loads vector values from an aligned pointer in memory
+     *
+     * This operation is preferable because the compiler can guarantee an
+     * aligned load operation, which is faster on most CPUs
+     *
+     * @param p loads 256 bits starting at p (must be aligned to 32 bytes)
+     */
+    static inline Vect256f load(const float* p) {
+        return _mm256_load_ps(p);
+    }
+
+    /**
+     * @brief Loads the first n values from p, the other lanes are 0
+     *
+     * Nothing past p + n is read, so this is safe at the end of an array
+     *
+     * @param p values to load, no alignment needed
+     * @param n amount of values, 0 to 8
+     */
+    static inline Vect256f load_partial(const float* p, int n) {
+        __m256i mask = detail::laneMask256(n);
+        return _mm256_maskload_ps(p, mask);
+    }
+
+    /**
+     * @brief Inserts the vector in a point in memory
+     *
+     * It is preferable to use an aligned pointer, as it can use the aligned
+     * store operator, which performs operations much faster in most CPUs
+     *
+     * @param p stores 256 bits starting at p
+     */
+    inline void storeu(float* p) const {
+        _mm256_storeu_ps(p, val);
+    }
+
+    /**
+     * @brief Inserts this vector in a aligned point in memory
+     *
+     * This operation is preferable because the compiler can guarantee an
+     * aligned store operation, which is faster on most CPUs
+     *
+     * @param p stores 256 bits starting at p (must be aligned to 32 bytes)
+     */
+    inline void store(float* p) const {
+        _mm256_store_ps(p, val);
+    }
+
+    /**
+     * @brief Inserts this vector in a aligned point in memory, bypassing
+     * the cache
+     *
+     * A non-temporal store, for results that won't be read again soon
+     * (ie. arrays larger than the last level cache). Call streamFence()
+     * before other threads read the data
+     *
+     * @param p stores 256 bits starting at p
+     */
+    inline void stream(float* p) const {
+        _mm256_stream_ps(p, val);
+    }
+
+    /**
+     * @brief Stores the first n values to p
+     *
+     * Nothing past p + n is written, so this is safe at the end of an array
+     *
+     * @param p where to store, no alignment needed
+     * @param n amount of values, 0 to 8
+     */
+    inline void store_partial(float* p, int n) const {
+        __m256i mask = detail::laneMask256(n);
+        _mm256_maskstore_ps(p, mask, val);
+    }
+
+    /**
+     * @brief Sets vector values to native __m256
+     *
+     * @param v vector to use
+     */
+    inline void operator=(__m256 v) {
+        val = v;
+    }
+
+    /**
+     * @brief Converts to a native __m256
+     */
+    inline operator __m256() const {
+        return val;
+    }
+
+    /**
+     * @brief Converts to a integer representation (truncating towards zero,
+     * INT32_MIN when out of range)
+     */
+    inline Vect256i to_int() const;
+
+    /**
+     * @brief Performs NOT (r[i] = ~this[i])
+     */
+    inline Vect256f operator~() const {
+        return operator^(_mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+    }
+
+    /**
+     * @brief Adds vectors together (r[i] = this[i] + v[i])
+     *
+     * @param v vector to add
+     */
+    inline Vect256f operator+(const Vect256f& v) const {
+        return _mm256_add_ps(val, v);
+    }
+
+    /**
+     * @brief Subtracts vector (r[i] = this[i] - v[i])
+     *
+     * @param v vector to subtract
+     */
+    inline Vect256f operator-(const Vect256f& v) const {
+        return _mm256_sub_ps(val, v);
+    }
+
+    /**
+     * @brief Multiplies vectors together (r[i] = this[i] * v[i])
+     *
+     * @param v vector to multiply
+     */
+    inline Vect256f operator*(const Vect256f& v) const {
+        return _mm256_mul_ps(val, v);
+    }
+
+    /**
+     * @brief Divides vectors (r[i] = this[i] / v[i])
+     *
+     * @param v vector to divide by
+     */
+    inline Vect256f operator/(const Vect256f& v) const {
+        return _mm256_div_ps(val, v);
+    }
+
+    /**
+     * @brief Performs AND comparison (r[i] = this[i] & v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect256f operator&(const Vect256f& v) const {
+        return _mm256_and_ps(val, v);
+    }
+
+    /**
+     * @brief Performs OR comparison (r[i] = this[i] | v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect256f operator|(const Vect256f& v) const {
+        return _mm256_or_ps(val, v);
+    }
+
+    /**
+     * @brief Performs XOR comparison (r[i] = this[i] ^ v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect256f operator^(const Vect256f& v) const {
+        return _mm256_xor_ps(val, v);
+    }
+
+    /**
+     * @brief Performs less-than comparison (r[i] = this[i] < v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect256f operator<(const Vect256f& v) const {
+        return _mm256_cmp_ps(val, v, _CMP_LT_OS);
+    }
+
+    /**
+     * @brief Performs less-than-or-equal-to comparison (r[i] = this[i] <= v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect256f operator<=(const Vect256f& v) const {
+        return _mm256_cmp_ps(val, v, _CMP_NGT_US);
+    }
+
+    /**
+     * @brief Performs larger-than comparison (r[i] = this[i] > v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect256f operator>(const Vect256f& v) const {
+        return _mm256_cmp_ps(val, v, _CMP_GT_OS);
+    }
+
+    /**
+     * @brief Performs greater-than-or-equal-to comparison
+     * (r[i] = this[i] >= v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect256f operator>=(const Vect256f& v) const {
+        return _mm256_cmp_ps(val, v, _CMP_NLT_US);
+    }
+
+    /**
+     * @brief Performs equal-to comparison (r[i] = this[i] == v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect256f operator==(const Vect256f& v) const {
+        return _mm256_cmp_ps(val, v, _CMP_EQ_OQ);
+    }
+
+    /**
+     * @brief Performs not-equal-to comparison (r[i] = this[i] != v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect256f operator!=(const Vect256f& v) const {
+        return _mm256_cmp_ps(val, v, _CMP_NEQ_UQ);
+    }
+
+    /**
+     * @brief Add vector (this[i] = this[i] + v[i])
+     *
+     * @param v vector to add
+     */
+    inline void operator+=(const Vect256f& v) {
+        val = operator+(v);
+    }
+
+    /**
+     * @brief Subtracts vector (this[i] = this[i] - v[i])
+     *
+     * @param v vector to subtract
+     */
+    inline void operator-=(const Vect256f& v) {
+        val = operator-(v);
+    }
+
+    /**
+     * @brief Multiples vector (this[i] = this[i] * v[i])
+     *
+     * @param v vector to multiply
+     */
+    inline void operator*=(const Vect256f& v) {
+        val = operator*(v);
+    }
+
+    /**
+     * @brief AND operation with vector (this[i] = this[i] & v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator&=(const Vect256f& v) {
+        val = operator&(v);
+    }
+
+    /**
+     * @brief OR operation with vector (this[i] = this[i] | v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator|=(const Vect256f& v) {
+        val = operator|(v);
+    }
+
+    /**
+     * @brief XOR operation with vector (this[i] = this[i] ^ v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator^=(const Vect256f& v) {
+        val = operator^(v);
+    }
+};
+
+/**
+ * @brief Lane mask for 256 bit vectors
+ *
+ * Same as Mask128, comparisons of 256 bit vectors convert to it implicitly
+ */
+class Mask256 {
+  private:
+    __m256 val;
+
+  public:
+    /**
+     * @brief Empty mask
+     */
+    inline Mask256() {}
+
+    /**
+     * @brief Convert native __m256 lanes (all ones or zeros) to Mask256
+     *
+     * @param m mask to use
+     */
+    inline Mask256(__m256 m) : val(m) {}  // NOLINT(runtime/explicit)
+
+    /**
+     * @brief Use the result of a float comparison as a mask
+     *
+     * @param v vector with every lane all ones or all zeros
+     */
+    inline Mask256(const Vect256f& v) : val(v) {}  // NOLINT(runtime/explicit)
+
+    /**
+     * @brief Use the result of an integer comparison as a mask
+     *
+     * @param v vector with every lane all ones or all zeros
+     */
+    inline Mask256(const Vect256i& v)  // NOLINT(runtime/explicit)
+        : val(_mm256_castsi256_ps(v)) {}
+
+    /**
+     * @brief Converts to a native __m256
+     */
+    inline operator __m256() const {
+        return val;
+    }
+
+    /**
+     * @brief Bits of the mask, lane i is bit i
+     */
+    inline uint32_t bits() const {
+        return _mm256_movemask_ps(val);
+    }
+
+    /**
+     * @brief Checks whether a lane is set
+     *
+     * @param idx index in vector
+     */
+    inline bool operator[](unsigned int idx) const {
+        return (bits() >> idx) & 1;
+    }
+
+    /**
+     * @brief Performs NOT (r[i] = !this[i])
+     */
+    inline Mask256 operator~() const {
+        return _mm256_xor_ps(val, _mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+    }
+
+    /**
+     * @brief Performs AND (r[i] = this[i] & m[i])
+     *
+     * @param m mask to use
+     */
+    inline Mask256 operator&(const Mask256& m) const {
+        return _mm256_and_ps(val, m.val);
+    }
+
+    /**
+     * @brief Performs OR (r[i] = this[i] | m[i])
+     *
+     * @param m mask to use
+     */
+    inline Mask256 operator|(const Mask256& m) const {
+        return _mm256_or_ps(val, m.val);
+    }
+
+    /**
+     * @brief Performs XOR (r[i] = this[i] ^ m[i])
+     *
+     * @param m mask to use
+     */
+    inline Mask256 operator^(const Mask256& m) const {
+        return _mm256_xor_ps(val, m.val);
+    }
+};
+
+Vect256i::operator Vect256f() const {
+    return _mm256_cvtepi32_ps(val);
+}
+
+Vect256i Vect256f::to_int() const {
+    return _mm256_cvttps_epi32(val);
+}
+
+/**
+ * @brief Reinterprets the bits of a float vector as int32
+ *
+ * Unlike to_int() nothing is converted, ie. 1.0f gives 0x3F800000
+ *
+ * @param v vector to reinterpret
+ */
+inline Vect256i as_int(const Vect256f& v) {
+    return _mm256_castps_si256(v);
+}
+
+/**
+ * @brief Reinterprets the bits of an int32 vector as float
+ *
+ * Unlike the Vect256i to Vect256f conversion nothing is converted, ie.
+ * 0x3F800000 gives 1.0f
+ *
+ * @param v vector to reinterpret
+ */
+inline Vect256f as_float(const Vect256i& v) {
+    return _mm256_castsi256_ps(v);
+}
+
+/**
+ * @brief Returns lowest of each value
+ *
+ * @param v first vector
+ * @param v2 second vector
+ * @return minimum of v[i] and v2[i]
+ */
+inline Vect256i lowest(const Vect256i& v, const Vect256i& v2) {
+    #ifdef HAVE_AVX2
+    return _mm256_min_epi32(v, v2);
+    #else
+    return detail::combine(lowest(detail::low(v), detail::low(v2)),
+                           lowest(detail::high(v), detail::high(v2)));
+    #endif
+}
+
+/**
+ * @brief Returns lowest of each value
+ *
+ * @param v first vector
+ * @param v2 second vector
+ * @return minimum of v[i] and v2[i]
+ */
+inline Vect256f lowest(const Vect256f& v, const Vect256f& v2) {
+    return _mm256_min_ps(v, v2);
+}
+
+/**
+ * @brief Returns highest of each value
+ *
+ * @param v first vector
+ * @param v2 second vector
+ * @return maximum of v[i] and v2[i]
+ */
+inline Vect256i highest(const Vect256i& v, const Vect256i& v2) {
+    #ifdef HAVE_AVX2
+    return _mm256_max_epi32(v, v2);
+    #else
+    return detail::combine(highest(detail::low(v), detail::low(v2)),
+                           highest(detail::high(v), detail::high(v2)));
+    #endif
+}
+
+/**
+ * @brief Returns highest of each value
+ *
+ * @param v first vector
+ * @param v2 second vector
+ * @return maximum of v[i] and v2[i]
+ */
+inline Vect256f highest(const Vect256f& v, const Vect256f& v2) {
+    return _mm256_max_ps(v, v2);
+}
+
+/**
+ * @brief Rounds each value the closest integer, ties to even
+ *
+ * @param v vector of values to round
+ */
+inline Vect256f round_nearest(const Vect256f& v) {
+    return _mm256_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+
+/**
+ * @brief Rounds each value towards zero (like std::trunc)
+ *
+ * @param v vector of values to round
+ */
+inline Vect256f trunc(const Vect256f& v) {
+    return _mm256_round_ps(v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+}
+
+/**
+ * @brief Rounds each value down (like std::floor)
+ *
+ * @param v vector of values to round
+ */
+inline Vect256f floor(const Vect256f& v) {
+    return _mm256_round_ps(v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+}
+
+/**
+ * @brief Rounds each value up (like std::ceil)
+ *
+ * @param v vector of values to round
+ */
+inline Vect256f ceil(const Vect256f& v) {
+    return _mm256_round_ps(v, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC);
+}
+
+/**
+ * @brief Converts to int32 with the current rounding mode
+ *
+ * Ties go to even in the default mode, see the Vect128f version
+ *
+ * @param v vector of values to convert
+ */
+inline Vect256i to_int_nearest(const Vect256f& v) {
+    return _mm256_cvtps_epi32(v);
+}
+
+/**
+ * @brief The reciprocal square root of values in a vector
+ *
+ * @param v starting values
+ * @return 1 / sqrt(v[i])
+ */
+inline Vect256f rsqrt(const Vect256f& v) {
+    return _mm256_rsqrt_ps(v);
+}
+
+/**
+ * @brief The reciprocal of values in a vector
+ *
+ * @param v starting values
+ * @return 1 / v[i]
+ */
+inline Vect256f reciprocal(const Vect256f& v) {
+    return _mm256_rcp_ps(v);
+}
+
+/**
+ * @brief The square root of values in a vector
+ *
+ * This method isn't guaranteed to be accurate, see sqrt_precise()
+ *
+ * @param v starting values
+ * @return the square root of v[i]
+ */
+inline Vect256f sqrt(const Vect256f& v) {
+    return reciprocal(rsqrt(v));
+}
+
+/**
+ * @brief Fused multiply-add (r[i] = a[i] * b[i] + c[i])
+ *
+ * Rounds once with FMA, without it the multiply and add round separately
+ *
+ * @param a, b values to multiply
+ * @param c value to add (or subtract)
+ */
+inline Vect256f fma(const Vect256f& a, const Vect256f& b,
+                    const Vect256f& c) {
+    #ifdef HAVE_FMA
+    return _mm256_fmadd_ps(a, b, c);
+    #else
+    return a * b + c;
+    #endif
+}
+
+/**
+ * @brief Fused multiply-subtract (r[i] = a[i] * b[i] - c[i])
+ *
+ * Rounds once with FMA, without it the multiply and add round separately
+ *
+ * @param a, b values to multiply
+ * @param c value to add (or subtract)
+ */
+inline Vect256f fms(const Vect256f& a, const Vect256f& b,
+                    const Vect256f& c) {
+    #ifdef HAVE_FMA
+    return _mm256_fmsub_ps(a, b, c);
+    #else
+    return a * b - c;
+    #endif
+}
+
+/**
+ * @brief Fused negated multiply-add (r[i] = c[i] - a[i] * b[i])
+ *
+ * Rounds once with FMA, without it the multiply and add round separately
+ *
+ * @param a, b values to multiply
+ * @param c value to add (or subtract)
+ */
+inline Vect256f fnma(const Vect256f& a, const Vect256f& b,
+                     const Vect256f& c) {
+    #ifdef HAVE_FMA
+    return _mm256_fnmadd_ps(a, b, c);
+    #else
+    return c - a * b;
+    #endif
+}
+
+/**
+ * @brief The square root of values in a vector, correctly rounded
+ *
+ * Uses the native square root instruction, which is slower than sqrt()
+ *
+ * @param v starting values
+ * @return the square root of v[i]
+ */
+inline Vect256f sqrt_precise(const Vect256f& v) {
+    return _mm256_sqrt_ps(v);
+}
+
+/**
+ * @brief The reciprocal square root of values in a vector, correctly rounded
+ *
+ * Uses the native square root and divide instructions
+ *
+ * @param v starting values
+ * @return 1 / sqrt(v[i])
+ */
+inline Vect256f rsqrt_precise(const Vect256f& v) {
+    return Vect256f(1) / sqrt_precise(v);
+}
+
+/**
+ * @brief The reciprocal of values in a vector, correctly rounded
+ *
+ * Uses the native divide instruction
+ *
+ * @param v starting values
+ * @return 1 / v[i]
+ */
+inline Vect256f reciprocal_precise(const Vect256f& v) {
+    return Vect256f(1) / v;
+}
+
+/**
+ * @brief The reciprocal square root of values in a vector, refined once
+ *
+ * One Newton-Raphson step on top of rsqrt(), which gets close to full float
+ * precision for much less than a square root and divide. 0 and infinity
+ * give NaN, use rsqrt_precise() if those can happen
+ *
+ * @param v starting values
+ * @return 1 / sqrt(v[i])
+ */
+inline Vect256f rsqrt_refined(const Vect256f& v) {
+    Vect256f y = rsqrt(v);
+    Vect256f half_y = Vect256f(0.5) * y;
+    return half_y * fnma(v * y, y, Vect256f(3));
+}
+
+/**
+ * @brief The reciprocal of values in a vector, refined once
+ *
+ * One Newton-Raphson step on top of reciprocal(), which gets close to full
+ * float precision for much less than a divide. 0 and infinity give NaN, use
+ * reciprocal_precise() if those can happen
+ *
+ * @param v starting values
+ * @return 1 / v[i]
+ */
+inline Vect256f reciprocal_refined(const Vect256f& v) {
+    Vect256f y = reciprocal(v);
+    return fma(y, fnma(v, y, Vect256f(1)), y);
+}
+
+/**
+ * @brief Reads one value of a vector without going through memory
+ *
+ * @param I index in vector (0 - 7)
+ * @param v vector to read from
+ * @return v[I]
+ */
+template <int I>
+inline int32_t extract(const Vect256i& v) {
+    static_assert(I >= 0 && I < 8, "index outside of vector");
+    return I < 4 ? extract<I % 4>(detail::low(v))
+                 : extract<I % 4>(detail::high(v));
+}
+
+/**
+ * @brief Reads one value of a vector without going through memory
+ *
+ * @param I index in vector (0 - 7)
+ * @param v vector to read from
+ * @return v[I]
+ */
+template <int I>
+inline float extract(const Vect256f& v) {
+    static_assert(I >= 0 && I < 8, "index outside of vector");
+    return I < 4 ? extract<I % 4>(detail::low(v))
+                 : extract<I % 4>(detail::high(v));
+}
+
+/**
+ * @brief Adds every value of a vector together
+ *
+ * @param v values to add
+ * @return v[0] + v[1] + ... + v[7]
+ */
+inline int32_t hsum(const Vect256i& v) {
+    return hsum(detail::low(v) + detail::high(v));
+}
+
+/**
+ * @brief Adds every value of a vector together
+ *
+ * @param v values to add
+ * @return v[0] + v[1] + ... + v[7]
+ */
+inline float hsum(const Vect256f& v) {
+    return hsum(detail::low(v) + detail::high(v));
+}
+
+/**
+ * @brief Lowest value of a vector
+ *
+ * @param v values to compare
+ * @return minimum of v[0], v[1], ..., v[7]
+ */
+inline int32_t hmin(const Vect256i& v) {
+    return hmin(lowest(detail::low(v), detail::high(v)));
+}
+
+/**
+ * @brief Lowest value of a vector
+ *
+ * @param v values to compare
+ * @return minimum of v[0], v[1], ..., v[7]
+ */
+inline float hmin(const Vect256f& v) {
+    return hmin(lowest(detail::low(v), detail::high(v)));
+}
+
+/**
+ * @brief Highest value of a vector
+ *
+ * @param v values to compare
+ * @return maximum of v[0], v[1], ..., v[7]
+ */
+inline int32_t hmax(const Vect256i& v) {
+    return hmax(highest(detail::low(v), detail::high(v)));
+}
+
+/**
+ * @brief Highest value of a vector
+ *
+ * @param v values to compare
+ * @return maximum of v[0], v[1], ..., v[7]
+ */
+inline float hmax(const Vect256f& v) {
+    return hmax(highest(detail::low(v), detail::high(v)));
+}
+
+/**
+ * @brief Dot product of two vectors
+ *
+ * @param v first vector
+ * @param v2 second vector
+ * @return v[0] * v2[0] + v[1] * v2[1] + ... + v[7] * v2[7]
+ */
+inline float dot(const Vect256f& v, const Vect256f& v2) {
+    return hsum(v * v2);
+}
+
+/**
+ * @brief Picks values from two vectors using a mask (r[i] = m[i] ? a[i] : b[i])
+ *
+ * @param m lanes to take from a
+ * @param a values used where m is set
+ * @param b values used where m is not set
+ */
+inline Vect256i select(const Mask256& m, const Vect256i& a, const Vect256i& b) {
+    #ifdef HAVE_AVX2
+    return _mm256_blendv_epi8(b, a, _mm256_castps_si256(m));
+    #else
+    return _mm256_castps_si256(_mm256_blendv_ps(
+        _mm256_castsi256_ps(b), _mm256_castsi256_ps(a), m));
+    #endif
+}
+
+/**
+ * @brief Picks values from two vectors using a mask (r[i] = m[i] ? a[i] : b[i])
+ *
+ * @param m lanes to take from a
+ * @param a values used where m is set
+ * @param b values used where m is not set
+ */
+inline Vect256f select(const Mask256& m, const Vect256f& a, const Vect256f& b) {
+    return _mm256_blendv_ps(b, a, m);
+}
+
+/**
+ * @brief Bits of a mask, lane i is bit i (like _mm_movemask_ps)
+ *
+ * @param m mask, ie. the result of a comparison
+ */
+inline uint32_t movemask(const Mask256& m) {
+    return m.bits();
+}
+
+/**
+ * @brief Checks if any lane of a mask is set
+ *
+ * @param m mask, ie. the result of a comparison
+ */
+inline bool any(const Mask256& m) {
+    return m.bits() != 0;
+}
+
+/**
+ * @brief Checks if every lane of a mask is set
+ *
+ * @param m mask, ie. the result of a comparison
+ */
+inline bool all(const Mask256& m) {
+    return m.bits() == 0xFF;
+}
+
+/**
+ * @brief Checks if no lane of a mask is set
+ *
+ * @param m mask, ie. the result of a comparison
+ */
+inline bool none(const Mask256& m) {
+    return m.bits() == 0;
+}
+
+/**
+ * @brief Shifts each value left by N bits (r[i] = v[i] << N)
+ *
+ * @param N amount of bits, 32 or more gives 0
+ * @param v vector to shift
+ */
+template <int N>
+inline Vect256i shl(const Vect256i& v) {
+    static_assert(N >= 0, "negative shift");
+    #ifdef HAVE_AVX2
+    return _mm256_slli_epi32(v, N);
+    #else
+    return detail::combine(shl<N>(detail::low(v)), shl<N>(detail::high(v)));
+    #endif
+}
+
+/**
+ * @brief Shifts each value right by N bits, filling with zeros
+ *
+ * @param N amount of bits, 32 or more gives 0
+ * @param v vector to shift
+ */
+template <int N>
+inline Vect256i shr(const Vect256i& v) {
+    static_assert(N >= 0, "negative shift");
+    #ifdef HAVE_AVX2
+    return _mm256_srli_epi32(v, N);
+    #else
+    return detail::combine(shr<N>(detail::low(v)), shr<N>(detail::high(v)));
+    #endif
+}
+
+/**
+ * @brief Shifts each value right by N bits, filling with the sign bit
+ *
+ * @param N amount of bits, 32 or more fills every bit with the sign
+ * @param v vector to shift
+ */
+template <int N>
+inline Vect256i sar(const Vect256i& v) {
+    static_assert(N >= 0, "negative shift");
+    #ifdef HAVE_AVX2
+    return _mm256_srai_epi32(v, N);
+    #else
+    return detail::combine(sar<N>(detail::low(v)), sar<N>(detail::high(v)));
+    #endif
+}
+
+/**
+ * @brief Shifts each value left by the same runtime amount
+ *
+ * @param v vector to shift
+ * @param count amount of bits, 32 or more gives 0
+ */
+inline Vect256i shl(const Vect256i& v, int count) {
+    #ifdef HAVE_AVX2
+    return _mm256_sll_epi32(v, _mm_cvtsi32_si128(count));
+    #else
+    return detail::combine(shl(detail::low(v), count),
+                           shl(detail::high(v), count));
+    #endif
+}
+
+/**
+ * @brief Shifts each value right by the same runtime amount, filling with
+ * zeros
+ *
+ * @param v vector to shift
+ * @param count amount of bits, 32 or more gives 0
+ */
+inline Vect256i shr(const Vect256i& v, int count) {
+    #ifdef HAVE_AVX2
+    return _mm256_srl_epi32(v, _mm_cvtsi32_si128(count));
+    #else
+    return detail::combine(shr(detail::low(v), count),
+                           shr(detail::high(v), count));
+    #endif
+}
+
+/**
+ * @brief Shifts each value right by the same runtime amount, filling with
+ * the sign bit
+ *
+ * @param v vector to shift
+ * @param count amount of bits, 32 or more fills every bit with the sign
+ */
+inline Vect256i sar(const Vect256i& v, int count) {
+    #ifdef HAVE_AVX2
+    return _mm256_sra_epi32(v, _mm_cvtsi32_si128(count));
+    #else
+    return detail::combine(sar(detail::low(v), count),
+                           sar(detail::high(v), count));
+    #endif
+}
+
+/**
+ * @brief High 32 bits of each signed 64 bit product (a[i] * b[i] >> 32)
+ *
+ * @param a, b vectors to multiply
+ */
+inline Vect256i mulhi(const Vect256i& a, const Vect256i& b) {
+    #ifdef HAVE_AVX2
+    __m256i even = _mm256_mul_epi32(a, b);
+    __m256i odd = _mm256_mul_epi32(_mm256_srli_epi64(a, 32),
+                                   _mm256_srli_epi64(b, 32));
+    // high halves of the even products go down, the odd ones stay
+    return _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+    #else
+    return detail::combine(mulhi(detail::low(a), detail::low(b)),
+                           mulhi(detail::high(a), detail::high(b)));
+    #endif
+}
+
+/**
+ * @brief Loads base[idx[i]] into each lane
+ *
+ * @param base start of the table
+ * @param idx index of each value, counted in int32's from base
+ */
+inline Vect256i gather(const int32_t* base, const Vect256i& idx) {
+    #ifdef HAVE_AVX2
+    return _mm256_i32gather_epi32(base, idx, 4);
+    #else
+    return detail::combine(gather(base, detail::low(idx)),
+                           gather(base, detail::high(idx)));
+    #endif
+}
+
+/**
+ * @brief Loads base[idx[i]] into each lane
+ *
+ * @param base start of the table
+ * @param idx index of each value, counted in floats from base
+ */
+inline Vect256f gather(const float* base, const Vect256i& idx) {
+    #ifdef HAVE_AVX2
+    return _mm256_i32gather_ps(base, idx, 4);
+    #else
+    return detail::combine(gather(base, detail::low(idx)),
+                           gather(base, detail::high(idx)));
+    #endif
+}
+
+/**
+ * @brief Stores each lane to base[idx[i]]
+ *
+ * Done lane by lane and in order, like the 128 bit version
+ *
+ * @param base start of the table
+ * @param idx index of each value, counted in int32's from base
+ * @param v values to store
+ */
+inline void scatter(int32_t* base, const Vect256i& idx, const Vect256i& v) {
+    scatter(base, detail::low(idx), detail::low(v));
+    scatter(base, detail::high(idx), detail::high(v));
+}
+
+/**
+ * @brief Stores each lane to base[idx[i]]
+ *
+ * @param base start of the table
+ * @param idx index of each value, counted in floats from base
+ * @param v values to store
+ */
+inline void scatter(float* base, const Vect256i& idx, const Vect256f& v) {
+    scatter(base, detail::low(idx), detail::low(v));
+    scatter(base, detail::high(idx), detail::high(v));
+}
+
+}  // namespace sight
+
+#endif  // HAVE_AVX
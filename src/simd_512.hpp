@@ -0,0 +1,1506 @@
+#pragma once
+
+#include "simd.hpp"
+#include "simd_128.hpp"
+#include <cstdint>
+
+#ifdef HAVE_AVX512F
+
+SIGHT_AVX512_WARNINGS_BEGIN
+
+namespace sight {
+using Vect512i = Vect<int32_t, 16>;
+using Vect512f = Vect<float, 16>;
+
+namespace detail {
+
+/// Mask register selecting the first n (0 to 16) lanes
+inline __mmask16 firstMask(int n) {
+    return static_cast<__mmask16>((1u << n) - 1);
+}
+
+}  // namespace detail
+
+/**
+ * @brief Lane mask for 512 bit vectors, backed by an AVX-512 mask register
+ *
+ * Comparisons of 512 bit vectors return one of these instead of all-ones
+ * lanes, so they can be fed straight into the masked operations below
+ */
+class Mask512 {
+  private:
+    __mmask16 val;
+
+  public:
+    /**
+     * @brief Empty mask
+     */
+    inline Mask512() {}
+
+    /**
+     * @brief Convert native __mmask16 to abstract Mask512
+     *
+     * @param m mask to use (bit i is lane i)
+     */
+    inline Mask512(__mmask16 m) : val(m) {}  // NOLINT(runtime/explicit)
+
+    /**
+     * @brief Converts to a native __mmask16
+     */
+    inline operator __mmask16() const {
+        return val;
+    }
+
+    /**
+     * @brief Bits of the mask, lane i is bit i
+     */
+    inline uint32_t bits() const {
+        return val;
+    }
+
+    /**
+     * @brief Checks whether a lane is set
+     *
+     * @param idx index in vector
+     */
+    inline bool operator[](unsigned int idx) const {
+        return (val >> idx) & 1;
+    }
+
+    /**
+     * @brief Performs NOT (r[i] = !this[i])
+     */
+    inline Mask512 operator~() const {
+        return static_cast<__mmask16>(~val);
+    }
+
+    /**
+     * @brief Performs AND (r[i] = this[i] & m[i])
+     *
+     * @param m mask to use
+     */
+    inline Mask512 operator&(const Mask512& m) const {
+        return static_cast<__mmask16>(val & m.val);
+    }
+
+    /**
+     * @brief Performs OR (r[i] = this[i] | m[i])
+     *
+     * @param m mask to use
+     */
+    inline Mask512 operator|(const Mask512& m) const {
+        return static_cast<__mmask16>(val | m.val);
+    }
+
+    /**
+     * @brief Performs XOR (r[i] = this[i] ^ m[i])
+     *
+     * @param m mask to use
+     */
+    inline Mask512 operator^(const Mask512& m) const {
+        return static_cast<__mmask16>(val ^ m.val);
+    }
+};
+
+/**
+ * @brief 512 bit vector of int32
+ */
+template <>
+class Vect<int32_t, 16> {
+  private:
+    __m512i val;
+
+  public:
+    /// Type of each lane
+    typedef int32_t value_type;
+
+    /// Number of lanes in the vector
+    enum { lanes = 16 };
+
+    /**
+     * @brief Empty vector
+     */
+    inline Vect() {}
+
+    /**
+     * @brief Fill vector with i
+     *
+     * @param i value to set every entry to
+     */
+    inline explicit Vect(int32_t i) {
+        val = _mm512_set1_epi32(i);
+    }
+
+    /**
+     * @brief Convert native __m512i to abstract Vect512i
+     *
+     * @param v vector to use
+     */
+    inline Vect(__m512i v) : val(v) {}  // NOLINT(runtime/explicit)
+
+    /**
+     * @brief Fill vector with values
+     *
+     * @param i0, ..., i15 values to use
+     */
+    inline Vect(int32_t i0, int32_t i1, int32_t i2, int32_t i3,
+                int32_t i4, int32_t i5, int32_t i6, int32_t i7,
+                int32_t i8, int32_t i9, int32_t i10, int32_t i11,
+                int32_t i12, int32_t i13, int32_t i14, int32_t i15) {
+        val = _mm512_setr_epi32(i0, i1, i2, i3, i4, i5, i6, i7,
+                                i8, i9, i10, i11, i12, i13, i14, i15);
+    }
+
+    /**
+     * @brief Access value directly
+     *
+     * Be aware that this method does not do bounds checking, and that it is
+     * probably the most inefficient way to do anything - only use for
+     * debugging
+     *
+     * @param idx index in vector
+     */
+    inline int32_t operator[](unsigned int idx) const {
+        int32_t array[16];
+        storeu(array);
+        return array[idx];
+    }
+
+    /**
+     * @brief Loads vector values from an arbitrary point
+     *
+     * It is preferable to use an aligned pointer, as it can use the aligned
+     * load operator, which performs operations much faster in most CPUs
+     *
+     * @param p loads 512 bits starting at p
+     */
+    static inline Vect512i loadu(const int32_t* p) {
+        return _mm512_loadu_si512(p);
+    }
+
+    /**
+     * @brief Loads vector values from an aligned pointer in memory
+     *
+     * This operation is preferable because the compiler can guarantee an
+     * aligned load operation, which is faster on most CPUs
+     *
+     * @param p loads 512 bits starting at p (must be aligned to 64 bytes)
+     */
+    static inline Vect512i load(const int32_t* p) {
+        return _mm512_load_si512(p);
+    }
+
+    /**
+     * @brief Loads the first n values from p, the other lanes are 0
+     *
+     * Nothing past p + n is read, so this is safe at the end of an array
+     *
+     * @param p values to load, no alignment needed
+     * @param n amount of values, 0 to 16
+     */
+    static inline Vect512i load_partial(const int32_t* p, int n) {
+        return _mm512_maskz_loadu_epi32(detail::firstMask(n), p);
+    }
+
+    /**
+     * @brief Inserts the vector in a point in memory
+     *
+     * It is preferable to use an aligned pointer, as it can use the aligned
+     * store operator, which performs operations much faster in most CPUs
+     *
+     * @param p stores 512 bits starting at p
+     */
+    inline void storeu(int32_t* p) const {
+        _mm512_storeu_si512(p, val);
+    }
+
+    /**
+     * @brief Inserts this vector in a aligned point in memory
+     *
+     * This operation is preferable because the compiler can guarantee an
+     * aligned store operation, which is faster on most CPUs
+     *
+     * @param p stores 512 bits starting at p (must be aligned to 64 bytes)
+     */
+    inline void store(int32_t* p) const {
+        _mm512_store_si512(p, val);
+    }
+
+    /**
+     * @brief Inserts this vector in a aligned point in memory, bypassing
+     * the cache
+     *
+     * A non-temporal store, for results that won't be read again soon
+     * (ie. arrays larger than the last level cache). Call streamFence()
+     * before other threads read the data
+     *
+     * @param p stores 512 bits starting at p
+     */
+    inline void stream(int32_t* p) const {
+        _mm512_stream_si512(reinterpret_cast<__m512i*>(p), val);
+    }
+
+    /**
+     * @brief Stores the first n values to p
+     *
+     * Nothing past p + n is written, so this is safe at the end of an array
+     *
+     * @param p where to store, no alignment needed
+     * @param n amount of values, 0 to 16
+     */
+    inline void store_partial(int32_t* p, int n) const {
+        _mm512_mask_storeu_epi32(p, detail::firstMask(n), val);
+    }
+
+    /**
+     * @brief Sets vector values to native __m512i
+     *
+     * @param v vector to use
+     */
+    inline void operator=(__m512i v) {
+        val = v;
+    }
+
+    /**
+     * @brief Converts to a native __m512i
+     */
+    inline operator __m512i() const {
+        return val;
+    }
+
+    /**
+     * @brief Converts to a floating point representation
+     */
+    inline operator Vect512f() const;
+
+    /**
+     * @brief Performs NOT (r[i] = ~this[i])
+     */
+    inline Vect512i operator~() const {
+        return operator^(Vect512i(0xFFFFFFFF));
+    }
+
+    /**
+     * @brief Adds vectors together (r[i] = this[i] + v[i])
+     *
+     * @param v vector to add
+     */
+    inline Vect512i operator+(const Vect512i& v) const {
+        return _mm512_add_epi32(val, v);
+    }
+
+    /**
+     * @brief Subtracts vector (r[i] = this[i] - v[i])
+     *
+     * @param v vector to subtract
+     */
+    inline Vect512i operator-(const Vect512i& v) const {
+        return _mm512_sub_epi32(val, v);
+    }
+
+    /**
+     * @brief Multiplies vectors together (r[i] = this[i] * v[i])
+     *
+     * @param v vector to multiply
+     */
+    inline Vect512i operator*(const Vect512i& v) const {
+        return _mm512_mullo_epi32(val, v);
+    }
+
+    /**
+     * @brief Performs AND comparison (r[i] = this[i] & v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect512i operator&(const Vect512i& v) const {
+        return _mm512_and_si512(val, v);
+    }
+
+    /**
+     * @brief Performs OR comparison (r[i] = this[i] | v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect512i operator|(const Vect512i& v) const {
+        return _mm512_or_si512(val, v);
+    }
+
+    /**
+     * @brief Performs XOR comparison (r[i] = this[i] ^ v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect512i operator^(const Vect512i& v) const {
+        return _mm512_xor_si512(val, v);
+    }
+
+    /**
+     * @brief Performs less-than comparison (r[i] = this[i] < v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Mask512 operator<(const Vect512i& v) const {
+        return _mm512_cmplt_epi32_mask(val, v);
+    }
+
+    /**
+     * @brief Performs less-than-or-equal-to comparison (r[i] = this[i] <= v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Mask512 operator<=(const Vect512i& v) const {
+        return _mm512_cmple_epi32_mask(val, v);
+    }
+
+    /**
+     * @brief Performs larger-than comparison (r[i] = this[i] > v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Mask512 operator>(const Vect512i& v) const {
+        return _mm512_cmpgt_epi32_mask(val, v);
+    }
+
+    /**
+     * @brief Performs greater-than-or-equal-to comparison
+     * (r[i] = this[i] >= v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Mask512 operator>=(const Vect512i& v) const {
+        return _mm512_cmpge_epi32_mask(val, v);
+    }
+
+    /**
+     * @brief Performs equal-to comparison (r[i] = this[i] == v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Mask512 operator==(const Vect512i& v) const {
+        return _mm512_cmpeq_epi32_mask(val, v);
+    }
+
+    /**
+     * @brief Performs not-equal-to comparison (r[i] = this[i] != v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Mask512 operator!=(const Vect512i& v) const {
+        return _mm512_cmpneq_epi32_mask(val, v);
+    }
+
+    /**
+     * @brief Add vector (this[i] = this[i] + v[i])
+     *
+     * @param v vector to add
+     */
+    inline void operator+=(const Vect512i& v) {
+        val = operator+(v);
+    }
+
+    /**
+     * @brief Subtracts vector (this[i] = this[i] - v[i])
+     *
+     * @param v vector to subtract
+     */
+    inline void operator-=(const Vect512i& v) {
+        val = operator-(v);
+    }
+
+    /**
+     * @brief Multiples vector (this[i] = this[i] * v[i])
+     *
+     * @param v vector to multiply
+     */
+    inline void operator*=(const Vect512i& v) {
+        val = operator*(v);
+    }
+
+    /**
+     * @brief AND operation with vector (this[i] = this[i] & v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator&=(const Vect512i& v) {
+        val = operator&(v);
+    }
+
+    /**
+     * @brief OR operation with vector (this[i] = this[i] | v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator|=(const Vect512i& v) {
+        val = operator|(v);
+    }
+
+    /**
+     * @brief XOR operation with vector (this[i] = this[i] ^ v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator^=(const Vect512i& v) {
+        val = operator^(v);
+    }
+};
+
+/**
+ * @brief 512 bit vector of float32
+ */
+template <>
+class Vect<float, 16> {
+  private:
+    __m512 val;
+
+  public:
+    /// Type of each lane
+    typedef float value_type;
+
+    /// Number of lanes in the vector
+    enum { lanes = 16 };
+
+    /**
+     * @brief Empty vector
+     */
+    inline Vect() {}
+
+    /**
+     * @brief Fill vector with i
+     *
+     * @param i value to set every entry to
+     */
+    inline explicit Vect(float i) {
+        val = _mm512_set1_ps(i);
+    }
+
+    /**
+     * @brief Convert native __m512 to abstract Vect512f
+     *
+     * @param v vector to use
+     */
+    inline Vect(__m512 v) : val(v) {}  // NOLINT(runtime/explicit)
+
+    /**
+     * @brief Fill vector with values
+     *
+     * @param i0, ..., i15 values to use
+     */
+    inline Vect(float i0, float i1, float i2, float i3,
+                float i4, float i5, float i6, float i7,
+                float i8, float i9, float i10, float i11,
+                float i12, float i13, float i14, float i15) {
+        val = _mm512_setr_ps(i0, i1, i2, i3, i4, i5, i6, i7,
+                             i8, i9, i10, i11, i12, i13, i14, i15);
+    }
+
+    /**
+     * @brief Access value directly
+     *
+     * Be aware that this method does not do bounds checking, and that it is
+     * probably the most inefficient way to do anything - only use for
+     * debugging
+     *
+     * @param idx index in vector
+     */
+    inline float operator[](unsigned int idx) const {
+        float array[16];
+        storeu(array);
+        return array[idx];
+    }
+
+    /**
+     * @brief Loads vector values from an arbitrary point
+     *
+     * It is preferable to use an aligned pointer, as it can use the aligned
+     * load operator, which performs operations much faster in most CPUs
+     *
+     * @param p loads 512 bits starting at p
+     */
+    static inline Vect512f loadu(const float* p) {
+        return _mm512_loadu_ps(p);
+    }
+
+    /**
+     * @brief Loads vector values from an aligned pointer in memory
+     *
+     * This operation is preferable because the compiler can guarantee an
+     * aligned load operation, which is faster on most CPUs
+     *
+     * @param p loads 512 bits starting at p (must be aligned to 64 bytes)
+     */
+    static inline Vect512f load(const float* p) {
+        return _mm512_load_ps(p);
+    }
+
+    /**
+     * @brief Loads the first n values from p, the other lanes are 0
+     *
+     * Nothing past p + n is read, so this is safe at the end of an array
+     *
+     * @param p values to load, no alignment needed
+     * @param n amount of values, 0 to 16
+     */
+    static inline Vect512f load_partial(const float* p, int n) {
+        return _mm512_maskz_loadu_ps(detail::firstMask(n), p);
+    }
+
+    /**
+     * @brief Inserts the vector in a point in memory
+     *
+     * It is preferable to use an aligned pointer, as it can use the aligned
+     * store operator, which performs operations much faster in most CPUs
+     *
+     * @param p stores 512 bits starting at p
+     */
+    inline void storeu(float* p) const {
+        _mm512_storeu_ps(p, val);
+    }
+
+    /**
+     * @brief Inserts this vector in a aligned point in memory
+     *
+     * This operation is preferable because the compiler can guarantee an
+     * aligned store operation, which is faster on most CPUs
+     *
+     * @param p stores 512 bits starting at p (must be aligned to 64 bytes)
+     */
+    inline void store(float* p) const {
+        _mm512_store_ps(p, val);
+    }
+
+    /**
+     * @brief Inserts this vector in a aligned point in memory, bypassing
+     * the cache
+     *
+     * A non-temporal store, for results that won't be read again soon
+     * (ie. arrays larger than the last level cache). Call streamFence()
+     * before other threads read the data
+     *
+     * @param p stores 512 bits starting at p
+     */
+    inline void stream(float* p) const {
+        _mm512_stream_ps(p, val);
+    }
+
+    /**
+     * @brief Stores the first n values to p
+     *
+     * Nothing past p + n is written, so this is safe at the end of an array
+     *
+     * @param p where to store, no alignment needed
+     * @param n amount of values, 0 to 16
+     */
+    inline void store_partial(float* p, int n) const {
+        _mm512_mask_storeu_ps(p, detail::firstMask(n), val);
+    }
+
+    /**
+     * @brief Sets vector values to native __m512
+     *
+     * @param v vector to use
+     */
+    inline void operator=(__m512 v) {
+        val = v;
+    }
+
+    /**
+     * @brief Converts to a native __m512
+     */
+    inline operator __m512() const {
+        return val;
+    }
+
+    /**
+     * @brief Converts to a integer representation (truncating towards zero,
+     * INT32_MIN when out of range)
+     */
+    inline Vect512i to_int() const;
+
+    /**
+     * @brief Performs NOT (r[i] = ~this[i])
+     */
+    inline Vect512f operator~() const {
+        return _mm512_castsi512_ps(
+                   ~Vect512i(_mm512_castps_si512(val)));
+    }
+
+    /**
+     * @brief Adds vectors together (r[i] = this[i] + v[i])
+     *
+     * @param v vector to add
+     */
+    inline Vect512f operator+(const Vect512f& v) const {
+        return _mm512_add_ps(val, v);
+    }
+
+    /**
+     * @brief Subtracts vector (r[i] = this[i] - v[i])
+     *
+     * @param v vector to subtract
+     */
+    inline Vect512f operator-(const Vect512f& v) const {
+        return _mm512_sub_ps(val, v);
+    }
+
+    /**
+     * @brief Multiplies vectors together (r[i] = this[i] * v[i])
+     *
+     * @param v vector to multiply
+     */
+    inline Vect512f operator*(const Vect512f& v) const {
+        return _mm512_mul_ps(val, v);
+    }
+
+    /**
+     * @brief Divides vectors (r[i] = this[i] / v[i])
+     *
+     * @param v vector to divide by
+     */
+    inline Vect512f operator/(const Vect512f& v) const {
+        return _mm512_div_ps(val, v);
+    }
+
+    /**
+     * @brief Performs AND comparison (r[i] = this[i] & v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect512f operator&(const Vect512f& v) const {
+        return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(val),
+                                                    _mm512_castps_si512(v)));
+    }
+
+    /**
+     * @brief Performs OR comparison (r[i] = this[i] | v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect512f operator|(const Vect512f& v) const {
+        return _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(val),
+                                                   _mm512_castps_si512(v)));
+    }
+
+    /**
+     * @brief Performs XOR comparison (r[i] = this[i] ^ v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect512f operator^(const Vect512f& v) const {
+        return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(val),
+                                                    _mm512_castps_si512(v)));
+    }
+
+    /**
+     * @brief Performs less-than comparison (r[i] = this[i] < v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Mask512 operator<(const Vect512f& v) const {
+        return _mm512_cmp_ps_mask(val, v, _CMP_LT_OS);
+    }
+
+    /**
+     * @brief Performs less-than-or-equal-to comparison (r[i] = this[i] <= v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Mask512 operator<=(const Vect512f& v) const {
+        return _mm512_cmp_ps_mask(val, v, _CMP_NGT_US);
+    }
+
+    /**
+     * @brief Performs larger-than comparison (r[i] = this[i] > v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Mask512 operator>(const Vect512f& v) const {
+        return _mm512_cmp_ps_mask(val, v, _CMP_GT_OS);
+    }
+
+    /**
+     * @brief Performs greater-than-or-equal-to comparison
+     * (r[i] = this[i] >= v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Mask512 operator>=(const Vect512f& v) const {
+        return _mm512_cmp_ps_mask(val, v, _CMP_NLT_US);
+    }
+
+    /**
+     * @brief Performs equal-to comparison (r[i] = this[i] == v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Mask512 operator==(const Vect512f& v) const {
+        return _mm512_cmp_ps_mask(val, v, _CMP_EQ_OQ);
+    }
+
+    /**
+     * @brief Performs not-equal-to comparison (r[i] = this[i] != v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Mask512 operator!=(const Vect512f& v) const {
+        return _mm512_cmp_ps_mask(val, v, _CMP_NEQ_UQ);
+    }
+
+    /**
+     * @brief Add vector (this[i] = this[i] + v[i])
+     *
+     * @param v vector to add
+     */
+    inline void operator+=(const Vect512f& v) {
+        val = operator+(v);
+    }
+
+    /**
+     * @brief Subtracts vector (this[i] = this[i] - v[i])
+     *
+     * @param v vector to subtract
+     */
+    inline void operator-=(const Vect512f& v) {
+        val = operator-(v);
+    }
+
+    /**
+     * @brief Multiples vector (this[i] = this[i] * v[i])
+     *
+     * @param v vector to multiply
+     */
+    inline void operator*=(const Vect512f& v) {
+        val = operator*(v);
+    }
+
+    /**
+     * @brief AND operation with vector (this[i] = this[i] & v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator&=(const Vect512f& v) {
+        val = operator&(v);
+    }
+
+    /**
+     * @brief OR operation with vector (this[i] = this[i] | v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator|=(const Vect512f& v) {
+        val = operator|(v);
+    }
+
+    /**
+     * @brief XOR operation with vector (this[i] = this[i] ^ v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator^=(const Vect512f& v) {
+        val = operator^(v);
+    }
+};
+
+Vect512i::operator Vect512f() const {
+    return _mm512_cvtepi32_ps(val);
+}
+
+Vect512i Vect512f::to_int() const {
+    return _mm512_cvttps_epi32(val);
+}
+
+/**
+ * @brief Reinterprets the bits of a float vector as int32
+ *
+ * Unlike to_int() nothing is converted, ie. 1.0f gives 0x3F800000
+ *
+ * @param v vector to reinterpret
+ */
+inline Vect512i as_int(const Vect512f& v) {
+    return _mm512_castps_si512(v);
+}
+
+/**
+ * @brief Reinterprets the bits of an int32 vector as float
+ *
+ * Unlike the Vect512i to Vect512f conversion nothing is converted, ie.
+ * 0x3F800000 gives 1.0f
+ *
+ * @param v vector to reinterpret
+ */
+inline Vect512f as_float(const Vect512i& v) {
+    return _mm512_castsi512_ps(v);
+}
+
+/**
+ * @brief Picks values from two vectors using a mask (r[i] = m[i] ? a[i] : b[i])
+ *
+ * @param m lanes to take from a
+ * @param a values used where m is set
+ * @param b values used where m is not set
+ */
+inline Vect512i select(const Mask512& m, const Vect512i& a, const Vect512i& b) {
+    return _mm512_mask_blend_epi32(m, b, a);
+}
+
+/**
+ * @brief Picks values from two vectors using a mask (r[i] = m[i] ? a[i] : b[i])
+ *
+ * @param m lanes to take from a
+ * @param a values used where m is set
+ * @param b values used where m is not set
+ */
+inline Vect512f select(const Mask512& m, const Vect512f& a, const Vect512f& b) {
+    return _mm512_mask_blend_ps(m, b, a);
+}
+
+/**
+ * @brief Masked add (r[i] = m[i] ? a[i] + b[i] : src[i])
+ *
+ * @param src values kept where m is not set
+ * @param m lanes to compute
+ * @param a, b vectors to add
+ */
+inline Vect512i mask_add(const Vect512i& src, const Mask512& m,
+                         const Vect512i& a, const Vect512i& b) {
+    return _mm512_mask_add_epi32(src, m, a, b);
+}
+
+/**
+ * @brief Masked subtract (r[i] = m[i] ? a[i] - b[i] : src[i])
+ *
+ * @param src values kept where m is not set
+ * @param m lanes to compute
+ * @param a, b vectors to subtract
+ */
+inline Vect512i mask_sub(const Vect512i& src, const Mask512& m,
+                         const Vect512i& a, const Vect512i& b) {
+    return _mm512_mask_sub_epi32(src, m, a, b);
+}
+
+/**
+ * @brief Masked multiply (r[i] = m[i] ? a[i] * b[i] : src[i])
+ *
+ * @param src values kept where m is not set
+ * @param m lanes to compute
+ * @param a, b vectors to multiply
+ */
+inline Vect512i mask_mul(const Vect512i& src, const Mask512& m,
+                         const Vect512i& a, const Vect512i& b) {
+    return _mm512_mask_mullo_epi32(src, m, a, b);
+}
+
+/**
+ * @brief Masked add (r[i] = m[i] ? a[i] + b[i] : src[i])
+ *
+ * @param src values kept where m is not set
+ * @param m lanes to compute
+ * @param a, b vectors to add
+ */
+inline Vect512f mask_add(const Vect512f& src, const Mask512& m,
+                         const Vect512f& a, const Vect512f& b) {
+    return _mm512_mask_add_ps(src, m, a, b);
+}
+
+/**
+ * @brief Masked subtract (r[i] = m[i] ? a[i] - b[i] : src[i])
+ *
+ * @param src values kept where m is not set
+ * @param m lanes to compute
+ * @param a, b vectors to subtract
+ */
+inline Vect512f mask_sub(const Vect512f& src, const Mask512& m,
+                         const Vect512f& a, const Vect512f& b) {
+    return _mm512_mask_sub_ps(src, m, a, b);
+}
+
+/**
+ * @brief Masked multiply (r[i] = m[i] ? a[i] * b[i] : src[i])
+ *
+ * @param src values kept where m is not set
+ * @param m lanes to compute
+ * @param a, b vectors to multiply
+ */
+inline Vect512f mask_mul(const Vect512f& src, const Mask512& m,
+                         const Vect512f& a, const Vect512f& b) {
+    return _mm512_mask_mul_ps(src, m, a, b);
+}
+
+/**
+ * @brief Masked divide (r[i] = m[i] ? a[i] / b[i] : src[i])
+ *
+ * Lanes that are not set are never divided, so they can't raise exceptions
+ *
+ * @param src values kept where m is not set
+ * @param m lanes to compute
+ * @param a, b vectors to divide
+ */
+inline Vect512f mask_div(const Vect512f& src, const Mask512& m,
+                         const Vect512f& a, const Vect512f& b) {
+    return _mm512_mask_div_ps(src, m, a, b);
+}
+
+/**
+ * @brief Zero-masked add (r[i] = m[i] ? a[i] + b[i] : 0)
+ *
+ * @param m lanes to compute
+ * @param a, b vectors to add
+ */
+inline Vect512i maskz_add(const Mask512& m,
+                          const Vect512i& a, const Vect512i& b) {
+    return _mm512_maskz_add_epi32(m, a, b);
+}
+
+/**
+ * @brief Zero-masked subtract (r[i] = m[i] ? a[i] - b[i] : 0)
+ *
+ * @param m lanes to compute
+ * @param a, b vectors to subtract
+ */
+inline Vect512i maskz_sub(const Mask512& m,
+                          const Vect512i& a, const Vect512i& b) {
+    return _mm512_maskz_sub_epi32(m, a, b);
+}
+
+/**
+ * @brief Zero-masked multiply (r[i] = m[i] ? a[i] * b[i] : 0)
+ *
+ * @param m lanes to compute
+ * @param a, b vectors to multiply
+ */
+inline Vect512i maskz_mul(const Mask512& m,
+                          const Vect512i& a, const Vect512i& b) {
+    return _mm512_maskz_mullo_epi32(m, a, b);
+}
+
+/**
+ * @brief Zero-masked add (r[i] = m[i] ? a[i] + b[i] : 0)
+ *
+ * @param m lanes to compute
+ * @param a, b vectors to add
+ */
+inline Vect512f maskz_add(const Mask512& m,
+                          const Vect512f& a, const Vect512f& b) {
+    return _mm512_maskz_add_ps(m, a, b);
+}
+
+/**
+ * @brief Zero-masked subtract (r[i] = m[i] ? a[i] - b[i] : 0)
+ *
+ * @param m lanes to compute
+ * @param a, b vectors to subtract
+ */
+inline Vect512f maskz_sub(const Mask512& m,
+                          const Vect512f& a, const Vect512f& b) {
+    return _mm512_maskz_sub_ps(m, a, b);
+}
+
+/**
+ * @brief Zero-masked multiply (r[i] = m[i] ? a[i] * b[i] : 0)
+ *
+ * @param m lanes to compute
+ * @param a, b vectors to multiply
+ */
+inline Vect512f maskz_mul(const Mask512& m,
+                          const Vect512f& a, const Vect512f& b) {
+    return _mm512_maskz_mul_ps(m, a, b);
+}
+
+/**
+ * @brief Zero-masked divide (r[i] = m[i] ? a[i] / b[i] : 0)
+ *
+ * @param m lanes to compute
+ * @param a, b vectors to divide
+ */
+inline Vect512f maskz_div(const Mask512& m,
+                          const Vect512f& a, const Vect512f& b) {
+    return _mm512_maskz_div_ps(m, a, b);
+}
+
+/**
+ * @brief Returns lowest of each value
+ *
+ * @param v first vector
+ * @param v2 second vector
+ * @return minimum of v[i] and v2[i]
+ */
+inline Vect512i lowest(const Vect512i& v, const Vect512i& v2) {
+    return _mm512_min_epi32(v, v2);
+}
+
+/**
+ * @brief Returns lowest of each value
+ *
+ * @param v first vector
+ * @param v2 second vector
+ * @return minimum of v[i] and v2[i]
+ */
+inline Vect512f lowest(const Vect512f& v, const Vect512f& v2) {
+    return _mm512_min_ps(v, v2);
+}
+
+/**
+ * @brief Returns highest of each value
+ *
+ * @param v first vector
+ * @param v2 second vector
+ * @return maximum of v[i] and v2[i]
+ */
+inline Vect512i highest(const Vect512i& v, const Vect512i& v2) {
+    return _mm512_max_epi32(v, v2);
+}
+
+/**
+ * @brief Returns highest of each value
+ *
+ * @param v first vector
+ * @param v2 second vector
+ * @return maximum of v[i] and v2[i]
+ */
+inline Vect512f highest(const Vect512f& v, const Vect512f& v2) {
+    return _mm512_max_ps(v, v2);
+}
+
+/**
+ * @brief Rounds each value the closest integer, ties to even
+ *
+ * @param v vector of values to round
+ */
+inline Vect512f round_nearest(const Vect512f& v) {
+    return _mm512_roundscale_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+
+/**
+ * @brief Rounds each value towards zero (like std::trunc)
+ *
+ * @param v vector of values to round
+ */
+inline Vect512f trunc(const Vect512f& v) {
+    return _mm512_roundscale_ps(v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+}
+
+/**
+ * @brief Rounds each value down (like std::floor)
+ *
+ * @param v vector of values to round
+ */
+inline Vect512f floor(const Vect512f& v) {
+    return _mm512_roundscale_ps(v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+}
+
+/**
+ * @brief Rounds each value up (like std::ceil)
+ *
+ * @param v vector of values to round
+ */
+inline Vect512f ceil(const Vect512f& v) {
+    return _mm512_roundscale_ps(v, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC);
+}
+
+/**
+ * @brief Converts to int32 with the current rounding mode
+ *
+ * Ties go to even in the default mode, see the Vect128f version
+ *
+ * @param v vector of values to convert
+ */
+inline Vect512i to_int_nearest(const Vect512f& v) {
+    return _mm512_cvtps_epi32(v);
+}
+
+/**
+ * @brief The reciprocal square root of values in a vector
+ *
+ * @param v starting values
+ * @return 1 / sqrt(v[i])
+ */
+inline Vect512f rsqrt(const Vect512f& v) {
+    return _mm512_rsqrt14_ps(v);
+}
+
+/**
+ * @brief The reciprocal of values in a vector
+ *
+ * @param v starting values
+ * @return 1 / v[i]
+ */
+inline Vect512f reciprocal(const Vect512f& v) {
+    return _mm512_rcp14_ps(v);
+}
+
+/**
+ * @brief The square root of values in a vector
+ *
+ * This method isn't guaranteed to be accurate, see sqrt_precise()
+ *
+ * @param v starting values
+ * @return the square root of v[i]
+ */
+inline Vect512f sqrt(const Vect512f& v) {
+    return reciprocal(rsqrt(v));
+}
+
+/**
+ * @brief Fused multiply-add (r[i] = a[i] * b[i] + c[i])
+ *
+ * @param a, b values to multiply
+ * @param c value to add (or subtract)
+ */
+inline Vect512f fma(const Vect512f& a, const Vect512f& b,
+                    const Vect512f& c) {
+    return _mm512_fmadd_ps(a, b, c);
+}
+
+/**
+ * @brief Fused multiply-subtract (r[i] = a[i] * b[i] - c[i])
+ *
+ * @param a, b values to multiply
+ * @param c value to add (or subtract)
+ */
+inline Vect512f fms(const Vect512f& a, const Vect512f& b,
+                    const Vect512f& c) {
+    return _mm512_fmsub_ps(a, b, c);
+}
+
+/**
+ * @brief Fused negated multiply-add (r[i] = c[i] - a[i] * b[i])
+ *
+ * @param a, b values to multiply
+ * @param c value to add (or subtract)
+ */
+inline Vect512f fnma(const Vect512f& a, const Vect512f& b,
+                     const Vect512f& c) {
+    return _mm512_fnmadd_ps(a, b, c);
+}
+
+/**
+ * @brief The square root of values in a vector, correctly rounded
+ *
+ * Uses the native square root instruction, which is slower than sqrt()
+ *
+ * @param v starting values
+ * @return the square root of v[i]
+ */
+inline Vect512f sqrt_precise(const Vect512f& v) {
+    return _mm512_sqrt_ps(v);
+}
+
+/**
+ * @brief The reciprocal square root of values in a vector, correctly rounded
+ *
+ * Uses the native square root and divide instructions
+ *
+ * @param v starting values
+ * @return 1 / sqrt(v[i])
+ */
+inline Vect512f rsqrt_precise(const Vect512f& v) {
+    return Vect512f(1) / sqrt_precise(v);
+}
+
+/**
+ * @brief The reciprocal of values in a vector, correctly rounded
+ *
+ * Uses the native divide instruction
+ *
+ * @param v starting values
+ * @return 1 / v[i]
+ */
+inline Vect512f reciprocal_precise(const Vect512f& v) {
+    return Vect512f(1) / v;
+}
+
+/**
+ * @brief The reciprocal square root of values in a vector, refined once
+ *
+ * One Newton-Raphson step on top of rsqrt(), which gets close to full float
+ * precision for much less than a square root and divide. 0 and infinity
+ * give NaN, use rsqrt_precise() if those can happen
+ *
+ * @param v starting values
+ * @return 1 / sqrt(v[i])
+ */
+inline Vect512f rsqrt_refined(const Vect512f& v) {
+    Vect512f y = rsqrt(v);
+    Vect512f half_y = Vect512f(0.5) * y;
+    return half_y * fnma(v * y, y, Vect512f(3));
+}
+
+/**
+ * @brief The reciprocal of values in a vector, refined once
+ *
+ * One Newton-Raphson step on top of reciprocal(), which gets close to full
+ * float precision for much less than a divide. 0 and infinity give NaN, use
+ * reciprocal_precise() if those can happen
+ *
+ * @param v starting values
+ * @return 1 / v[i]
+ */
+inline Vect512f reciprocal_refined(const Vect512f& v) {
+    Vect512f y = reciprocal(v);
+    return fma(y, fnma(v, y, Vect512f(1)), y);
+}
+
+/**
+ * @brief Reads one value of a vector without going through memory
+ *
+ * @param I index in vector (0 - 15)
+ * @param v vector to read from
+ * @return v[I]
+ */
+template <int I>
+inline int32_t extract(const Vect512i& v) {
+    static_assert(I >= 0 && I < 16, "index outside of vector");
+    return extract<I % 4>(Vect128i(_mm512_extracti32x4_epi32(v, I / 4)));
+}
+
+/**
+ * @brief Reads one value of a vector without going through memory
+ *
+ * @param I index in vector (0 - 15)
+ * @param v vector to read from
+ * @return v[I]
+ */
+template <int I>
+inline float extract(const Vect512f& v) {
+    static_assert(I >= 0 && I < 16, "index outside of vector");
+    return extract<I % 4>(Vect128f(_mm512_extractf32x4_ps(v, I / 4)));
+}
+
+/**
+ * @brief Adds every value of a vector together
+ *
+ * @param v values to add
+ * @return v[0] + v[1] + ... + v[15]
+ */
+inline int32_t hsum(const Vect512i& v) {
+    return _mm512_reduce_add_epi32(v);
+}
+
+/**
+ * @brief Adds every value of a vector together
+ *
+ * @param v values to add
+ * @return v[0] + v[1] + ... + v[15]
+ */
+inline float hsum(const Vect512f& v) {
+    return _mm512_reduce_add_ps(v);
+}
+
+/**
+ * @brief Lowest value of a vector
+ *
+ * @param v values to compare
+ * @return minimum of v[0], v[1], ..., v[15]
+ */
+inline int32_t hmin(const Vect512i& v) {
+    return _mm512_reduce_min_epi32(v);
+}
+
+/**
+ * @brief Lowest value of a vector
+ *
+ * @param v values to compare
+ * @return minimum of v[0], v[1], ..., v[15]
+ */
+inline float hmin(const Vect512f& v) {
+    return _mm512_reduce_min_ps(v);
+}
+
+/**
+ * @brief Highest value of a vector
+ *
+ * @param v values to compare
+ * @return maximum of v[0], v[1], ..., v[15]
+ */
+inline int32_t hmax(const Vect512i& v) {
+    return _mm512_reduce_max_epi32(v);
+}
+
+/**
+ * @brief Highest value of a vector
+ *
+ * @param v values to compare
+ * @return maximum of v[0], v[1], ..., v[15]
+ */
+inline float hmax(const Vect512f& v) {
+    return _mm512_reduce_max_ps(v);
+}
+
+/**
+ * @brief Dot product of two vectors
+ *
+ * @param v first vector
+ * @param v2 second vector
+ * @return v[0] * v2[0] + v[1] * v2[1] + ... + v[15] * v2[15]
+ */
+inline float dot(const Vect512f& v, const Vect512f& v2) {
+    return hsum(v * v2);
+}
+
+/**
+ * @brief Bits of a mask, lane i is bit i (like _mm_movemask_ps)
+ *
+ * @param m mask, ie. the result of a comparison
+ */
+inline uint32_t movemask(const Mask512& m) {
+    return m.bits();
+}
+
+/**
+ * @brief Checks if any lane of a mask is set
+ *
+ * @param m mask, ie. the result of a comparison
+ */
+inline bool any(const Mask512& m) {
+    return m.bits() != 0;
+}
+
+/**
+ * @brief Checks if every lane of a mask is set
+ *
+ * @param m mask, ie. the result of a comparison
+ */
+inline bool all(const Mask512& m) {
+    return m.bits() == 0xFFFF;
+}
+
+/**
+ * @brief Checks if no lane of a mask is set
+ *
+ * @param m mask, ie. the result of a comparison
+ */
+inline bool none(const Mask512& m) {
+    return m.bits() == 0;
+}
+
+/**
+ * @brief Shifts each value left by N bits (r[i] = v[i] << N)
+ *
+ * @param N amount of bits, 32 or more gives 0
+ * @param v vector to shift
+ */
+template <int N>
+inline Vect512i shl(const Vect512i& v) {
+    static_assert(N >= 0, "negative shift");
+    return _mm512_slli_epi32(v, N);
+}
+
+/**
+ * @brief Shifts each value right by N bits, filling with zeros
+ *
+ * @param N amount of bits, 32 or more gives 0
+ * @param v vector to shift
+ */
+template <int N>
+inline Vect512i shr(const Vect512i& v) {
+    static_assert(N >= 0, "negative shift");
+    return _mm512_srli_epi32(v, N);
+}
+
+/**
+ * @brief Shifts each value right by N bits, filling with the sign bit
+ *
+ * @param N amount of bits, 32 or more fills every bit with the sign
+ * @param v vector to shift
+ */
+template <int N>
+inline Vect512i sar(const Vect512i& v) {
+    static_assert(N >= 0, "negative shift");
+    return _mm512_srai_epi32(v, N);
+}
+
+/**
+ * @brief Shifts each value left by the same runtime amount
+ *
+ * @param v vector to shift
+ * @param count amount of bits, 32 or more gives 0
+ */
+inline Vect512i shl(const Vect512i& v, int count) {
+    return _mm512_sll_epi32(v, _mm_cvtsi32_si128(count));
+}
+
+/**
+ * @brief Shifts each value right by the same runtime amount, filling with
+ * zeros
+ *
+ * @param v vector to shift
+ * @param count amount of bits, 32 or more gives 0
+ */
+inline Vect512i shr(const Vect512i& v, int count) {
+    return _mm512_srl_epi32(v, _mm_cvtsi32_si128(count));
+}
+
+/**
+ * @brief Shifts each value right by the same runtime amount, filling with
+ * the sign bit
+ *
+ * @param v vector to shift
+ * @param count amount of bits, 32 or more fills every bit with the sign
+ */
+inline Vect512i sar(const Vect512i& v, int count) {
+    return _mm512_sra_epi32(v, _mm_cvtsi32_si128(count));
+}
+
+/**
+ * @brief High 32 bits of each signed 64 bit product (a[i] * b[i] >> 32)
+ *
+ * @param a, b vectors to multiply
+ */
+inline Vect512i mulhi(const Vect512i& a, const Vect512i& b) {
+    __m512i even = _mm512_mul_epi32(a, b);
+    __m512i odd = _mm512_mul_epi32(_mm512_srli_epi64(a, 32),
+                                   _mm512_srli_epi64(b, 32));
+    // high halves of the even products go down, the odd ones stay
+    return _mm512_mask_mov_epi32(_mm512_srli_epi64(even, 32), 0xAAAA, odd);
+}
+
+/**
+ * @brief Loads base[idx[i]] into each lane
+ *
+ * @param base start of the table
+ * @param idx index of each value, counted in int32's from base
+ */
+inline Vect512i gather(const int32_t* base, const Vect512i& idx) {
+    return _mm512_i32gather_epi32(idx, base, 4);
+}
+
+/**
+ * @brief Loads base[idx[i]] into each lane
+ *
+ * @param base start of the table
+ * @param idx index of each value, counted in floats from base
+ */
+inline Vect512f gather(const float* base, const Vect512i& idx) {
+    return _mm512_i32gather_ps(idx, base, 4);
+}
+
+/**
+ * @brief Stores each lane to base[idx[i]]
+ *
+ * For repeated indices the highest lane wins
+ *
+ * @param base start of the table
+ * @param idx index of each value, counted in int32's from base
+ * @param v values to store
+ */
+inline void scatter(int32_t* base, const Vect512i& idx, const Vect512i& v) {
+    _mm512_i32scatter_epi32(base, idx, v, 4);
+}
+
+/**
+ * @brief Stores each lane to base[idx[i]]
+ *
+ * For repeated indices the highest lane wins
+ *
+ * @param base start of the table
+ * @param idx index of each value, counted in floats from base
+ * @param v values to store
+ */
+inline void scatter(float* base, const Vect512i& idx, const Vect512f& v) {
+    _mm512_i32scatter_ps(base, idx, v, 4);
+}
+
+}  // namespace sight
+
+SIGHT_AVX512_WARNINGS_END
+
+#endif  // HAVE_AVX512F
@@ -0,0 +1,308 @@
+#pragma once
+
+#include "simd.hpp"
+#include <stdexcept>
+
+/**
+ * Outputs of transform() and zip() of at least this many bytes are written
+ * with streaming stores, so they don't evict the inputs from the cache.
+ * Should be around the size of the last level cache
+ */
+#ifndef SIGHT_STREAM_THRESHOLD
+    #define SIGHT_STREAM_THRESHOLD (size_t(8) << 20)
+#endif
+
+namespace sight {
+namespace detail {
+
+/// Checks if an output of length T's should use streaming stores
+template <typename T>
+inline bool streams(size_t length) {
+    return length * sizeof(T) >= SIGHT_STREAM_THRESHOLD;
+}
+
+/**
+ * @brief Applies op to the last n (< V::lanes) values of src
+ *
+ * The values are loaded into a zero padded vector, so nothing outside of
+ * [src, src + n) is read and nothing outside of [dst, dst + n) is written
+ */
+template <typename V, typename T, typename Op>
+inline void tail(const T* src, T* dst, size_t n, Op& op) {
+    const int count = static_cast<int>(n);
+    op(V::load_partial(src, count)).store_partial(dst, count);
+}
+
+/**
+ * @brief Applies op to the last n (< V::lanes) values of a and b
+ */
+template <typename V, typename T, typename Op>
+inline void tail(const T* a, const T* b, T* dst, size_t n, Op& op) {
+    const int count = static_cast<int>(n);
+    op(V::load_partial(a, count), V::load_partial(b, count))
+        .store_partial(dst, count);
+}
+
+/// Checks if two ranges of length values share any memory
+template <typename T>
+inline bool overlaps(const T* a, const T* b, size_t length) {
+    return a < b + length && b < a + length;
+}
+
+/**
+ * @brief transform() of the values [s, s + length) into d
+ *
+ * @param stream if the output is large enough for streaming stores
+ */
+template <typename V, typename T, typename Op>
+inline void transformRange(const T* s, T* d, size_t length, bool stream,
+                           Op& op) {
+    size_t i = 0;
+    if (stream && isAligned<sizeof(V)>(d) && !overlaps<T>(s, d, length)) {
+        for (; room<V::lanes>(i, length); i += V::lanes) {
+            op(V::loadu(s + i)).stream(d + i);
+        }
+        streamFence();
+        SIGHT_COUNT(StreamedRun);
+    } else if (isAligned<sizeof(V)>(s) && isAligned<sizeof(V)>(d)) {
+        for (; room<V::lanes>(i, length); i += V::lanes) {
+            op(V::load(s + i)).store(d + i);
+        }
+        SIGHT_COUNT(AlignedRun);
+    } else {
+        for (; room<V::lanes>(i, length); i += V::lanes) {
+            op(V::loadu(s + i)).storeu(d + i);
+        }
+        SIGHT_COUNT(UnalignedRun);
+    }
+
+    if (i == length) {
+        return;
+    }
+    if (length >= V::lanes && !overlaps<T>(s, d, length)) {
+        i = length - V::lanes;
+        op(V::loadu(s + i)).storeu(d + i);
+        SIGHT_COUNT(OverlappedTail);
+    } else {
+        tail<V>(s + i, d + i, length - i, op);
+        SIGHT_COUNT(PartialTail);
+    }
+}
+
+/**
+ * @brief zip() of the values [a, a + length) and [b, b + length) into d
+ */
+template <typename V, typename T, typename Op>
+inline void zipRange(const T* pa, const T* pb, T* d, size_t length,
+                     bool stream, Op& op) {
+    size_t i = 0;
+    if (stream && isAligned<sizeof(V)>(d) && !overlaps<T>(pa, d, length)
+        && !overlaps<T>(pb, d, length)) {
+        for (; room<V::lanes>(i, length); i += V::lanes) {
+            op(V::loadu(pa + i), V::loadu(pb + i)).stream(d + i);
+        }
+        streamFence();
+        SIGHT_COUNT(StreamedRun);
+    } else if (isAligned<sizeof(V)>(pa) && isAligned<sizeof(V)>(pb)
+               && isAligned<sizeof(V)>(d)) {
+        for (; room<V::lanes>(i, length); i += V::lanes) {
+            op(V::load(pa + i), V::load(pb + i)).store(d + i);
+        }
+        SIGHT_COUNT(AlignedRun);
+    } else {
+        for (; room<V::lanes>(i, length); i += V::lanes) {
+            op(V::loadu(pa + i), V::loadu(pb + i)).storeu(d + i);
+        }
+        SIGHT_COUNT(UnalignedRun);
+    }
+
+    if (i == length) {
+        return;
+    }
+    if (length >= V::lanes && !overlaps<T>(pa, d, length)
+        && !overlaps<T>(pb, d, length)) {
+        i = length - V::lanes;
+        op(V::loadu(pa + i), V::loadu(pb + i)).storeu(d + i);
+        SIGHT_COUNT(OverlappedTail);
+    } else {
+        tail<V>(pa + i, pb + i, d + i, length - i, op);
+        SIGHT_COUNT(PartialTail);
+    }
+}
+
+/**
+ * @brief reduce() of the values [s, s + length), without an init
+ *
+ * For folding parts of an array that start on a vector boundary (ie. the
+ * chunks of parallelReduce()), so that they keep the aligned loads
+ *
+ * @param length amount of values, at least 1
+ */
+template <typename V, typename T, typename Op>
+inline T reduceRange(const T* s, size_t length, Op& op) {
+    if (length < V::lanes) {
+        SIGHT_COUNT(ScalarInput);
+        V result(s[0]);
+        for (size_t i = 1; i < length; i++) {
+            result = op(result, V(s[i]));
+        }
+        return result[0];
+    }
+
+    const size_t L = V::lanes;
+    V acc = V::loadu(s);
+    size_t i = L;
+    if (length >= 4 * L) {
+        // four chains, so op doesn't wait on its own latency
+        MultiAccumulator<V, 4> accs(acc);
+        for (int k = 1; k < 4; k++) {
+            accs[k] = V::loadu(s + k * L);
+        }
+        if (isAligned<sizeof(V)>(s)) {
+            i = unrolled<V, 4>(4 * L, length, [&](size_t j, int k) {
+                accs[k] = op(accs[k], V::load(s + j));
+            });
+            SIGHT_COUNT(AlignedRun);
+        } else {
+            i = unrolled<V, 4>(4 * L, length, [&](size_t j, int k) {
+                accs[k] = op(accs[k], V::loadu(s + j));
+            });
+            SIGHT_COUNT(UnalignedRun);
+        }
+        acc = accs.merge(op);
+    }
+    // fewer than four vectors
+    for (; i + L <= length; i += L) {
+        acc = op(acc, V::loadu(s + i));
+    }
+
+    alignas(V) T lanes[V::lanes];
+    acc.store(lanes);
+    if (i < length) {
+        // only the lanes covered by the remainder take part
+        const int count = static_cast<int>(length - i);
+        op(acc, V::load_partial(s + i, count)).store_partial(lanes, count);
+        SIGHT_COUNT(PartialTail);
+    }
+
+    V result(lanes[0]);
+    for (int l = 1; l < V::lanes; l++) {
+        result = op(result, V(lanes[l]));
+    }
+    return result[0];
+}
+
+/**
+ * @brief reduce() of the values [s, s + length) and init
+ */
+template <typename V, typename T, typename Op>
+inline T reduceRange(const T* s, size_t length, T init, Op& op) {
+    if (length == 0) {
+        return init;
+    }
+    return op(V(init), V(reduceRange<V>(s, length, op)))[0];
+}
+
+}  // namespace detail
+
+/**
+ * @brief Applies op to every vector of src (dst[i] = op(src[i]))
+ *
+ * op is only ever called with vectors, the remainder that doesn't fill a
+ * vector is handled by recomputing the last full vector (when src and dst
+ * don't overlap) or with a zero padded vector, so op doesn't need a scalar
+ * version. Outputs above SIGHT_STREAM_THRESHOLD bytes that don't overlap
+ * src are written with streaming stores
+ *
+ * @param V vector type to process with (the widest one for T by default)
+ * @param src values to transform
+ * @param dst where to store results, can be the same storage as src
+ * @param op functor taking and returning a V
+ */
+template <typename V, typename T, int Align, int Align2, typename Op>
+inline void transform(const AlignedStorage<T, Align>& src,
+                      AlignedStorage<T, Align2>& dst, Op op) {
+    if (dst.length() < src.length()) {
+        throw std::out_of_range("destination is smaller than source");
+    }
+
+    SIGHT_TIME(Transform, src.length());
+    detail::transformRange<V, T>(src, dst, src.length(),
+                                 detail::streams<T>(src.length()), op);
+}
+
+/**
+ * @brief Applies op to every vector of src using the widest vector for T
+ */
+template <typename T, int Align, int Align2, typename Op>
+inline void transform(const AlignedStorage<T, Align>& src,
+                      AlignedStorage<T, Align2>& dst, Op op) {
+    transform<typename detail::Widest<T>::type>(src, dst, op);
+}
+
+/**
+ * @brief Combines every vector of a and b (dst[i] = op(a[i], b[i]))
+ *
+ * The remainder and streaming are handled the same way as transform()
+ *
+ * @param V vector type to process with (the widest one for T by default)
+ * @param a, b values to combine, both need at least a.length() values
+ * @param dst where to store results, can be the same storage as a or b
+ * @param op functor taking two V and returning a V
+ */
+template <typename V, typename T, int Align, int Align2, int Align3,
+          typename Op>
+inline void zip(const AlignedStorage<T, Align>& a,
+                const AlignedStorage<T, Align2>& b,
+                AlignedStorage<T, Align3>& dst, Op op) {
+    if (b.length() < a.length()) {
+        throw std::out_of_range("second source is smaller than first source");
+    }
+    if (dst.length() < a.length()) {
+        throw std::out_of_range("destination is smaller than source");
+    }
+
+    SIGHT_TIME(Zip, a.length());
+    detail::zipRange<V, T>(a, b, dst, a.length(),
+                           detail::streams<T>(a.length()), op);
+}
+
+/**
+ * @brief Combines every vector of a and b using the widest vector for T
+ */
+template <typename T, int Align, int Align2, int Align3, typename Op>
+inline void zip(const AlignedStorage<T, Align>& a,
+                const AlignedStorage<T, Align2>& b,
+                AlignedStorage<T, Align3>& dst, Op op) {
+    zip<typename detail::Widest<T>::type>(a, b, dst, op);
+}
+
+/**
+ * @brief Folds every value of src into one (like std::reduce)
+ *
+ * Vectors are folded together lane by lane, then the lanes are folded and
+ * combined with init. Because of that op has to be associative and
+ * commutative, ie. addition, multiplication, lowest or highest. A remainder
+ * that doesn't fill a vector is only folded into the lanes it covers
+ *
+ * @param V vector type to process with (the widest one for T by default)
+ * @param src values to fold
+ * @param init starting value, used once
+ * @param op functor taking two V and returning a V
+ * @return init folded with every value of src
+ */
+template <typename V, typename T, int Align, typename Op>
+inline T reduce(const AlignedStorage<T, Align>& src, T init, Op op) {
+    SIGHT_TIME(Reduce, src.length());
+    return detail::reduceRange<V, T>(src, src.length(), init, op);
+}
+
+/**
+ * @brief Folds every value of src into one using the widest vector for T
+ */
+template <typename T, int Align, typename Op>
+inline T reduce(const AlignedStorage<T, Align>& src, T init, Op op) {
+    return reduce<typename detail::Widest<T>::type>(src, init, op);
+}
+
+}  // namespace sight
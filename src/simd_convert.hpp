@@ -0,0 +1,110 @@
+#pragma once
+
+#include "simd.hpp"
+#include <cstdint>
+
+/*
+ * Conversions between float and int32 vectors that to_int() and the
+ * implicit int to float conversion don't cover, for every width.
+ *
+ * to_int() truncates and gives INT32_MIN for anything that doesn't fit
+ * (the x86 "integer indefinite"), these round or saturate like the C
+ * library and C++ casts would for values in range. Unsigned lanes are kept
+ * in the int32 vectors bit for bit.
+ */
+
+namespace sight {
+
+/**
+ * @brief Rounds each value to the closest int32, halfway away from zero
+ *
+ * Like std::lround, ie. 2.5 gives 3 and -2.5 gives -3. The rounding is
+ * exact, 0.49999997f gives 0. Use to_int_nearest() when ties don't matter,
+ * it is a single instruction
+ *
+ * @param v vector of values to round, in the int32 range
+ * @return rounded values of v[i]
+ */
+template <int N>
+inline Vect<int32_t, N> round(const Vect<float, N>& v) {
+    typedef Vect<float, N> V;
+    const V sign(-0.0f);
+    V t = trunc(v);
+    // v - t is exact, so only real halves and above move away from zero
+    V away = select(highest(v - t, t - v) >= V(0.5f), V(1) | (v & sign),
+                    V(0.0f));
+    return (t + away).to_int();
+}
+
+/**
+ * @brief Converts to int32 towards zero, saturating (like a clamped cast)
+ *
+ * Values below INT32_MIN give INT32_MIN, values above INT32_MAX give
+ * INT32_MAX and NaN gives 0
+ *
+ * @param v vector of values to convert
+ */
+template <int N>
+inline Vect<int32_t, N> to_int_saturated(const Vect<float, N>& v) {
+    typedef Vect<float, N> V;
+    typedef Vect<int32_t, N> VI;
+    // too large values give INT32_MIN, which turns into INT32_MAX here
+    VI r = select(v >= V(2147483648.0f), VI(INT32_MAX), v.to_int());
+    return select(v == v, r, VI(0));
+}
+
+/**
+ * @brief Converts to uint32 towards zero, saturating
+ *
+ * Negative values and NaN give 0, values above UINT32_MAX give UINT32_MAX.
+ * The results are uint32 bits in int32 lanes
+ *
+ * @param v vector of values to convert
+ */
+template <int N>
+inline Vect<int32_t, N> to_uint_saturated(const Vect<float, N>& v) {
+    typedef Vect<float, N> V;
+    typedef Vect<int32_t, N> VI;
+    const V two31(2147483648.0f);
+    // highest() returns its second argument for NaN
+    V c = highest(v, V(0.0f));
+    // the upper half is shifted down into the int32 range and back
+    VI upper = (c - two31).to_int() ^ VI(INT32_MIN);
+    VI r = select(c < two31, c.to_int(), upper);
+    return select(c >= V(4294967296.0f), VI(-1), r);
+}
+
+/**
+ * @brief Converts uint32 lanes to the closest float
+ *
+ * The implicit conversion reads the lanes as int32, so 0xFFFFFFFF gives -1
+ * instead of 4294967296. Rounds like static_cast<float>(uint32_t)
+ *
+ * @param v uint32 bits in int32 lanes
+ */
+template <int N>
+inline Vect<float, N> to_float_unsigned(const Vect<int32_t, N>& v) {
+    typedef Vect<float, N> V;
+    typedef Vect<int32_t, N> VI;
+    // both halves and the scaled upper half are exact, the sum rounds once
+    V upper = shr<16>(v);
+    V lower = v & VI(0xFFFF);
+    return fma(upper, V(65536.0f), lower);
+}
+
+#ifdef HAVE_AVX512F
+SIGHT_AVX512_WARNINGS_BEGIN
+
+/**
+ * @brief Converts uint32 lanes to the closest float
+ *
+ * @param v uint32 bits in int32 lanes
+ */
+inline Vect512f to_float_unsigned(const Vect512i& v) {
+    return _mm512_cvtepu32_ps(v);
+}
+
+SIGHT_AVX512_WARNINGS_END
+#endif
+
+}  // namespace sight
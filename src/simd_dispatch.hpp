@@ -0,0 +1,311 @@
+#pragma once
+
+#include "simd.hpp"
+#include <cpuid.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/// Compiles a function for an instruction set regardless of compiler flags
+#define SIGHT_TARGET(isa) __attribute__((target(isa)))
+
+namespace sight {
+
+/**
+ * @brief Instruction set tiers that kernels are dispatched to
+ *
+ * Ordered, so every tier implies the ones before it
+ */
+enum class Isa : int {
+    SSE2,
+    SSE41,
+    AVX2,
+    AVX512F
+};
+
+/**
+ * @brief Name of an instruction set tier
+ *
+ * @param isa tier to name
+ * @return readable name, ie. "avx2"
+ */
+inline const char* isaName(Isa isa) {
+    switch (isa) {
+        case Isa::SSE2: return "sse2";
+        case Isa::SSE41: return "sse4.1";
+        case Isa::AVX2: return "avx2";
+        case Isa::AVX512F: return "avx512f";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Queries the CPU (and OS register support) for the best tier
+ *
+ * Prefer cpuIsa(), which only runs this once
+ *
+ * @return highest tier that can run on this machine
+ */
+inline Isa detectIsa() {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return Isa::SSE2;
+    }
+
+    bool sse41 = ecx & bit_SSE4_1;
+    bool osxsave = ecx & bit_OSXSAVE;
+    bool avx = ecx & bit_AVX;
+    if (!sse41) {
+        return Isa::SSE2;
+    }
+    if (!osxsave || !avx) {
+        return Isa::SSE41;
+    }
+
+    // the OS has to save the wider registers on context switches
+    unsigned int xcr0, xcr0_hi;
+    __asm__("xgetbv" : "=a"(xcr0), "=d"(xcr0_hi) : "c"(0));
+    if ((xcr0 & 0x6) != 0x6 || !__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)
+        || !(ebx & bit_AVX2)) {
+        return Isa::SSE41;
+    }
+    if ((xcr0 & 0xE6) != 0xE6 || !(ebx & bit_AVX512F)) {
+        return Isa::AVX2;
+    }
+    return Isa::AVX512F;
+}
+
+/**
+ * @brief Best tier of this machine, detected once on first use
+ */
+inline Isa cpuIsa() {
+    static const Isa isa = detectIsa();
+    return isa;
+}
+
+namespace detail {
+
+inline std::atomic<int>& isaState() {
+    static std::atomic<int> isa(static_cast<int>(cpuIsa()));
+    return isa;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Tier that dispatched kernels currently use
+ */
+inline Isa activeIsa() {
+    return static_cast<Isa>(detail::isaState().load(std::memory_order_relaxed));
+}
+
+/**
+ * @brief Restricts dispatch to tiers up to isa
+ *
+ * Useful for testing and comparing tiers. Tiers above cpuIsa() are never
+ * used, so limitIsa(Isa::AVX512F) restores the default
+ *
+ * @param isa highest tier to use
+ */
+inline void limitIsa(Isa isa) {
+    int best = static_cast<int>(cpuIsa());
+    int limit = static_cast<int>(isa);
+    detail::isaState().store(limit < best ? limit : best,
+                             std::memory_order_relaxed);
+}
+
+namespace detail {
+
+SIGHT_AVX512_WARNINGS_BEGIN
+
+/// Integer multiply, scalar part wraps like the vector instructions
+struct Multiply {
+    static inline int32_t scalar(int32_t a, int32_t b) {
+        return static_cast<int32_t>(static_cast<uint32_t>(a)
+                                    * static_cast<uint32_t>(b));
+    }
+    static inline Vect128i sse2(const Vect128i& a, const Vect128i& b) {
+        return a * b;
+    }
+    SIGHT_TARGET("sse4.1") static inline __m128i sse41(__m128i a, __m128i b) {
+        return _mm_mullo_epi32(a, b);
+    }
+    SIGHT_TARGET("avx2") static inline __m256i avx2(__m256i a, __m256i b) {
+        return _mm256_mullo_epi32(a, b);
+    }
+    SIGHT_TARGET("avx512f") static inline __m512i avx512f(__m512i a,
+                                                          __m512i b) {
+        return _mm512_mullo_epi32(a, b);
+    }
+};
+
+/// Integer minimum
+struct Lowest {
+    static inline int32_t scalar(int32_t a, int32_t b) {
+        return a < b ? a : b;
+    }
+    static inline Vect128i sse2(const Vect128i& a, const Vect128i& b) {
+        return lowest(a, b);
+    }
+    SIGHT_TARGET("sse4.1") static inline __m128i sse41(__m128i a, __m128i b) {
+        return _mm_min_epi32(a, b);
+    }
+    SIGHT_TARGET("avx2") static inline __m256i avx2(__m256i a, __m256i b) {
+        return _mm256_min_epi32(a, b);
+    }
+    SIGHT_TARGET("avx512f") static inline __m512i avx512f(__m512i a,
+                                                          __m512i b) {
+        return _mm512_min_epi32(a, b);
+    }
+};
+
+/// Integer maximum
+struct Highest {
+    static inline int32_t scalar(int32_t a, int32_t b) {
+        return a > b ? a : b;
+    }
+    static inline Vect128i sse2(const Vect128i& a, const Vect128i& b) {
+        return highest(a, b);
+    }
+    SIGHT_TARGET("sse4.1") static inline __m128i sse41(__m128i a, __m128i b) {
+        return _mm_max_epi32(a, b);
+    }
+    SIGHT_TARGET("avx2") static inline __m256i avx2(__m256i a, __m256i b) {
+        return _mm256_max_epi32(a, b);
+    }
+    SIGHT_TARGET("avx512f") static inline __m512i avx512f(__m512i a,
+                                                          __m512i b) {
+        return _mm512_max_epi32(a, b);
+    }
+};
+
+template <typename Op>
+inline void binary_sse2(const int32_t* a, const int32_t* b, int32_t* dst,
+                        size_t length) {
+    size_t i = 0;
+    for (; i + 4 <= length; i += 4) {
+        Vect128i r = Op::sse2(Vect128i::loadu(a + i), Vect128i::loadu(b + i));
+        r.storeu(dst + i);
+    }
+    for (; i < length; i++) {
+        dst[i] = Op::scalar(a[i], b[i]);
+    }
+}
+
+template <typename Op>
+SIGHT_TARGET("sse4.1")
+inline void binary_sse41(const int32_t* a, const int32_t* b, int32_t* dst,
+                         size_t length) {
+    size_t i = 0;
+    for (; i + 4 <= length; i += 4) {
+        auto pa = reinterpret_cast<const __m128i*>(a + i);
+        auto pb = reinterpret_cast<const __m128i*>(b + i);
+        auto pdst = reinterpret_cast<__m128i*>(dst + i);
+        _mm_storeu_si128(pdst, Op::sse41(_mm_loadu_si128(pa),
+                                         _mm_loadu_si128(pb)));
+    }
+    for (; i < length; i++) {
+        dst[i] = Op::scalar(a[i], b[i]);
+    }
+}
+
+template <typename Op>
+SIGHT_TARGET("avx2")
+inline void binary_avx2(const int32_t* a, const int32_t* b, int32_t* dst,
+                        size_t length) {
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        auto pa = reinterpret_cast<const __m256i*>(a + i);
+        auto pb = reinterpret_cast<const __m256i*>(b + i);
+        auto pdst = reinterpret_cast<__m256i*>(dst + i);
+        _mm256_storeu_si256(pdst, Op::avx2(_mm256_loadu_si256(pa),
+                                           _mm256_loadu_si256(pb)));
+    }
+    for (; i < length; i++) {
+        dst[i] = Op::scalar(a[i], b[i]);
+    }
+}
+
+// The remainder is done with a masked load & store instead of a loop
+template <typename Op>
+SIGHT_TARGET("avx512f")
+inline void binary_avx512f(const int32_t* a, const int32_t* b, int32_t* dst,
+                           size_t length) {
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m512i va = _mm512_loadu_si512(a + i);
+        __m512i vb = _mm512_loadu_si512(b + i);
+        _mm512_storeu_si512(dst + i, Op::avx512f(va, vb));
+    }
+    if (i < length) {
+        __mmask16 m = static_cast<__mmask16>((1u << (length - i)) - 1);
+        __m512i va = _mm512_maskz_loadu_epi32(m, a + i);
+        __m512i vb = _mm512_maskz_loadu_epi32(m, b + i);
+        _mm512_mask_storeu_epi32(dst + i, m, Op::avx512f(va, vb));
+    }
+}
+
+SIGHT_AVX512_WARNINGS_END
+
+template <typename Op>
+inline void binary(const int32_t* a, const int32_t* b, int32_t* dst,
+                   size_t length) {
+    const Isa isa = activeIsa();
+    SIGHT_DISPATCHED(isa);
+    SIGHT_TIME(Dispatch, length);
+    switch (isa) {
+        case Isa::AVX512F: return binary_avx512f<Op>(a, b, dst, length);
+        case Isa::AVX2: return binary_avx2<Op>(a, b, dst, length);
+        case Isa::SSE41: return binary_sse41<Op>(a, b, dst, length);
+        default: return binary_sse2<Op>(a, b, dst, length);
+    }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Kernels that pick their instruction set at runtime
+ *
+ * Each one is compiled for every tier, so a binary built for plain SSE2
+ * still runs the AVX2 or AVX-512 version on machines that have it
+ */
+namespace dispatch {
+
+/**
+ * @brief Multiplies arrays (dst[i] = a[i] * b[i])
+ *
+ * @param a, b arrays to multiply
+ * @param dst array to store into (may be a or b)
+ * @param length amount of values in each array
+ */
+inline void multiply(const int32_t* a, const int32_t* b, int32_t* dst,
+                     size_t length) {
+    detail::binary<detail::Multiply>(a, b, dst, length);
+}
+
+/**
+ * @brief Lowest of each value (dst[i] = min(a[i], b[i]))
+ *
+ * @param a, b arrays to compare
+ * @param dst array to store into (may be a or b)
+ * @param length amount of values in each array
+ */
+inline void lowest(const int32_t* a, const int32_t* b, int32_t* dst,
+                   size_t length) {
+    detail::binary<detail::Lowest>(a, b, dst, length);
+}
+
+/**
+ * @brief Highest of each value (dst[i] = max(a[i], b[i]))
+ *
+ * @param a, b arrays to compare
+ * @param dst array to store into (may be a or b)
+ * @param length amount of values in each array
+ */
+inline void highest(const int32_t* a, const int32_t* b, int32_t* dst,
+                    size_t length) {
+    detail::binary<detail::Highest>(a, b, dst, length);
+}
+
+}  // namespace dispatch
+}  // namespace sight
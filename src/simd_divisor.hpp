@@ -0,0 +1,161 @@
+#pragma once
+
+#include "simd.hpp"
+#include <cstdint>
+#include <stdexcept>
+
+namespace sight {
+
+/**
+ * @brief Signed int32 divisor, prepared for fast repeated division
+ *
+ * Dividing by a value known ahead of time is a multiply by a magic number
+ * and a shift (Granlund & Montgomery, as in Hacker's Delight 10-1), which
+ * vectorizes unlike the divide instruction. The result is exact and
+ * rounds towards zero, like the / and % operators on int32_t. Preparing
+ * costs about one scalar division, so it pays off after a few vectors
+ *
+ * @code
+ * Divisor buckets(count);
+ * Vect128i bucket = hash % buckets;
+ * @endcode
+ */
+class Divisor {
+  public:
+    /**
+     * @brief Prepares division by d, throws std::invalid_argument for 0
+     *
+     * @param d divisor
+     */
+    explicit Divisor(int32_t d) : d(d), magic(0), shift(0), correction(0) {
+        if (d == 0) {
+            throw std::invalid_argument("division by zero");
+        }
+        if (d == 1 || d == -1) {
+            return;
+        }
+
+        // smallest magic number that is exact for every int32
+        const uint32_t two31 = 0x80000000u;
+        uint32_t ad = d < 0 ? 0u - static_cast<uint32_t>(d)
+                            : static_cast<uint32_t>(d);
+        uint32_t t = two31 + (static_cast<uint32_t>(d) >> 31);
+        uint32_t anc = t - 1 - t % ad;
+        uint32_t q1 = two31 / anc, r1 = two31 - q1 * anc;
+        uint32_t q2 = two31 / ad, r2 = two31 - q2 * ad;
+        uint32_t delta;
+        int p = 31;
+        do {
+            p++;
+            q1 *= 2;
+            r1 *= 2;
+            if (r1 >= anc) {
+                q1++;
+                r1 -= anc;
+            }
+            q2 *= 2;
+            r2 *= 2;
+            if (r2 >= ad) {
+                q2++;
+                r2 -= ad;
+            }
+            delta = ad - r2;
+        } while (q1 < delta || (q1 == delta && r1 == 0));
+
+        uint32_t m = q2 + 1;
+        magic = static_cast<int32_t>(d < 0 ? 0u - m : m);
+        shift = p - 32;
+        // the magic number overflowed into the sign, fixed by adding n back
+        if (d > 0 && magic < 0) {
+            correction = 1;
+        } else if (d < 0 && magic > 0) {
+            correction = -1;
+        }
+    }
+
+    /// The divisor
+    inline int32_t value() const {
+        return d;
+    }
+
+    /**
+     * @brief Divides a scalar, the same way the vectors are
+     *
+     * @param n value to divide
+     * @return n / value()
+     */
+    inline int32_t divide(int32_t n) const {
+        // unsigned math, so it wraps around like the vector lanes do
+        uint32_t un = static_cast<uint32_t>(n);
+        if (magic == 0) {
+            return static_cast<int32_t>(d == 1 ? un : 0u - un);
+        }
+        int64_t product = static_cast<int64_t>(magic) * n;
+        uint32_t q = static_cast<uint32_t>(product >> 32);
+        if (correction > 0) {
+            q += un;
+        } else if (correction < 0) {
+            q -= un;
+        }
+        int32_t r = static_cast<int32_t>(q) >> shift;
+        return r + static_cast<int32_t>(static_cast<uint32_t>(r) >> 31);
+    }
+
+    /**
+     * @brief Divides every lane (r[i] = n[i] / value())
+     *
+     * INT32_MIN / -1 wraps around to INT32_MIN instead of trapping
+     *
+     * @param n values to divide
+     */
+    template <int N>
+    inline Vect<int32_t, N> divide(const Vect<int32_t, N>& n) const {
+        typedef Vect<int32_t, N> V;
+        if (magic == 0) {
+            return d == 1 ? n : V(0) - n;
+        }
+        V q = mulhi(n, V(magic));
+        if (correction > 0) {
+            q = q + n;
+        } else if (correction < 0) {
+            q = q - n;
+        }
+        q = sar(q, shift);
+        // rounds towards zero for negative quotients
+        return q + shr<31>(q);
+    }
+
+  private:
+    int32_t d;
+    int32_t magic;
+    int shift;
+    int correction;
+};
+
+/**
+ * @brief Divides every lane by the same divisor (r[i] = n[i] / d)
+ *
+ * @param n values to divide
+ * @param d prepared divisor
+ */
+template <int N>
+inline Vect<int32_t, N> operator/(const Vect<int32_t, N>& n,
+                                  const Divisor& d) {
+    return d.divide(n);
+}
+
+/**
+ * @brief Remainder of dividing every lane (r[i] = n[i] % d)
+ *
+ * Has the sign of n, like % on int32_t
+ *
+ * @param n values to divide
+ * @param d prepared divisor
+ */
+template <int N>
+inline Vect<int32_t, N> operator%(const Vect<int32_t, N>& n,
+                                  const Divisor& d) {
+    return n - d.divide(n) * Vect<int32_t, N>(d.value());
+}
+
+}  // namespace sight
@@ -0,0 +1,527 @@
+#pragma once
+
+#include "simd.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+/*
+ * Lazy element-wise expressions over whole arrays.
+ *
+ * lazy(a) wraps an array, and arithmetic on it builds a tree of Expr nodes
+ * instead of computing anything. evaluate() then runs the tree in a single
+ * loop, loading one vector of every array and storing one vector of the
+ * result per step, so (a + b) * c - d reads each array once and never
+ * writes a temporary array:
+ *
+ *   evaluate((lazy(a) + b) * c - d, out);
+ *
+ * Arrays (AlignedStorage, MappedStorage) and scalars can be mixed in as
+ * long as one side of every operator is an Expr. An expression only points
+ * to its arrays, it must not outlive them.
+ */
+
+namespace sight {
+
+template <typename E>
+class Expr;
+
+namespace detail {
+
+/// Values of an array
+template <typename T>
+class Leaf {
+  public:
+    typedef T value_type;
+
+    inline Leaf(const T* data, size_t count) : data(data), count(count) {}
+
+    inline size_t length() const {
+        return count;
+    }
+
+    template <typename V, bool Aligned>
+    inline V load(size_t i) const {
+        return Aligned ? V::load(data + i) : V::loadu(data + i);
+    }
+
+    inline bool aligned(size_t i, size_t bytes) const {
+        return reinterpret_cast<uintptr_t>(data + i) % bytes == 0;
+    }
+
+    inline bool reads(const T* p, size_t length) const {
+        return data < p + length && p < data + count;
+    }
+
+    template <typename V>
+    inline V loadPartial(size_t i, int n) const {
+        return V::load_partial(data + i, n);
+    }
+
+  private:
+    const T* data;
+    size_t count;
+};
+
+/// The same value in every lane
+template <typename X>
+class Constant {
+  public:
+    typedef void value_type;  // takes the type of the other side
+
+    explicit inline Constant(X value) : value(value) {}
+
+    inline size_t length() const {
+        return std::numeric_limits<size_t>::max();
+    }
+
+    template <typename V, bool Aligned>
+    inline V load(size_t) const {
+        return V(static_cast<typename V::value_type>(value));
+    }
+
+    inline bool aligned(size_t, size_t) const {
+        return true;
+    }
+
+    template <typename T>
+    inline bool reads(const T*, size_t) const {
+        return false;
+    }
+
+    template <typename V>
+    inline V loadPartial(size_t, int) const {
+        return V(static_cast<typename V::value_type>(value));
+    }
+
+  private:
+    X value;
+};
+
+/// Op applied to the values of L and R
+template <typename Op, typename L, typename R>
+class Binary {
+  public:
+    typedef typename std::conditional<
+        std::is_void<typename L::value_type>::value, typename R::value_type,
+        typename L::value_type>::type value_type;
+
+    inline Binary(const L& l, const R& r) : l(l), r(r) {
+        const size_t none = std::numeric_limits<size_t>::max();
+        if (l.length() != r.length() && l.length() != none
+            && r.length() != none) {
+            throw std::out_of_range("arrays of different lengths");
+        }
+    }
+
+    inline size_t length() const {
+        return std::min(l.length(), r.length());
+    }
+
+    template <typename V, bool Aligned>
+    inline V load(size_t i) const {
+        return Op::apply(l.template load<V, Aligned>(i),
+                         r.template load<V, Aligned>(i));
+    }
+
+    inline bool aligned(size_t i, size_t bytes) const {
+        return l.aligned(i, bytes) && r.aligned(i, bytes);
+    }
+
+    template <typename T>
+    inline bool reads(const T* p, size_t length) const {
+        return l.reads(p, length) || r.reads(p, length);
+    }
+
+    template <typename V>
+    inline V loadPartial(size_t i, int n) const {
+        return Op::apply(l.template loadPartial<V>(i, n),
+                         r.template loadPartial<V>(i, n));
+    }
+
+  private:
+    L l;
+    R r;
+};
+
+/// Functor op applied to the values of E
+template <typename Op, typename E>
+class Unary {
+  public:
+    typedef typename E::value_type value_type;
+
+    inline Unary(const E& e, const Op& op) : e(e), op(op) {}
+
+    inline size_t length() const {
+        return e.length();
+    }
+
+    template <typename V, bool Aligned>
+    inline V load(size_t i) const {
+        return op(e.template load<V, Aligned>(i));
+    }
+
+    inline bool aligned(size_t i, size_t bytes) const {
+        return e.aligned(i, bytes);
+    }
+
+    template <typename T>
+    inline bool reads(const T* p, size_t length) const {
+        return e.reads(p, length);
+    }
+
+    template <typename V>
+    inline V loadPartial(size_t i, int n) const {
+        return op(e.template loadPartial<V>(i, n));
+    }
+
+  private:
+    E e;
+    Op op;
+};
+
+// Operations of the nodes
+
+struct Plus {
+    template <typename V>
+    static inline V apply(const V& a, const V& b) {
+        return a + b;
+    }
+};
+
+struct Minus {
+    template <typename V>
+    static inline V apply(const V& a, const V& b) {
+        return a - b;
+    }
+};
+
+struct Times {
+    template <typename V>
+    static inline V apply(const V& a, const V& b) {
+        return a * b;
+    }
+};
+
+struct Divide {
+    template <typename V>
+    static inline V apply(const V& a, const V& b) {
+        return a / b;
+    }
+};
+
+struct Least {
+    template <typename V>
+    static inline V apply(const V& a, const V& b) {
+        return lowest(a, b);
+    }
+};
+
+struct Most {
+    template <typename V>
+    static inline V apply(const V& a, const V& b) {
+        return highest(a, b);
+    }
+};
+
+struct Negate {
+    template <typename V>
+    inline V operator()(const V& v) const {
+        return V(0) - v;
+    }
+};
+
+struct Root {
+    template <typename V>
+    inline V operator()(const V& v) const {
+        return sqrt(v);
+    }
+};
+
+/// Node type of an operand, nothing for types that can't be one
+template <typename X, typename = void>
+struct Node {};
+
+template <typename E>
+struct Node<Expr<E>> {
+    typedef E type;
+    static inline const E& get(const Expr<E>& e) {
+        return e.node();
+    }
+};
+
+template <typename T, int Align>
+struct Node<AlignedStorage<T, Align>> {
+    typedef Leaf<T> type;
+    static inline Leaf<T> get(const AlignedStorage<T, Align>& s) {
+        return Leaf<T>(s, s.length());
+    }
+};
+
+template <typename T>
+struct Node<MappedStorage<T>> {
+    typedef Leaf<T> type;
+    static inline Leaf<T> get(const MappedStorage<T>& s) {
+        return Leaf<T>(s, s.length());
+    }
+};
+
+template <typename X>
+struct Node<X, typename std::enable_if<std::is_arithmetic<X>::value>::type> {
+    typedef Constant<X> type;
+    static inline Constant<X> get(X x) {
+        return Constant<X>(x);
+    }
+};
+
+template <typename X>
+struct IsExpr : std::false_type {};
+
+template <typename E>
+struct IsExpr<Expr<E>> : std::true_type {};
+
+/// Expr of Op on two operands, nothing unless one of them is an Expr
+template <typename Op, typename A, typename B,
+          bool = IsExpr<A>::value || IsExpr<B>::value>
+struct BinaryExpr {};
+
+template <typename Op, typename A, typename B>
+struct BinaryExpr<Op, A, B, true> {
+    typedef Expr<Binary<Op, typename Node<A>::type, typename Node<B>::type>>
+        type;
+};
+
+template <typename Op, typename A, typename B>
+inline typename BinaryExpr<Op, A, B>::type binary(const A& a, const B& b) {
+    typedef typename BinaryExpr<Op, A, B>::type R;
+    return R(typename R::node_type(Node<A>::get(a), Node<B>::get(b)));
+}
+
+/**
+ * @brief Evaluates [begin, end) of node e into d
+ *
+ * Loads and stores whole vectors, the remainder goes through a zero
+ * padded vector. d can be one of the arrays of e, every value is read
+ * before it's written
+ */
+template <typename V, typename E, typename T>
+inline void evaluateRange(const E& e, T* d, size_t begin, size_t end,
+                          bool stream) {
+    size_t i = begin;
+    if (stream && isAligned<sizeof(V)>(d + i)
+        && !e.reads(d + begin, end - begin)) {
+        for (; room<V::lanes>(i, end); i += V::lanes) {
+            e.template load<V, false>(i).stream(d + i);
+        }
+        streamFence();
+        SIGHT_COUNT(StreamedRun);
+    } else if (e.aligned(i, sizeof(V)) && isAligned<sizeof(V)>(d + i)) {
+        for (; room<V::lanes>(i, end); i += V::lanes) {
+            e.template load<V, true>(i).store(d + i);
+        }
+        SIGHT_COUNT(AlignedRun);
+    } else {
+        for (; room<V::lanes>(i, end); i += V::lanes) {
+            e.template load<V, false>(i).storeu(d + i);
+        }
+        SIGHT_COUNT(UnalignedRun);
+    }
+    if (i < end) {
+        const int count = static_cast<int>(end - i);
+        e.template loadPartial<V>(i, count).store_partial(d + i, count);
+        SIGHT_COUNT(PartialTail);
+    }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Lazy element-wise expression, see lazy() and evaluate()
+ *
+ * @param E node type, built by the operators
+ */
+template <typename E>
+class Expr {
+  public:
+    typedef E node_type;
+    typedef typename E::value_type value_type;
+
+    explicit inline Expr(const E& e) : e(e) {}
+
+    /// Amount of values the expression produces
+    inline size_t length() const {
+        return e.length();
+    }
+
+    /// Root node of the expression
+    inline const E& node() const {
+        return e;
+    }
+
+  private:
+    E e;
+};
+
+/**
+ * @brief Starts an expression from the values of an array
+ *
+ * @param s array to read when the expression is evaluated
+ */
+template <typename T, int Align>
+inline Expr<detail::Leaf<T>> lazy(const AlignedStorage<T, Align>& s) {
+    return Expr<detail::Leaf<T>>(detail::Leaf<T>(s, s.length()));
+}
+
+/**
+ * @brief Starts an expression from the values of a mapped file
+ *
+ * @param s file to read when the expression is evaluated
+ */
+template <typename T>
+inline Expr<detail::Leaf<T>> lazy(const MappedStorage<T>& s) {
+    return Expr<detail::Leaf<T>>(detail::Leaf<T>(s, s.length()));
+}
+
+/// Lazy a[i] + b[i], either side can be an Expr, array or scalar
+template <typename A, typename B>
+inline typename detail::BinaryExpr<detail::Plus, A, B>::type
+operator+(const A& a, const B& b) {
+    return detail::binary<detail::Plus>(a, b);
+}
+
+/// Lazy a[i] - b[i]
+template <typename A, typename B>
+inline typename detail::BinaryExpr<detail::Minus, A, B>::type
+operator-(const A& a, const B& b) {
+    return detail::binary<detail::Minus>(a, b);
+}
+
+/// Lazy a[i] * b[i]
+template <typename A, typename B>
+inline typename detail::BinaryExpr<detail::Times, A, B>::type
+operator*(const A& a, const B& b) {
+    return detail::binary<detail::Times>(a, b);
+}
+
+/// Lazy a[i] / b[i]
+template <typename A, typename B>
+inline typename detail::BinaryExpr<detail::Divide, A, B>::type
+operator/(const A& a, const B& b) {
+    return detail::binary<detail::Divide>(a, b);
+}
+
+/// Lazy lowest(a[i], b[i])
+template <typename A, typename B>
+inline typename detail::BinaryExpr<detail::Least, A, B>::type
+lowest(const A& a, const B& b) {
+    return detail::binary<detail::Least>(a, b);
+}
+
+/// Lazy highest(a[i], b[i])
+template <typename A, typename B>
+inline typename detail::BinaryExpr<detail::Most, A, B>::type
+highest(const A& a, const B& b) {
+    return detail::binary<detail::Most>(a, b);
+}
+
+/**
+ * @brief Lazy op(e[i]) for any functor taking and returning a vector
+ *
+ * Like the op of transform(), ie. map(lazy(x), Exp()) with a functor
+ * calling exp()
+ *
+ * @param e expression to apply op to
+ * @param op functor templated on the vector type, copied into the node
+ */
+template <typename E, typename Op>
+inline Expr<detail::Unary<Op, E>> map(const Expr<E>& e, const Op& op) {
+    return Expr<detail::Unary<Op, E>>(detail::Unary<Op, E>(e.node(), op));
+}
+
+/// Lazy -e[i]
+template <typename E>
+inline Expr<detail::Unary<detail::Negate, E>> operator-(const Expr<E>& e) {
+    return map(e, detail::Negate());
+}
+
+/// Lazy sqrt(e[i]), as approximate as sqrt() of a vector
+template <typename E>
+inline Expr<detail::Unary<detail::Root, E>> sqrt(const Expr<E>& e) {
+    return map(e, detail::Root());
+}
+
+/**
+ * @brief Computes e into dst, in one pass over all the arrays
+ *
+ * dst can be one of the arrays in e (a = a * 2 + b). Outputs above
+ * SIGHT_STREAM_THRESHOLD bytes that none of the arrays overlap are written
+ * with streaming stores
+ *
+ * @param V vector type to evaluate with (the widest one for T by default)
+ * @param e expression to evaluate, at least one array long
+ * @param dst where to store the values, at least e.length() long
+ */
+template <typename V, typename E, typename T, int Align>
+inline void evaluate(const Expr<E>& e, AlignedStorage<T, Align>& dst) {
+    static_assert(std::is_same<typename E::value_type, T>::value,
+                  "expression and destination have different types");
+    const size_t length = e.length();
+    if (dst.length() < length) {
+        throw std::out_of_range("destination is smaller than source");
+    }
+    SIGHT_TIME(Evaluate, length);
+    detail::evaluateRange<V>(e.node(), static_cast<T*>(dst), 0, length,
+                             detail::streams<T>(length));
+}
+
+/**
+ * @brief Computes e into dst using the widest vector for T
+ */
+template <typename E, typename T, int Align>
+inline void evaluate(const Expr<E>& e, AlignedStorage<T, Align>& dst) {
+    evaluate<typename detail::Widest<T>::type>(e, dst);
+}
+
+/**
+ * @brief evaluate() split into chunks, run on several threads
+ *
+ * Uses the same chunks as parallelTransform()
+ *
+ * @param V vector type to evaluate with (the widest one for T by default)
+ * @param e expression to evaluate, at least one array long
+ * @param dst where to store the values, at least e.length() long
+ * @param executor threads to run on, the shared pool by default
+ */
+template <typename V, typename E, typename T, int Align,
+          typename Executor = ThreadPool>
+inline void parallelEvaluate(const Expr<E>& e, AlignedStorage<T, Align>& dst,
+                             Executor& executor = ThreadPool::shared()) {
+    static_assert(std::is_same<typename E::value_type, T>::value,
+                  "expression and destination have different types");
+    const size_t length = e.length();
+    if (dst.length() < length) {
+        throw std::out_of_range("destination is smaller than source");
+    }
+    SIGHT_TIME(ParallelEvaluate, length);
+    T* d = dst;
+    const bool stream = detail::streams<T>(length);
+    const detail::Chunks<T> chunks(d, length);
+    executor.run(chunks.count(), [&](size_t k) {
+        detail::evaluateRange<V>(e.node(), d, chunks.begin(k), chunks.end(k),
+                                 stream);
+    });
+}
+
+/**
+ * @brief evaluate() on several threads using the widest vector for T
+ */
+template <typename E, typename T, int Align, typename Executor = ThreadPool>
+inline void parallelEvaluate(const Expr<E>& e, AlignedStorage<T, Align>& dst,
+                             Executor& executor = ThreadPool::shared()) {
+    parallelEvaluate<typename detail::Widest<T>::type>(e, dst, executor);
+}
+
+}  // namespace sight
@@ -0,0 +1,229 @@
+#pragma once
+
+#include "simd.hpp"
+#include <cstdint>
+#include <limits>
+
+/*
+ * Transcendental functions for every float vector (Vect128f, Vect256f and
+ * Vect512f), written once against the Vect<float, N> interface.
+ *
+ * Each function reduces its argument to a small range and evaluates a
+ * polynomial there (the coefficients come from Cephes and fdlibm). Errors
+ * below are the largest seen against double precision libm over the whole
+ * float range (every 97th float), in ULP of the float result:
+ *
+ *   exp   1 ULP      log   1 ULP      sin/cos  2.5 ULP for |x| < 8192
+ *   tanh  1.5 ULP    pow   see pow()
+ *
+ * None of them set errno or raise floating point exceptions on purpose.
+ * Values that don't fit the result (NaN, infinity, out of domain) follow
+ * the C library, except where noted.
+ */
+
+namespace sight {
+namespace detail {
+
+/**
+ * @brief 2^n for integers n in [-126, 127]
+ */
+template <int N>
+inline Vect<float, N> pow2(const Vect<int32_t, N>& n) {
+    return as_float(shl<23>(n + Vect<int32_t, N>(127)));
+}
+
+/**
+ * @brief sin(x) for offset 0, cos(x) for offset 1
+ *
+ * x is reduced to r = x - q * pi/2 with pi/2 split in four parts (Cody &
+ * Waite), then quadrant q picks the sin or cos polynomial of r and the sign
+ */
+template <int N>
+inline Vect<float, N> sincos(const Vect<float, N>& x, int offset) {
+    typedef Vect<float, N> V;
+    typedef Vect<int32_t, N> VI;
+
+    VI q = to_int_nearest(x * V(0.636619772367581343f));
+    V qf = q;
+    V r = fnma(qf, V(1.5703125f), x);
+    r = fnma(qf, V(4.837512969970703125e-4f), r);
+    r = fnma(qf, V(7.549533620476723e-8f), r);
+    r = fnma(qf, V(2.5633440682570896e-12f), r);
+    q = q + VI(offset);
+
+    V z = r * r;
+    V s = fma(V(-1.9515295891e-4f), z, V(8.3321608736e-3f));
+    s = fma(s, z, V(-1.6666654611e-1f));
+    s = fma(s * z, r, r);
+    V c = fma(V(2.443315711809948e-5f), z, V(-1.388731625493765e-3f));
+    c = fma(c, z, V(4.166664568298827e-2f));
+    c = fma(c * z, z, fnma(V(0.5f), z, V(1)));
+
+    const VI one(1);
+    V result = select((q & one) == one, c, s);
+    // quadrants 2 and 3 are negated, bit 1 of q moves to the sign bit
+    return result ^ as_float(shl<30>(q & VI(2)));
+}
+
+}  // namespace detail
+
+/**
+ * @brief e raised to each value
+ *
+ * Results below the smallest normal float are denormal as usual, exp(-inf)
+ * is 0, exp(inf) is inf and NaN stays NaN
+ *
+ * @param x exponents
+ * @return e^x[i], within 1 ULP
+ */
+template <int N>
+inline Vect<float, N> exp(const Vect<float, N>& x) {
+    typedef Vect<float, N> V;
+    typedef Vect<int32_t, N> VI;
+
+    // outside of this range the result is 0 or inf anyway. min & max return
+    // their second argument for NaN, so NaN isn't clamped
+    V xc = highest(V(-104.0f), lowest(V(88.8f), x));
+
+    // x = n * ln(2) + r with |r| <= ln(2) / 2
+    VI n = to_int_nearest(xc * V(1.44269504088896341f));
+    V nf = n;
+    V r = fnma(nf, V(0.693359375f), xc);
+    r = fnma(nf, V(-2.12194440e-4f), r);
+
+    V p = fma(V(1.9875691500e-4f), r, V(1.3981999507e-3f));
+    p = fma(p, r, V(8.3334519073e-3f));
+    p = fma(p, r, V(4.1665795894e-2f));
+    p = fma(p, r, V(1.6666665459e-1f));
+    p = fma(p, r, V(5.0000001201e-1f));
+    p = fma(p, r * r, r) + V(1);
+
+    // 2^n is applied in two steps, so both factors are normal floats and
+    // only the last multiply over- or underflows
+    VI half = to_int_nearest(nf * V(0.5f));
+    return p * detail::pow2(half) * detail::pow2(n - half);
+}
+
+/**
+ * @brief Natural logarithm of each value
+ *
+ * log(0) is -inf, log(inf) is inf and negative values or NaN give NaN.
+ * Denormal inputs are handled
+ *
+ * @param x values to take the logarithm of
+ * @return ln(x[i]), within 1 ULP
+ */
+template <int N>
+inline Vect<float, N> log(const Vect<float, N>& x) {
+    typedef Vect<float, N> V;
+    typedef Vect<int32_t, N> VI;
+
+    // scale denormals by 2^23 so that the exponent field is usable
+    auto denormal = x < V(std::numeric_limits<float>::min());
+    V xs = select(denormal, x * V(8388608.0f), x);
+    V bias = select(denormal, V(23), V(0));
+
+    // x = 2^k * m with m in [sqrt(2) / 2, sqrt(2))
+    VI bits = as_int(xs);
+    VI kbits = (bits - VI(0x3f3504f3)) & VI(0xff800000);
+    V k = V(kbits) * V(1.0f / 8388608) - bias;
+    V f = as_float(bits - kbits) - V(1);
+
+    // log(1 + f) = f - f^2 / 2 + s * (f^2 / 2 + R(s^2)), s = f / (2 + f)
+    V s = f / (V(2) + f);
+    V z = s * s;
+    V R = fma(V(1.4798198640e-1f), z, V(1.5313838422e-1f));
+    R = fma(R, z, V(1.8183572590e-1f));
+    R = fma(R, z, V(2.2222198546e-1f));
+    R = fma(R, z, V(2.8571429849e-1f));
+    R = fma(R, z, V(4.0000000596e-1f));
+    R = fma(R, z, V(6.6666668653e-1f));
+    R = R * z;
+    V hfsq = V(0.5f) * f * f;
+    V lo = fma(k, V(9.0580006145e-6f), s * (hfsq + R));
+    V result = fma(k, V(6.9313812256e-1f), f - (hfsq - lo));
+
+    const V inf(std::numeric_limits<float>::infinity());
+    result = select(x == V(0), V(0) - inf, result);
+    result = select(x == inf, inf, result);
+    return select((x < V(0)) | (x != x),
+                  V(std::numeric_limits<float>::quiet_NaN()), result);
+}
+
+/**
+ * @brief Sine of each value
+ *
+ * Range reduction is exact for |x| < 8192 only, larger angles lose
+ * accuracy quickly unless HAVE_FMA is set (then it holds up to 10^6).
+ * inf and NaN give NaN
+ *
+ * @param x angles in radians
+ * @return sin(x[i]), within 2.5 ULP for |x| < 8192
+ */
+template <int N>
+inline Vect<float, N> sin(const Vect<float, N>& x) {
+    return detail::sincos(x, 0);
+}
+
+/**
+ * @brief Cosine of each value
+ *
+ * Same range and accuracy as sin()
+ *
+ * @param x angles in radians
+ * @return cos(x[i]), within 2.5 ULP for |x| < 8192
+ */
+template <int N>
+inline Vect<float, N> cos(const Vect<float, N>& x) {
+    return detail::sincos(x, 1);
+}
+
+/**
+ * @brief Hyperbolic tangent of each value
+ *
+ * Small values use a polynomial, larger ones 1 - 2 / (e^2|x| + 1) with the
+ * sign of x, so this costs about one exp() and one division
+ *
+ * @param x values
+ * @return tanh(x[i]), within 1.5 ULP
+ */
+template <int N>
+inline Vect<float, N> tanh(const Vect<float, N>& x) {
+    typedef Vect<float, N> V;
+
+    const V sign(-0.0f);
+    V ax = x & as_float(Vect<int32_t, N>(0x7fffffff));
+    V big = V(1) - V(2) / (exp(ax + ax) + V(1));
+    big = big | (x & sign);
+
+    V z = x * x;
+    V p = fma(V(-5.70498872745e-3f), z, V(2.06390887954e-2f));
+    p = fma(p, z, V(-5.37397155531e-2f));
+    p = fma(p, z, V(1.33314422036e-1f));
+    p = fma(p, z, V(-3.33332819422e-1f));
+    V small = fma(p * z, x, x);
+
+    return select(ax < V(0.625f), small, big);
+}
+
+/**
+ * @brief x[i] raised to y[i]
+ *
+ * Computed as exp(y * log(x)), so the rounding error of log(x) is scaled
+ * by y: the result is within about 1 + 2 * |y * ln(x)| ULP, ie. 20 ULP for
+ * results near 2^+-13 and up to 180 ULP near the ends of the float range,
+ * where results within a few ULP of the largest float may overflow to inf.
+ * x has to be positive (or 0), negative x gives NaN even for integer y.
+ * pow(x, 0) is 1
+ *
+ * @param x bases
+ * @param y exponents
+ * @return x[i]^y[i]
+ */
+template <int N>
+inline Vect<float, N> pow(const Vect<float, N>& x, const Vect<float, N>& y) {
+    typedef Vect<float, N> V;
+    return select(y == V(0), V(1), exp(y * log(x)));
+}
+
+}  // namespace sight
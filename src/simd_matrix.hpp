@@ -0,0 +1,521 @@
+#pragma once
+
+#include "simd.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+
+/*
+ * Matrices: a 4x4 float matrix for transforms, and matrix-vector and
+ * matrix-matrix products over AlignedStorage.
+ *
+ * Larger matrices are dense, row-major and stored without padding, so the
+ * value at (i, j) of an m x n matrix is at [i * n + j]. gemm() follows the
+ * usual BLAS layout split in blocks that stay in each level of cache, with
+ * the blocks packed so that the micro-kernel only reads memory in order.
+ */
+
+/// Columns of B packed at a time, a KC x NC panel stays in the L3 cache
+#ifndef SIGHT_GEMM_NC
+#define SIGHT_GEMM_NC 1024
+#endif
+
+/// Depth of the packed panels, a KC x NR sliver of B stays in the L1 cache
+#ifndef SIGHT_GEMM_KC
+#define SIGHT_GEMM_KC 256
+#endif
+
+/// Rows of A packed at a time, an MC x KC block stays in the L2 cache
+#ifndef SIGHT_GEMM_MC
+#define SIGHT_GEMM_MC 128
+#endif
+
+namespace sight {
+
+/**
+ * @brief 4x4 float matrix, stored as four rows
+ *
+ * Vectors are columns, so m * v transforms v and (a * b) * v applies b
+ * first, as in most math texts
+ *
+ * @code
+ * Mat4f m = Mat4f::identity();
+ * m[0] = Vect128f(1, 0, 0, dx);  // translate x by dx
+ * Vect128f moved = m * Vect128f(x, y, z, 1);
+ * @endcode
+ */
+class Mat4f {
+    Vect128f rows[4];
+
+  public:
+    /**
+     * @brief Empty matrix
+     */
+    inline Mat4f() {}
+
+    /**
+     * @brief Matrix made of four rows
+     *
+     * @param r0, r1, r2, r3 rows from top to bottom
+     */
+    inline Mat4f(const Vect128f& r0, const Vect128f& r1, const Vect128f& r2,
+                 const Vect128f& r3) {
+        rows[0] = r0;
+        rows[1] = r1;
+        rows[2] = r2;
+        rows[3] = r3;
+    }
+
+    /**
+     * @brief Identity matrix
+     */
+    static inline Mat4f identity() {
+        return Mat4f(Vect128f(1, 0, 0, 0), Vect128f(0, 1, 0, 0),
+                     Vect128f(0, 0, 1, 0), Vect128f(0, 0, 0, 1));
+    }
+
+    /**
+     * @brief Loads 16 values, row by row, from an aligned pointer
+     *
+     * @param p 16 byte aligned values
+     */
+    static inline Mat4f load(const float* p) {
+        return Mat4f(Vect128f::load(p), Vect128f::load(p + 4),
+                     Vect128f::load(p + 8), Vect128f::load(p + 12));
+    }
+
+    /**
+     * @brief Loads 16 values, row by row, from an arbitrary point
+     *
+     * @param p values to load
+     */
+    static inline Mat4f loadu(const float* p) {
+        return Mat4f(Vect128f::loadu(p), Vect128f::loadu(p + 4),
+                     Vect128f::loadu(p + 8), Vect128f::loadu(p + 12));
+    }
+
+    /**
+     * @brief Stores the rows one after the other into an aligned pointer
+     *
+     * @param p 16 byte aligned room for 16 values
+     */
+    inline void store(float* p) const {
+        for (int i = 0; i < 4; i++) {
+            rows[i].store(p + 4 * i);
+        }
+    }
+
+    /**
+     * @brief Stores the rows one after the other into an arbitrary point
+     *
+     * @param p room for 16 values
+     */
+    inline void storeu(float* p) const {
+        for (int i = 0; i < 4; i++) {
+            rows[i].storeu(p + 4 * i);
+        }
+    }
+
+    /**
+     * @brief Row of the matrix
+     *
+     * @param i row index (0 - 3), not bounds checked
+     */
+    inline Vect128f& operator[](int i) {
+        return rows[i];
+    }
+
+    /**
+     * @brief Row of the matrix
+     *
+     * @param i row index (0 - 3), not bounds checked
+     */
+    inline const Vect128f& operator[](int i) const {
+        return rows[i];
+    }
+};
+
+/**
+ * @brief Swaps the rows and columns of a matrix
+ *
+ * @param m matrix to transpose
+ */
+inline Mat4f transpose(const Mat4f& m) {
+    Mat4f r = m;
+    transpose(r[0], r[1], r[2], r[3]);
+    return r;
+}
+
+/**
+ * @brief Matrix product (r[i][j] = sum of a[i][k] * b[k][j])
+ *
+ * Each row of the result is a mix of the rows of b, so there's no
+ * horizontal math, only four broadcasts and four multiply-adds per row
+ *
+ * @param a, b matrices to multiply
+ */
+inline Mat4f operator*(const Mat4f& a, const Mat4f& b) {
+    Mat4f r;
+    for (int i = 0; i < 4; i++) {
+        Vect128f row = shuffle<0, 0, 0, 0>(a[i]) * b[0];
+        row = fma(shuffle<1, 1, 1, 1>(a[i]), b[1], row);
+        row = fma(shuffle<2, 2, 2, 2>(a[i]), b[2], row);
+        r[i] = fma(shuffle<3, 3, 3, 3>(a[i]), b[3], row);
+    }
+    return r;
+}
+
+/**
+ * @brief Transforms a column vector (r[i] = sum of m[i][k] * v[k])
+ *
+ * Transposes m on every call, use transform() for many vectors
+ *
+ * @param m transform to apply
+ * @param v vector to transform
+ */
+inline Vect128f operator*(const Mat4f& m, const Vect128f& v) {
+    Mat4f columns = transpose(m);
+    Vect128f r = shuffle<0, 0, 0, 0>(v) * columns[0];
+    r = fma(shuffle<1, 1, 1, 1>(v), columns[1], r);
+    r = fma(shuffle<2, 2, 2, 2>(v), columns[2], r);
+    return fma(shuffle<3, 3, 3, 3>(v), columns[3], r);
+}
+
+/**
+ * @brief Transforms an array of 4 float vectors (ie. x y z w points)
+ *
+ * dst[4 * i...] = m * src[4 * i...], the matrix is transposed only once.
+ * dst can be the same as src
+ *
+ * Throws std::invalid_argument if src isn't made of whole vectors, and
+ * std::out_of_range if dst is shorter than src
+ *
+ * @param m transform to apply
+ * @param src vectors one after the other
+ * @param dst storage for the transformed vectors
+ */
+template <int A1, int A2>
+void transform(const Mat4f& m, const AlignedStorage<float, A1>& src,
+               AlignedStorage<float, A2>& dst) {
+    static_assert(A1 >= 16 && A2 >= 16, "storage not aligned for vectors");
+    if (src.length() % 4 != 0) {
+        throw std::invalid_argument("not a whole number of vectors");
+    }
+    if (dst.length() < src.length()) {
+        throw std::out_of_range("destination smaller than source");
+    }
+    const Mat4f columns = transpose(m);
+    const float* s = src;
+    float* d = dst;
+    for (size_t i = 0; i < src.length(); i += 4) {
+        Vect128f v = Vect128f::load(s + i);
+        Vect128f r = shuffle<0, 0, 0, 0>(v) * columns[0];
+        r = fma(shuffle<1, 1, 1, 1>(v), columns[1], r);
+        r = fma(shuffle<2, 2, 2, 2>(v), columns[2], r);
+        fma(shuffle<3, 3, 3, 3>(v), columns[3], r).store(d + i);
+    }
+}
+
+namespace detail {
+
+/// Columns of x per gemv() block, 16 KiB stay in L1 while the rows go by
+const size_t gemvBlock = 4096;
+
+/// Rows of C computed at once by the gemm() micro-kernel
+const int kernelRows = 4;
+
+/// Checks that a rows x cols matrix fits in its storage
+template <int A>
+inline void checkMatrix(const AlignedStorage<float, A>& s, size_t rows,
+                        size_t cols) {
+    if (cols != 0 && rows > s.length() / cols) {
+        throw std::out_of_range("matrix larger than its storage");
+    }
+}
+
+/// Throws std::invalid_argument if the output storage is also an input
+inline void checkOutput(const void* out, const void* in) {
+    if (out == in) {
+        throw std::invalid_argument("output is also an input");
+    }
+}
+
+/**
+ * @brief Copies a kc x nc block of B into slivers of NR columns
+ *
+ * Each sliver holds NR values per row of the block, row after row, with
+ * the columns past nc zeroed so the micro-kernel never needs a tail
+ */
+template <typename V>
+void packColumns(const float* b, size_t ldb, size_t kc, size_t nc,
+                 float* packed) {
+    const int L = V::lanes, NR = 2 * V::lanes;
+    for (size_t j = 0; j < nc; j += NR, packed += kc * NR) {
+        const float* s = b + j;
+        if (j + NR <= nc) {
+            for (size_t p = 0; p < kc; p++, s += ldb) {
+                V::loadu(s).store(packed + p * NR);
+                V::loadu(s + L).store(packed + p * NR + L);
+            }
+            continue;
+        }
+        const size_t width = nc - j;
+        for (size_t p = 0; p < kc; p++, s += ldb) {
+            float* d = packed + p * NR;
+            std::copy(s, s + width, d);
+            std::fill(d + width, d + NR, 0.0f);
+        }
+    }
+}
+
+/**
+ * @brief Copies an mc x kc block of A into slivers of kernelRows rows
+ *
+ * Each sliver holds one column of its rows after the other, so the
+ * micro-kernel broadcasts values in order, rows past mc are zeroed
+ */
+inline void packRows(const float* a, size_t lda, size_t mc, size_t kc,
+                     float* packed) {
+    const int MR = kernelRows;
+    for (size_t i = 0; i < mc; i += MR, packed += kc * MR) {
+        const int height = static_cast<int>(std::min<size_t>(MR, mc - i));
+        for (int r = 0; r < height; r++) {
+            const float* s = a + (i + r) * lda;
+            for (size_t p = 0; p < kc; p++) {
+                packed[p * MR + r] = s[p];
+            }
+        }
+        for (int r = height; r < MR; r++) {
+            for (size_t p = 0; p < kc; p++) {
+                packed[p * MR + r] = 0.0f;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Adds the product of a packed sliver of A and one of B into C
+ *
+ * The kernelRows x 2 vectors of C stay in registers for the whole depth,
+ * every step is two loads, four broadcasts and eight multiply-adds
+ *
+ * @param kc depth of the slivers
+ * @param a, b packed slivers
+ * @param c top left corner of the tile in C
+ * @param ldc row length of C
+ * @param rows, cols size of the tile inside of C, at most 4 x 2 lanes
+ */
+template <typename V>
+void microKernel(size_t kc, const float* a, const float* b, float* c,
+                 size_t ldc, int rows, int cols) {
+    const int L = V::lanes;
+    V c00(0), c01(0), c10(0), c11(0), c20(0), c21(0), c30(0), c31(0);
+    for (size_t p = 0; p < kc; p++, a += kernelRows, b += 2 * L) {
+        V b0 = V::load(b), b1 = V::load(b + L);
+        V a0(a[0]), a1(a[1]), a2(a[2]), a3(a[3]);
+        c00 = fma(a0, b0, c00);
+        c01 = fma(a0, b1, c01);
+        c10 = fma(a1, b0, c10);
+        c11 = fma(a1, b1, c11);
+        c20 = fma(a2, b0, c20);
+        c21 = fma(a2, b1, c21);
+        c30 = fma(a3, b0, c30);
+        c31 = fma(a3, b1, c31);
+    }
+
+    const V tile[kernelRows][2] = {{c00, c01}, {c10, c11}, {c20, c21},
+                                   {c30, c31}};
+    for (int r = 0; r < rows; r++, c += ldc) {
+        if (cols == 2 * L) {
+            (V::loadu(c) + tile[r][0]).storeu(c);
+            (V::loadu(c + L) + tile[r][1]).storeu(c + L);
+        } else if (cols > L) {
+            (V::loadu(c) + tile[r][0]).storeu(c);
+            const int n = cols - L;
+            (V::load_partial(c + L, n) + tile[r][1]).store_partial(c + L, n);
+        } else {
+            (V::load_partial(c, cols) + tile[r][0]).store_partial(c, cols);
+        }
+    }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Matrix-vector product (y = A * x)
+ *
+ * Four rows are dotted with x at a time, and x is processed in blocks that
+ * stay in L1 however long the rows are
+ *
+ * Throws std::out_of_range if a matrix or vector is larger than its
+ * storage, and std::invalid_argument if y is a or x
+ *
+ * @param V vector type to use
+ * @param a rows x cols matrix
+ * @param x cols values
+ * @param y rows values, to store the result
+ * @param rows, cols size of a
+ */
+template <typename V, int A1, int A2, int A3>
+void gemv(const AlignedStorage<float, A1>& a,
+          const AlignedStorage<float, A2>& x, AlignedStorage<float, A3>& y,
+          size_t rows, size_t cols) {
+    detail::checkMatrix(a, rows, cols);
+    detail::checkMatrix(x, cols, 1);
+    detail::checkMatrix(y, rows, 1);
+    detail::checkOutput(&y, &a);
+    detail::checkOutput(&y, &x);
+
+    const int L = V::lanes;
+    const float* m = a;
+    const float* v = x;
+    float* r = y;
+    std::fill(r, r + rows, 0.0f);
+    for (size_t j0 = 0; j0 < cols; j0 += detail::gemvBlock) {
+        const size_t j1 = std::min(cols, j0 + detail::gemvBlock);
+        const int n = static_cast<int>((j1 - j0) % L);
+        const size_t end = j1 - n;
+
+        size_t i = 0;
+        for (; i + 4 <= rows; i += 4) {
+            const float* r0 = m + i * cols;
+            const float* r1 = r0 + cols;
+            const float* r2 = r1 + cols;
+            const float* r3 = r2 + cols;
+            V s0(0), s1(0), s2(0), s3(0);
+            for (size_t j = j0; j < end; j += L) {
+                V xj = V::loadu(v + j);
+                s0 = fma(V::loadu(r0 + j), xj, s0);
+                s1 = fma(V::loadu(r1 + j), xj, s1);
+                s2 = fma(V::loadu(r2 + j), xj, s2);
+                s3 = fma(V::loadu(r3 + j), xj, s3);
+            }
+            if (n) {
+                V xj = V::load_partial(v + end, n);
+                s0 = fma(V::load_partial(r0 + end, n), xj, s0);
+                s1 = fma(V::load_partial(r1 + end, n), xj, s1);
+                s2 = fma(V::load_partial(r2 + end, n), xj, s2);
+                s3 = fma(V::load_partial(r3 + end, n), xj, s3);
+            }
+            r[i] += hsum(s0);
+            r[i + 1] += hsum(s1);
+            r[i + 2] += hsum(s2);
+            r[i + 3] += hsum(s3);
+        }
+        for (; i < rows; i++) {
+            const float* row = m + i * cols;
+            V s(0);
+            for (size_t j = j0; j < end; j += L) {
+                s = fma(V::loadu(row + j), V::loadu(v + j), s);
+            }
+            if (n) {
+                s = fma(V::load_partial(row + end, n),
+                        V::load_partial(v + end, n), s);
+            }
+            r[i] += hsum(s);
+        }
+    }
+}
+
+/**
+ * @brief Matrix-vector product (y = A * x) with NativeVectf
+ *
+ * @param a rows x cols matrix
+ * @param x cols values
+ * @param y rows values, to store the result
+ * @param rows, cols size of a
+ */
+template <int A1, int A2, int A3>
+void gemv(const AlignedStorage<float, A1>& a,
+          const AlignedStorage<float, A2>& x, AlignedStorage<float, A3>& y,
+          size_t rows, size_t cols) {
+    gemv<NativeVectf>(a, x, y, rows, cols);
+}
+
+/**
+ * @brief Matrix product (C = A * B)
+ *
+ * B is packed SIGHT_GEMM_KC x SIGHT_GEMM_NC at a time, and A
+ * SIGHT_GEMM_MC x SIGHT_GEMM_KC at a time, into buffers from the thread's
+ * AlignedArena::local(). The micro-kernel keeps a 4 x 2 vector tile of C in
+ * registers and uses FMA when it's enabled. Sums are done in a different
+ * order than the naive triple loop, so the last bits can differ from it
+ *
+ * Throws std::out_of_range if a matrix is larger than its storage, and
+ * std::invalid_argument if c is a or b
+ *
+ * @param V vector type to use
+ * @param a m x k matrix
+ * @param b k x n matrix
+ * @param c m x n matrix, to store the result
+ * @param m, k, n sizes of the matrices
+ */
+template <typename V, int A1, int A2, int A3>
+void gemm(const AlignedStorage<float, A1>& a,
+          const AlignedStorage<float, A2>& b, AlignedStorage<float, A3>& c,
+          size_t m, size_t k, size_t n) {
+    detail::checkMatrix(a, m, k);
+    detail::checkMatrix(b, k, n);
+    detail::checkMatrix(c, m, n);
+    detail::checkOutput(&c, &a);
+    detail::checkOutput(&c, &b);
+
+    const size_t MR = detail::kernelRows, NR = 2 * V::lanes;
+    const size_t NC = SIGHT_GEMM_NC, KC = SIGHT_GEMM_KC, MC = SIGHT_GEMM_MC;
+    const float* lhs = a;
+    const float* rhs = b;
+    float* out = c;
+    std::fill(out, out + m * n, 0.0f);
+    if (m == 0 || k == 0 || n == 0) {
+        return;
+    }
+
+    AlignedArena& arena = AlignedArena::local();
+    AlignedArena::Scope scope(arena);
+    const size_t widest = (std::min(n, NC) + NR - 1) / NR * NR;
+    const size_t tallest = (std::min(m, MC) + MR - 1) / MR * MR;
+    AlignedStorage<float, 64> panel(std::min(k, KC) * widest, arena);
+    AlignedStorage<float, 64> block(tallest * std::min(k, KC), arena);
+    float* packedB = panel;
+    float* packedA = block;
+
+    for (size_t jc = 0; jc < n; jc += NC) {
+        const size_t nc = std::min(NC, n - jc);
+        for (size_t pc = 0; pc < k; pc += KC) {
+            const size_t kc = std::min(KC, k - pc);
+            detail::packColumns<V>(rhs + pc * n + jc, n, kc, nc, packedB);
+            for (size_t ic = 0; ic < m; ic += MC) {
+                const size_t mc = std::min(MC, m - ic);
+                detail::packRows(lhs + ic * k + pc, k, mc, kc, packedA);
+                for (size_t jr = 0; jr < nc; jr += NR) {
+                    const int cols = static_cast<int>(std::min(NR, nc - jr));
+                    for (size_t ir = 0; ir < mc; ir += MR) {
+                        const int rows =
+                            static_cast<int>(std::min(MR, mc - ir));
+                        detail::microKernel<V>(kc, packedA + ir * kc,
+                                               packedB + jr * kc,
+                                               out + (ic + ir) * n + jc + jr,
+                                               n, rows, cols);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Matrix product (C = A * B) with NativeVectf
+ *
+ * @param a m x k matrix
+ * @param b k x n matrix
+ * @param c m x n matrix, to store the result
+ * @param m, k, n sizes of the matrices
+ */
+template <int A1, int A2, int A3>
+void gemm(const AlignedStorage<float, A1>& a,
+          const AlignedStorage<float, A2>& b, AlignedStorage<float, A3>& c,
+          size_t m, size_t k, size_t n) {
+    gemm<NativeVectf>(a, b, c, m, k, n);
+}
+
+}  // namespace sight
@@ -0,0 +1,606 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+    #include <xmmintrin.h>
+#endif
+
+namespace sight {
+
+/**
+ * @brief Allocator for memory aligned to Align bytes
+ *
+ * Meets the standard allocator requirements, so it can back containers,
+ * ie. std::vector<float, AlignedAllocator<float, 64>>. Power of two
+ * alignments use posix_memalign, any other alignment over-allocates by
+ * Align - 1 bytes plus a pointer to the real allocation.
+ *
+ * @param T type of underlying data
+ * @param Align alignment in memory
+ */
+template <typename T, int Align>
+class AlignedAllocator {
+  public:
+    static_assert(Align > 0, "alignment has to be positive");
+
+    /// Type of allocated data
+    typedef T value_type;
+
+    /// Same allocator for another type
+    template <typename U>
+    struct rebind {
+        typedef AlignedAllocator<U, Align> other;
+    };
+
+    inline AlignedAllocator() {}
+
+    template <typename U>
+    inline AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+    /**
+     * @brief Allocates uninitialized memory for n values of T
+     *
+     * @param n amount of values
+     * @return pointer aligned to Align, throws std::bad_alloc on failure
+     */
+    inline T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(allocateBytes(n * sizeof(T)));
+    }
+
+    /**
+     * @brief Releases memory from allocate()
+     *
+     * @param p pointer returned by allocate()
+     */
+    inline void deallocate(T* p, size_t) {
+        deallocateBytes(p);
+    }
+
+    /**
+     * @brief Allocates uninitialized, aligned memory
+     *
+     * @param bytes size of the allocation
+     */
+    static inline void* allocateBytes(size_t bytes) {
+        if (bytes == 0) {
+            bytes = 1;
+        }
+        if (power_of_two) {
+            void* p;
+            size_t align = static_cast<size_t>(Align);
+            if (align < sizeof(void*)) {
+                align = sizeof(void*);  // posix_memalign's minimum
+            }
+            if (posix_memalign(&p, align, bytes) != 0) {
+                throw std::bad_alloc();
+            }
+            return p;
+        }
+
+        // the real allocation is kept right before the aligned pointer
+        const size_t extra = Align - 1 + sizeof(void*);
+        if (bytes > std::numeric_limits<size_t>::max() - extra) {
+            throw std::bad_alloc();
+        }
+        void* raw = malloc(bytes + extra);
+        if (!raw) {
+            throw std::bad_alloc();
+        }
+        uintptr_t start = reinterpret_cast<uintptr_t>(raw) + sizeof(void*);
+        uintptr_t aligned = (start + Align - 1) / Align * Align;
+        memcpy(reinterpret_cast<void*>(aligned - sizeof(void*)), &raw,
+               sizeof(void*));
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    /**
+     * @brief Releases memory from allocateBytes()
+     *
+     * @param p pointer returned by allocateBytes(), or nullptr
+     */
+    static inline void deallocateBytes(void* p) {
+        if (power_of_two || !p) {
+            free(p);
+            return;
+        }
+        void* raw;
+        memcpy(&raw, static_cast<char*>(p) - sizeof(void*), sizeof(void*));
+        free(raw);
+    }
+
+  private:
+    static constexpr bool power_of_two = (Align & (Align - 1)) == 0;
+};
+
+template <typename T, typename U, int Align>
+inline bool operator==(const AlignedAllocator<T, Align>&,
+                       const AlignedAllocator<U, Align>&) {
+    return true;
+}
+
+template <typename T, typename U, int Align>
+inline bool operator!=(const AlignedAllocator<T, Align>&,
+                       const AlignedAllocator<U, Align>&) {
+    return false;
+}
+
+/**
+ * @brief Source of raw, aligned memory
+ *
+ * Lets AlignedStorage take its memory from somewhere other than the heap,
+ * ie. an AlignedArena. Implementations decide if deallocate() actually
+ * frees anything
+ */
+class MemoryResource {
+  public:
+    virtual ~MemoryResource() {}
+
+    /**
+     * @brief Allocates uninitialized memory
+     *
+     * @param bytes size of the allocation
+     * @param align alignment of the result, doesn't have to be a power of 2
+     * @return aligned memory, throws std::bad_alloc on failure
+     */
+    virtual void* allocate(size_t bytes, size_t align) = 0;
+
+    /**
+     * @brief Gives back memory from allocate() with the same bytes & align
+     */
+    virtual void deallocate(void* p, size_t bytes, size_t align) = 0;
+};
+
+/**
+ * @brief Bump pointer allocator for short-lived scratch buffers
+ *
+ * Memory is carved out of large page aligned chunks, so an allocation is
+ * an add and a compare. Individual deallocations are free (only the most
+ * recent allocation is actually given back), everything is released at
+ * once by reset(), which keeps the chunks for reuse, or by rewinding to a
+ * mark(). Pointers from the arena are invalid after either of those.
+ *
+ * Not thread-safe, each thread should use its own, ie. local()
+ *
+ * @code
+ * AlignedArena& arena = AlignedArena::local();
+ * AlignedArena::Scope scope(arena);  // rewinds when leaving the block
+ * AlignedStorage<float, 64> scratch(n, arena);
+ * @endcode
+ */
+class AlignedArena : public MemoryResource {
+  public:
+    /// Position in the arena, see mark() and rewind()
+    struct Marker {
+        size_t chunk;
+        size_t offset;
+    };
+
+    /// Rewinds an arena to where it was on construction
+    class Scope {
+      public:
+        explicit Scope(AlignedArena& arena)
+            : arena(arena), marker(arena.mark()) {}
+
+        ~Scope() {
+            arena.rewind(marker);
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+      private:
+        AlignedArena& arena;
+        Marker marker;
+    };
+
+    /// Alignment of every chunk
+    static const size_t ChunkAlign = 4096;
+
+    /**
+     * @brief Creates an empty arena, chunks are allocated on demand
+     *
+     * @param chunkSize bytes per chunk, larger allocations get their own
+     */
+    explicit AlignedArena(size_t chunkSize = 1 << 20)
+        : chunkSize(chunkSize), current(0), offset(0) {}
+
+    AlignedArena(const AlignedArena&) = delete;
+    AlignedArena& operator=(const AlignedArena&) = delete;
+
+    ~AlignedArena() {
+        release();
+    }
+
+    /**
+     * @brief Arena of the calling thread
+     */
+    static inline AlignedArena& local() {
+        static thread_local AlignedArena arena;
+        return arena;
+    }
+
+    void* allocate(size_t bytes, size_t align) override {
+        if (align == 0 || bytes > std::numeric_limits<size_t>::max() - align) {
+            throw std::bad_alloc();
+        }
+        for (; current < chunks.size(); current++, offset = 0) {
+            void* p = fit(chunks[current], bytes, align);
+            if (p) {
+                return p;
+            }
+            // a chunk that is too small even when empty keeps its place
+            if (offset == 0) {
+                break;
+            }
+        }
+
+        // a new chunk goes before the remaining ones, so they stay usable
+        size_t size = bytes + align > chunkSize ? bytes + align : chunkSize;
+        Chunk chunk = {static_cast<char*>(Chunks::allocateBytes(size)), size};
+        chunks.insert(chunks.begin() + current, chunk);
+        offset = 0;
+        return fit(chunks[current], bytes, align);
+    }
+
+    /// Only gives memory back if p was the last allocation
+    void deallocate(void* p, size_t bytes, size_t) override {
+        if (current < chunks.size()
+            && static_cast<char*>(p) + bytes
+                   == chunks[current].data + offset) {
+            offset = static_cast<char*>(p) - chunks[current].data;
+        }
+    }
+
+    /**
+     * @brief Current position, to rewind() to later
+     */
+    inline Marker mark() const {
+        Marker marker = {current, offset};
+        return marker;
+    }
+
+    /**
+     * @brief Frees everything allocated after marker was taken
+     *
+     * @param marker earlier result of mark()
+     */
+    inline void rewind(const Marker& marker) {
+        current = marker.chunk;
+        offset = marker.offset;
+    }
+
+    /**
+     * @brief Frees all allocations in O(1), the chunks are kept
+     */
+    inline void reset() {
+        current = 0;
+        offset = 0;
+    }
+
+    /**
+     * @brief Frees all allocations and returns the chunks to the heap
+     */
+    inline void release() {
+        for (size_t i = 0; i < chunks.size(); i++) {
+            Chunks::deallocateBytes(chunks[i].data);
+        }
+        chunks.clear();
+        reset();
+    }
+
+    /// Total size of the chunks held
+    inline size_t capacity() const {
+        size_t total = 0;
+        for (size_t i = 0; i < chunks.size(); i++) {
+            total += chunks[i].size;
+        }
+        return total;
+    }
+
+  private:
+    typedef AlignedAllocator<char, ChunkAlign> Chunks;
+
+    struct Chunk {
+        char* data;
+        size_t size;
+    };
+
+    // allocates from chunk at offset, or returns nullptr if it's too small
+    inline void* fit(const Chunk& chunk, size_t bytes, size_t align) {
+        uintptr_t base = reinterpret_cast<uintptr_t>(chunk.data);
+        uintptr_t start = (base + offset + align - 1) / align * align;
+        if (start - base > chunk.size || chunk.size - (start - base) < bytes) {
+            return nullptr;
+        }
+        offset = start - base + bytes;
+        return reinterpret_cast<void*>(start);
+    }
+
+    size_t chunkSize;
+    std::vector<Chunk> chunks;
+    size_t current;
+    size_t offset;
+};
+
+/**
+ * @brief Owning pointer that aligns to boundary for fast load & store
+ *
+ * Values aren't constructed or destroyed, so T should be a plain type like
+ * float or int32_t. Can be moved but not copied. Memory comes from the
+ * heap, or from a MemoryResource which then has to outlive the storage
+ *
+ * @param T type of underlying data
+ * @param Align alignment in memory
+ */
+template <typename T, int Align>
+class AlignedStorage {
+  public:
+    /**
+     * @brief Allocates data, the values are uninitialized
+     *
+     * @param length amount of data to allocate (how many T's)
+     */
+    explicit AlignedStorage(size_t length)
+        : count(length), aligned(Allocator().allocate(length)),
+          resource(nullptr) {}
+
+    /**
+     * @brief Allocates data from resource, the values are uninitialized
+     *
+     * @param length amount of data to allocate (how many T's)
+     * @param resource where to allocate, ie. AlignedArena::local()
+     */
+    AlignedStorage(size_t length, MemoryResource& resource)
+        : count(length), aligned(allocate(length, &resource)),
+          resource(&resource) {}
+
+    inline AlignedStorage(AlignedStorage&& other)
+        : count(other.count), aligned(other.aligned),
+          resource(other.resource) {
+        other.count = 0;
+        other.aligned = nullptr;
+    }
+
+    inline AlignedStorage& operator=(AlignedStorage&& other) {
+        std::swap(count, other.count);
+        std::swap(aligned, other.aligned);
+        std::swap(resource, other.resource);
+        return *this;
+    }
+
+    AlignedStorage(const AlignedStorage&) = delete;
+    AlignedStorage& operator=(const AlignedStorage&) = delete;
+
+    inline ~AlignedStorage() {
+        deallocate(aligned, count, resource);
+    }
+
+    /// Length of allocated data
+    inline size_t length() const {
+        return count;
+    }
+
+    /**
+     * @brief Changes the length, keeping the values that still fit
+     *
+     * Added values are uninitialized. Pointers into the old data become
+     * invalid, unless the length didn't change
+     *
+     * @param length new amount of data (how many T's)
+     */
+    inline void resize(size_t length) {
+        if (length == count) {
+            return;
+        }
+        T* data = allocate(length, resource);
+        memcpy(data, aligned, (length < count ? length : count) * sizeof(T));
+        deallocate(aligned, count, resource);
+        aligned = data;
+        count = length;
+    }
+
+    /// Sets all data to 0
+    inline void clear() const {
+        memset(aligned, 0, count * sizeof(T));
+    }
+
+    /// Casts to a non-const pointer
+    inline operator T*() {
+        return aligned;
+    }
+
+    /// Casts to a const pointer
+    inline operator const T*() const {
+        return aligned;
+    }
+
+    /**
+     * @brief Returns an offset pointer
+     *
+     * @param i offset from main pointer
+     * @return pointer of data + i
+     */
+    inline T* operator+(ptrdiff_t i) {
+        return static_cast<T*>(aligned + i);
+    }
+
+    /**
+     * @brief Returns an offset const pointer
+     *
+     * @param i offset from main pointer
+     * @return pointer of data + i
+     */
+    inline const T* operator+(ptrdiff_t i) const {
+        return static_cast<const T*>(aligned + i);
+    }
+
+    /**
+     * @brief Returns an offset pointer
+     *
+     * @param i offset from main pointer
+     * @return pointer of data - i
+     */
+    inline T* operator-(ptrdiff_t i) {
+        return aligned - i;
+    }
+
+    /**
+     * @brief Returns an offset const pointer
+     *
+     * @param i offset from main pointer
+     * @return pointer of data - i
+     */
+    inline const T* operator-(ptrdiff_t i) const {
+        return aligned - i;
+    }
+
+    /**
+     * @brief Returns data at an index
+     *
+     * @param i index of data
+     * @return writable reference to data
+     */
+    inline T& operator[](size_t i) {
+        return aligned[i];
+    }
+
+    /**
+     * @brief Returns data at an index
+     *
+     * @param i index of data
+     * @return data found at index
+     */
+    inline const T& operator[](size_t i) const {
+        return aligned[i];
+    }
+
+    /**
+     * @brief Returns data at an index, with a bounds check
+     *
+     * @param i index of data
+     * @return writable reference to data
+     */
+    inline T& at(size_t i) {
+        if (i >= count) {
+            throw std::out_of_range("outside of aligned storage boundary");
+        }
+        return aligned[i];
+    }
+
+    /**
+     * @brief Returns data at an index, with a bounds check
+     *
+     * @param i index of data
+     * @return data found at index
+     */
+    inline const T& at(size_t i) const {
+        if (i >= count) {
+            throw std::out_of_range("outside of aligned storage boundary");
+        }
+        return aligned[i];
+    }
+
+  private:
+    typedef AlignedAllocator<T, Align> Allocator;
+
+    static inline T* allocate(size_t length, MemoryResource* resource) {
+        if (!resource) {
+            return Allocator().allocate(length);
+        }
+        if (length > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(resource->allocate(length * sizeof(T), Align));
+    }
+
+    static inline void deallocate(T* p, size_t length,
+                                  MemoryResource* resource) {
+        if (!resource) {
+            Allocator().deallocate(p, length);
+        } else if (p) {
+            resource->deallocate(p, length * sizeof(T), Align);
+        }
+    }
+
+    size_t count;
+    T* aligned;
+    MemoryResource* resource;
+};
+
+/// Cache levels a prefetch() pulls data into
+enum class Hint : int {
+    NTA,  // close to the core, but evicted first (data used once)
+    T2,   // last level cache
+    T1,   // L2 and up
+    T0    // every level
+};
+
+/**
+ * @brief Starts loading the cache line at p + distance
+ *
+ * Only a hint, it never faults, even for invalid addresses. Sequential
+ * access is already prefetched by the hardware, this helps with strided or
+ * indirect access, fetching distance values ahead of the current one
+ *
+ * @param H cache levels to fetch into
+ * @param p current position
+ * @param distance how many T's ahead of p to fetch
+ */
+template <Hint H = Hint::T0, typename T>
+inline void prefetch(const T* p, ptrdiff_t distance = 0) {
+    // the hints match the locality argument, 0 (none) to 3 (high)
+    __builtin_prefetch(p + distance, 0, static_cast<int>(H));
+}
+
+/**
+ * @brief Orders earlier streaming stores before any later store
+ *
+ * Vect::stream() stores are weakly ordered, call this once after a loop of
+ * them, before the results are handed to another thread
+ */
+inline void streamFence() {
+    #if defined(__x86_64__) || defined(__i386__)
+    _mm_sfence();
+    #else
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    #endif
+}
+
+/**
+ * @brief Checks if a pointer is properly aligned to a boundary
+ *
+ * @param Align alignment of pointer
+ * @param T type of data to be used
+ * @param ptr pointer to data you want to be aligned
+ * @return if ptr is aligned to Align (ie. ptr % Align == 0)
+ */
+template <int Align, typename T>
+inline bool isAligned(const T* ptr) {
+    return reinterpret_cast<uintptr_t>(ptr) % Align == 0;
+}
+
+/**
+ * @brief Checks if there is enough room in length for M more elements
+ *
+ * @param M elements in a "leap"
+ * @param index current index inside of length
+ * @param length total length
+ * @return index + M <= length
+ */
+template <int M>
+inline bool room(size_t index, size_t length) {
+    return index + M <= length;
+}
+
+}  // namespace sight
@@ -0,0 +1,1604 @@
+#pragma once
+
+#include "simd.hpp"
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+/*
+ * Vect128i, Vect128f and Mask128 on AArch64 NEON, with the same interface
+ * and results as simd_128.hpp, so everything written against them (or
+ * against Vect<T, N> and NativeVect) compiles unchanged.
+ *
+ * Where the instructions differ from SSE the x86 results win: comparisons
+ * and min / max treat NaN like SSE does, to_int() gives INT32_MIN for
+ * values that don't fit, and shifts of 32 bits or more give 0 (or the
+ * sign). There are no non-temporal store intrinsics, so stream() is a
+ * normal store.
+ */
+
+namespace sight {
+using Vect128i = Vect<int32_t, 4>;
+using Vect128f = Vect<float, 4>;
+
+namespace detail {
+
+/// load_partial() through a zeroed buffer, NEON has no masked loads
+template <typename V, typename T>
+inline V loadPartial(const T* p, int n) {
+    alignas(V) T buf[V::lanes] = {};
+    memcpy(buf, p, n * sizeof(T));
+    return V::load(buf);
+}
+
+/// store_partial() through a buffer, NEON has no masked stores
+template <typename V, typename T>
+inline void storePartial(const V& v, T* p, int n) {
+    alignas(V) T buf[V::lanes];
+    v.store(buf);
+    memcpy(p, buf, n * sizeof(T));
+}
+
+/// Shuffles lanes with indices known at compile time
+template <int A, int B, int C, int D, typename N>
+inline N shuffleLanes(N v, N v2) {
+    #ifdef __clang__
+    return __builtin_shufflevector(v, v2, A, B, C, D);
+    #else
+    const uint32x4_t lanes = {A, B, C, D};
+    return __builtin_shuffle(v, v2, lanes);
+    #endif
+}
+
+}  // namespace detail
+
+/**
+ * @brief 128 bit vector of int32
+ */
+template <>
+class Vect<int32_t, 4> {
+  private:
+    int32x4_t val;
+
+  public:
+    /// Type of each lane
+    typedef int32_t value_type;
+
+    /// Number of lanes in the vector
+    enum { lanes = 4 };
+
+    /**
+     * @brief Empty vector
+     */
+    inline Vect() {}
+
+    /**
+     * @brief Fill vector with i
+     *
+     * @param i value to set every entry to
+     */
+    inline explicit Vect(int32_t i) {
+        val = vdupq_n_s32(i);
+    }
+
+    /**
+     * @brief Convert native int32x4_t to abstract Vect128i
+     *
+     * @param v vector to use
+     */
+    inline Vect(int32x4_t v) : val(v) {}  // NOLINT(runtime/explicit)
+
+    /**
+     * @brief Fill vector with values
+     *
+     * @param i0, i1, i2, i3 values to use
+     */
+    inline Vect(int32_t i0, int32_t i1, int32_t i2, int32_t i3) {
+        const int32_t values[4] = {i0, i1, i2, i3};
+        val = vld1q_s32(values);
+    }
+
+    /**
+     * @brief Access value directly
+     *
+     * Be aware that this method does not do bounds checking, and that it is
+     * probably the most inefficient way to do anything - only use for
+     * debugging
+     *
+     * @param idx index in vector
+     */
+    inline int32_t operator[](unsigned int idx) const {
+        int32_t array[4];
+        storeu(array);
+        return array[idx];
+    }
+
+    /**
+     * @brief Loads vector values from an arbitrary point
+     *
+     * NEON loads don't care about alignment, this is the same as load()
+     *
+     * @param p loads 128 bits starting at p
+     */
+    static inline Vect128i loadu(const int32_t* p) {
+        SIGHT_COUNT(UnalignedLoad);
+        return vld1q_s32(p);
+    }
+
+    /**
+     * @brief Loads vector values from an aligned pointer in memory
+     *
+     * @param p loads 128 bits starting at p
+     */
+    static inline Vect128i load(const int32_t* p) {
+        SIGHT_COUNT(AlignedLoad);
+        return vld1q_s32(p);
+    }
+
+    /**
+     * @brief Loads the first n values from p, the other lanes are 0
+     *
+     * Nothing past p + n is read, so this is safe at the end of an array
+     *
+     * @param p values to load, no alignment needed
+     * @param n amount of values, 0 to 4
+     */
+    static inline Vect128i load_partial(const int32_t* p, int n) {
+        SIGHT_COUNT(PartialLoad);
+        return detail::loadPartial<Vect128i>(p, n);
+    }
+
+    /**
+     * @brief Inserts the vector in a point in memory
+     *
+     * NEON stores don't care about alignment, this is the same as store()
+     *
+     * @param p stores 128 bits starting at p
+     */
+    inline void storeu(int32_t* p) const {
+        SIGHT_COUNT(UnalignedStore);
+        vst1q_s32(p, val);
+    }
+
+    /**
+     * @brief Inserts this vector in a aligned point in memory
+     *
+     * @param p stores 128 bits starting at p
+     */
+    inline void store(int32_t* p) const {
+        SIGHT_COUNT(AlignedStore);
+        vst1q_s32(p, val);
+    }
+
+    /**
+     * @brief Inserts this vector in a aligned point in memory
+     *
+     * NEON has no non-temporal store intrinsic, so this goes through the
+     * cache like store()
+     *
+     * @param p stores 128 bits starting at p
+     */
+    inline void stream(int32_t* p) const {
+        SIGHT_COUNT(StreamStore);
+        vst1q_s32(p, val);
+    }
+
+    /**
+     * @brief Stores the first n values to p
+     *
+     * Nothing past p + n is written, so this is safe at the end of an array
+     *
+     * @param p where to store, no alignment needed
+     * @param n amount of values, 0 to 4
+     */
+    inline void store_partial(int32_t* p, int n) const {
+        SIGHT_COUNT(PartialStore);
+        detail::storePartial(*this, p, n);
+    }
+
+    /**
+     * @brief Sets vector values to native int32x4_t
+     *
+     * @param v vector to use
+     */
+    inline void operator=(int32x4_t v) {
+        val = v;
+    }
+
+    /**
+     * @brief Converts to a native int32x4_t
+     */
+    inline operator int32x4_t() const {
+        return val;
+    }
+
+    /**
+     * @brief Converts to a floating point representation
+     */
+    inline operator Vect128f() const;
+
+    /**
+     * @brief Performs NOT (r[i] = ~this[i])
+     */
+    inline Vect128i operator~() const {
+        return vmvnq_s32(val);
+    }
+
+    /**
+     * @brief Adds vectors together (r[i] = this[i] + v[i])
+     *
+     * @param v vector to add
+     */
+    inline Vect128i operator+(const Vect128i& v) const {
+        return vaddq_s32(val, v);
+    }
+
+    /**
+     * @brief Subtracts vector (r[i] = this[i] - v[i])
+     *
+     * @param v vector to subtract
+     */
+    inline Vect128i operator-(const Vect128i& v) const {
+        return vsubq_s32(val, v);
+    }
+
+    /**
+     * @brief Multiplies vectors together (r[i] = this[i] * v[i])
+     *
+     * @param v vector to multiply
+     */
+    inline Vect128i operator*(const Vect128i& v) const {
+        return vmulq_s32(val, v);
+    }
+
+    /**
+     * @brief Performs AND comparison (r[i] = this[i] & v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect128i operator&(const Vect128i& v) const {
+        return vandq_s32(val, v);
+    }
+
+    /**
+     * @brief Performs OR comparison (r[i] = this[i] | v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect128i operator|(const Vect128i& v) const {
+        return vorrq_s32(val, v);
+    }
+
+    /**
+     * @brief Performs XOR comparison (r[i] = this[i] ^ v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect128i operator^(const Vect128i& v) const {
+        return veorq_s32(val, v);
+    }
+
+    /**
+     * @brief Performs less-than comparison (r[i] = this[i] < v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect128i operator<(const Vect128i& v) const {
+        return vreinterpretq_s32_u32(vcltq_s32(val, v));
+    }
+
+    /**
+     * @brief Performs less-than-or-equal-to comparison (r[i] = this[i] <= v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect128i operator<=(const Vect128i& v) const {
+        return vreinterpretq_s32_u32(vcleq_s32(val, v));
+    }
+
+    /**
+     * @brief Performs larger-than comparison (r[i] = this[i] > v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect128i operator>(const Vect128i& v) const {
+        return vreinterpretq_s32_u32(vcgtq_s32(val, v));
+    }
+
+    /**
+     * @brief Performs greater-than-or-equal-to comparison
+     * (r[i] = this[i] >= v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect128i operator>=(const Vect128i& v) const {
+        return vreinterpretq_s32_u32(vcgeq_s32(val, v));
+    }
+
+    /**
+     * @brief Performs equal-to comparison (r[i] = this[i] == v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect128i operator==(const Vect128i& v) const {
+        return vreinterpretq_s32_u32(vceqq_s32(val, v));
+    }
+
+    /**
+     * @brief Performs not-equal-to comparison (r[i] = this[i] != v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect128i operator!=(const Vect128i& v) const {
+        return ~(operator==(v));
+    }
+
+    /**
+     * @brief Add vector (this[i] = this[i] + v[i])
+     *
+     * @param v vector to add
+     */
+    inline void operator+=(const Vect128i& v) {
+        val = operator+(v);
+    }
+
+    /**
+     * @brief Subtracts vector (this[i] = this[i] - v[i])
+     *
+     * @param v vector to subtract
+     */
+    inline void operator-=(const Vect128i& v) {
+        val = operator-(v);
+    }
+
+    /**
+     * @brief Multiples vector (this[i] = this[i] * v[i])
+     *
+     * @param v vector to multiply
+     */
+    inline void operator*=(const Vect128i& v) {
+        val = operator*(v);
+    }
+
+    /**
+     * @brief AND operation with vector (this[i] = this[i] & v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator&=(const Vect128i& v) {
+        val = operator&(v);
+    }
+
+    /**
+     * @brief OR operation with vector (this[i] = this[i] | v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator|=(const Vect128i& v) {
+        val = operator|(v);
+    }
+
+    /**
+     * @brief XOR operation with vector (this[i] = this[i] ^ v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator^=(const Vect128i& v) {
+        val = operator^(v);
+    }
+};
+
+/**
+ * @brief 128 bit vector of float32
+ */
+template <>
+class Vect<float, 4> {
+  private:
+    float32x4_t val;
+
+    /// Applies a bitwise operation to the bits of two vectors
+    template <uint32x4_t (*Op)(uint32x4_t, uint32x4_t)>
+    inline Vect128f bitwise(const Vect128f& v) const {
+        return vreinterpretq_f32_u32(
+            Op(vreinterpretq_u32_f32(val), vreinterpretq_u32_f32(v)));
+    }
+
+    static inline uint32x4_t andBits(uint32x4_t a, uint32x4_t b) {
+        return vandq_u32(a, b);
+    }
+    static inline uint32x4_t orBits(uint32x4_t a, uint32x4_t b) {
+        return vorrq_u32(a, b);
+    }
+    static inline uint32x4_t xorBits(uint32x4_t a, uint32x4_t b) {
+        return veorq_u32(a, b);
+    }
+
+  public:
+    /// Type of each lane
+    typedef float value_type;
+
+    /// Number of lanes in the vector
+    enum { lanes = 4 };
+
+    /**
+     * @brief Empty vector
+     */
+    inline Vect() {}
+
+    /**
+     * @brief Fill vector with i
+     *
+     * @param i value to set every entry to
+     */
+    inline explicit Vect(float i) {
+        val = vdupq_n_f32(i);
+    }
+
+    /**
+     * @brief Convert native float32x4_t to abstract Vect128f
+     *
+     * @param v vector to use
+     */
+    inline Vect(float32x4_t v) : val(v) {}  // NOLINT(runtime/explicit)
+
+    /**
+     * @brief Fill vector with values
+     *
+     * @param i0, i1, i2, i3 values to use
+     */
+    inline Vect(float i0, float i1, float i2, float i3) {
+        const float values[4] = {i0, i1, i2, i3};
+        val = vld1q_f32(values);
+    }
+
+    /**
+     * @brief Access value directly
+     *
+     * Be aware that this method does not do bounds checking, and that it is
+     * probably the most inefficient way to do anything - only use for
+     * debugging
+     *
+     * @param idx index in vector
+     */
+    inline float operator[](unsigned int idx) const {
+        float array[4];
+        storeu(array);
+        return array[idx];
+    }
+
+    /**
+     * @brief Loads vector values from an arbitrary point
+     *
+     * NEON loads don't care about alignment, this is the same as load()
+     *
+     * @param p loads 128 bits starting at p
+     */
+    static inline Vect128f loadu(const float* p) {
+        SIGHT_COUNT(UnalignedLoad);
+        return vld1q_f32(p);
+    }
+
+    /**
+     * @brief Loads vector values from an aligned pointer in memory
+     *
+     * @param p loads 128 bits starting at p
+     */
+    static inline Vect128f load(const float* p) {
+        SIGHT_COUNT(AlignedLoad);
+        return vld1q_f32(p);
+    }
+
+    /**
+     * @brief Loads the first n values from p, the other lanes are 0
+     *
+     * Nothing past p + n is read, so this is safe at the end of an array
+     *
+     * @param p values to load, no alignment needed
+     * @param n amount of values, 0 to 4
+     */
+    static inline Vect128f load_partial(const float* p, int n) {
+        SIGHT_COUNT(PartialLoad);
+        return detail::loadPartial<Vect128f>(p, n);
+    }
+
+    /**
+     * @brief Inserts the vector in a point in memory
+     *
+     * NEON stores don't care about alignment, this is the same as store()
+     *
+     * @param p stores 128 bits starting at p
+     */
+    inline void storeu(float* p) const {
+        SIGHT_COUNT(UnalignedStore);
+        vst1q_f32(p, val);
+    }
+
+    /**
+     * @brief Inserts this vector in a aligned point in memory
+     *
+     * @param p stores 128 bits starting at p
+     */
+    inline void store(float* p) const {
+        SIGHT_COUNT(AlignedStore);
+        vst1q_f32(p, val);
+    }
+
+    /**
+     * @brief Inserts this vector in a aligned point in memory
+     *
+     * NEON has no non-temporal store intrinsic, so this goes through the
+     * cache like store()
+     *
+     * @param p stores 128 bits starting at p
+     */
+    inline void stream(float* p) const {
+        SIGHT_COUNT(StreamStore);
+        vst1q_f32(p, val);
+    }
+
+    /**
+     * @brief Stores the first n values to p
+     *
+     * Nothing past p + n is written, so this is safe at the end of an array
+     *
+     * @param p where to store, no alignment needed
+     * @param n amount of values, 0 to 4
+     */
+    inline void store_partial(float* p, int n) const {
+        SIGHT_COUNT(PartialStore);
+        detail::storePartial(*this, p, n);
+    }
+
+    /**
+     * @brief Sets vector values to native float32x4_t
+     *
+     * @param v vector to use
+     */
+    inline void operator=(float32x4_t v) {
+        val = v;
+    }
+
+    /**
+     * @brief Converts to a native float32x4_t
+     */
+    inline operator float32x4_t() const {
+        return val;
+    }
+
+    /**
+     * @brief Converts to a integer representation (truncating towards zero,
+     * INT32_MIN when out of range)
+     */
+    inline Vect128i to_int() const;
+
+    /**
+     * @brief Performs NOT (r[i] = ~this[i])
+     */
+    inline Vect128f operator~() const {
+        return vreinterpretq_f32_u32(vmvnq_u32(vreinterpretq_u32_f32(val)));
+    }
+
+    /**
+     * @brief Adds vectors together (r[i] = this[i] + v[i])
+     *
+     * @param v vector to add
+     */
+    inline Vect128f operator+(const Vect128f& v) const {
+        return vaddq_f32(val, v);
+    }
+
+    /**
+     * @brief Subtracts vector (r[i] = this[i] - v[i])
+     *
+     * @param v vector to subtract
+     */
+    inline Vect128f operator-(const Vect128f& v) const {
+        return vsubq_f32(val, v);
+    }
+
+    /**
+     * @brief Multiplies vectors together (r[i] = this[i] * v[i])
+     *
+     * @param v vector to multiply
+     */
+    inline Vect128f operator*(const Vect128f& v) const {
+        return vmulq_f32(val, v);
+    }
+
+    /**
+     * @brief Divides vector (r[i] = this[i] / v[i])
+     *
+     * @param v vector to divide by
+     */
+    inline Vect128f operator/(const Vect128f& v) const {
+        return vdivq_f32(val, v);
+    }
+
+    /**
+     * @brief Performs AND comparison (r[i] = this[i] & v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect128f operator&(const Vect128f& v) const {
+        return bitwise<andBits>(v);
+    }
+
+    /**
+     * @brief Performs OR comparison (r[i] = this[i] | v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect128f operator|(const Vect128f& v) const {
+        return bitwise<orBits>(v);
+    }
+
+    /**
+     * @brief Performs XOR comparison (r[i] = this[i] ^ v[i])
+     *
+     * @param v vector to perform comparison with
+     */
+    inline Vect128f operator^(const Vect128f& v) const {
+        return bitwise<xorBits>(v);
+    }
+
+    /**
+     * @brief Performs less-than comparison (r[i] = this[i] < v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect128f operator<(const Vect128f& v) const {
+        return vreinterpretq_f32_u32(vcltq_f32(val, v));
+    }
+
+    /**
+     * @brief Performs less-than-or-equal-to comparison (r[i] = this[i] <= v[i])
+     *
+     * True for NaN, like _mm_cmpngt_ps
+     *
+     * @param v vector to compare
+     */
+    inline Vect128f operator<=(const Vect128f& v) const {
+        return ~(operator>(v));
+    }
+
+    /**
+     * @brief Performs larger-than comparison (r[i] = this[i] > v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect128f operator>(const Vect128f& v) const {
+        return vreinterpretq_f32_u32(vcgtq_f32(val, v));
+    }
+
+    /**
+     * @brief Performs greater-than-or-equal-to comparison
+     * (r[i] = this[i] >= v[i])
+     *
+     * True for NaN, like _mm_cmpnlt_ps
+     *
+     * @param v vector to compare
+     */
+    inline Vect128f operator>=(const Vect128f& v) const {
+        return ~(operator<(v));
+    }
+
+    /**
+     * @brief Performs equal-to comparison (r[i] = this[i] == v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect128f operator==(const Vect128f& v) const {
+        return vreinterpretq_f32_u32(vceqq_f32(val, v));
+    }
+
+    /**
+     * @brief Performs not-equal-to comparison (r[i] = this[i] != v[i])
+     *
+     * @param v vector to compare
+     */
+    inline Vect128f operator!=(const Vect128f& v) const {
+        return ~(operator==(v));
+    }
+
+    /**
+     * @brief Add vector (this[i] = this[i] + v[i])
+     *
+     * @param v vector to add
+     */
+    inline void operator+=(const Vect128f& v) {
+        val = operator+(v);
+    }
+
+    /**
+     * @brief Subtracts vector (this[i] = this[i] - v[i])
+     *
+     * @param v vector to subtract
+     */
+    inline void operator-=(const Vect128f& v) {
+        val = operator-(v);
+    }
+
+    /**
+     * @brief Multiples vector (this[i] = this[i] * v[i])
+     *
+     * @param v vector to multiply
+     */
+    inline void operator*=(const Vect128f& v) {
+        val = operator*(v);
+    }
+
+    /**
+     * @brief AND operation with vector (this[i] = this[i] & v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator&=(const Vect128f& v) {
+        val = operator&(v);
+    }
+
+    /**
+     * @brief OR operation with vector (this[i] = this[i] | v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator|=(const Vect128f& v) {
+        val = operator|(v);
+    }
+
+    /**
+     * @brief XOR operation with vector (this[i] = this[i] ^ v[i])
+     *
+     * @param v vector to use
+     */
+    inline void operator^=(const Vect128f& v) {
+        val = operator^(v);
+    }
+};
+
+/**
+ * @brief Lane mask for 128 bit vectors
+ *
+ * Comparisons return vectors with all ones in the lanes that match, those
+ * convert to a Mask128 implicitly, so select(a < b, a, b) or any(v == v2)
+ * work without spelling out the mask
+ */
+class Mask128 {
+  private:
+    uint32x4_t val;
+
+  public:
+    /**
+     * @brief Empty mask
+     */
+    inline Mask128() {}
+
+    /**
+     * @brief Convert native uint32x4_t lanes (all ones or zeros) to Mask128
+     *
+     * @param m mask to use
+     */
+    inline Mask128(uint32x4_t m) : val(m) {}  // NOLINT(runtime/explicit)
+
+    /**
+     * @brief Use the result of a float comparison as a mask
+     *
+     * @param v vector with every lane all ones or all zeros
+     */
+    inline Mask128(const Vect128f& v)  // NOLINT(runtime/explicit)
+        : val(vreinterpretq_u32_f32(v)) {}
+
+    /**
+     * @brief Use the result of an integer comparison as a mask
+     *
+     * @param v vector with every lane all ones or all zeros
+     */
+    inline Mask128(const Vect128i& v)  // NOLINT(runtime/explicit)
+        : val(vreinterpretq_u32_s32(v)) {}
+
+    /**
+     * @brief Converts to a native uint32x4_t
+     */
+    inline operator uint32x4_t() const {
+        return val;
+    }
+
+    /**
+     * @brief Bits of the mask, lane i is bit i
+     *
+     * Made of the sign bit of each lane, like _mm_movemask_ps
+     */
+    inline uint32_t bits() const {
+        const int32_t positions[4] = {0, 1, 2, 3};
+        return vaddvq_u32(
+            vshlq_u32(vshrq_n_u32(val, 31), vld1q_s32(positions)));
+    }
+
+    /**
+     * @brief Checks whether a lane is set
+     *
+     * @param idx index in vector
+     */
+    inline bool operator[](unsigned int idx) const {
+        return (bits() >> idx) & 1;
+    }
+
+    /**
+     * @brief Performs NOT (r[i] = !this[i])
+     */
+    inline Mask128 operator~() const {
+        return vmvnq_u32(val);
+    }
+
+    /**
+     * @brief Performs AND (r[i] = this[i] & m[i])
+     *
+     * @param m mask to use
+     */
+    inline Mask128 operator&(const Mask128& m) const {
+        return vandq_u32(val, m.val);
+    }
+
+    /**
+     * @brief Performs OR (r[i] = this[i] | m[i])
+     *
+     * @param m mask to use
+     */
+    inline Mask128 operator|(const Mask128& m) const {
+        return vorrq_u32(val, m.val);
+    }
+
+    /**
+     * @brief Performs XOR (r[i] = this[i] ^ m[i])
+     *
+     * @param m mask to use
+     */
+    inline Mask128 operator^(const Mask128& m) const {
+        return veorq_u32(val, m.val);
+    }
+};
+
+Vect128i::operator Vect128f() const {
+    return vcvtq_f32_s32(val);
+}
+
+Vect128i Vect128f::to_int() const {
+    // NEON saturates and turns NaN into 0, SSE gives INT32_MIN for both
+    uint32x4_t fits = vcaltq_f32(val, vdupq_n_f32(2147483648.0f));
+    return vbslq_s32(fits, vcvtq_s32_f32(val), vdupq_n_s32(INT32_MIN));
+}
+
+/**
+ * @brief Reinterprets the bits of a float vector as int32
+ *
+ * Unlike to_int() nothing is converted, ie. 1.0f gives 0x3F800000
+ *
+ * @param v vector to reinterpret
+ */
+inline Vect128i as_int(const Vect128f& v) {
+    return vreinterpretq_s32_f32(v);
+}
+
+/**
+ * @brief Reinterprets the bits of an int32 vector as float
+ *
+ * Unlike the Vect128i to Vect128f conversion nothing is converted, ie.
+ * 0x3F800000 gives 1.0f
+ *
+ * @param v vector to reinterpret
+ */
+inline Vect128f as_float(const Vect128i& v) {
+    return vreinterpretq_f32_s32(v);
+}
+
+/**
+ * @brief Returns lowest of each value
+ *
+ * @param v first vector
+ * @param v2 second vector
+ * @return minimum of v[i] and v2[i]
+ */
+inline Vect128i lowest(const Vect128i& v, const Vect128i& v2) {
+    return vminq_s32(v, v2);
+}
+
+/**
+ * @brief Returns lowest of each value
+ *
+ * Gives v2[i] when either one is NaN, like _mm_min_ps (vminq_f32 would
+ * return the NaN)
+ *
+ * @param v first vector
+ * @param v2 second vector
+ * @return minimum of v[i] and v2[i]
+ */
+inline Vect128f lowest(const Vect128f& v, const Vect128f& v2) {
+    return vbslq_f32(vcltq_f32(v, v2), v, v2);
+}
+
+/**
+ * @brief Returns highest of each value
+ *
+ * @param v first vector
+ * @param v2 second vector
+ * @return maximum of v[i] and v2[i]
+ */
+inline Vect128i highest(const Vect128i& v, const Vect128i& v2) {
+    return vmaxq_s32(v, v2);
+}
+
+/**
+ * @brief Returns highest of each value
+ *
+ * Gives v2[i] when either one is NaN, like _mm_max_ps
+ *
+ * @param v first vector
+ * @param v2 second vector
+ * @return maximum of v[i] and v2[i]
+ */
+inline Vect128f highest(const Vect128f& v, const Vect128f& v2) {
+    return vbslq_f32(vcgtq_f32(v, v2), v, v2);
+}
+
+/**
+ * @brief Rounds each value to the closest integer, ties to even
+ *
+ * Like std::nearbyint in the default rounding mode, ie. 2.5 gives 2 and
+ * -0.4 gives -0
+ *
+ * @param v vector of values to round
+ */
+inline Vect128f round_nearest(const Vect128f& v) {
+    return vrndnq_f32(v);
+}
+
+/**
+ * @brief Rounds each value towards zero (like std::trunc)
+ *
+ * @param v vector of values to round
+ */
+inline Vect128f trunc(const Vect128f& v) {
+    return vrndq_f32(v);
+}
+
+/**
+ * @brief Rounds each value down (like std::floor)
+ *
+ * @param v vector of values to round
+ */
+inline Vect128f floor(const Vect128f& v) {
+    return vrndmq_f32(v);
+}
+
+/**
+ * @brief Rounds each value up (like std::ceil), ie. -0.5 gives -0
+ *
+ * @param v vector of values to round
+ */
+inline Vect128f ceil(const Vect128f& v) {
+    return vrndpq_f32(v);
+}
+
+/**
+ * @brief Converts to int32, ties to even
+ *
+ * Faster than round(), values outside of the int32 range and NaN give
+ * INT32_MIN like to_int()
+ *
+ * @param v vector of values to convert
+ */
+inline Vect128i to_int_nearest(const Vect128f& v) {
+    uint32x4_t fits = vcaltq_f32(v, vdupq_n_f32(2147483648.0f));
+    return vbslq_s32(fits, vcvtnq_s32_f32(v), vdupq_n_s32(INT32_MIN));
+}
+
+/**
+ * @brief The reciprocal square root of values in a vector
+ *
+ * The NEON estimate only has 8 bits, one step brings it past the 12 bits
+ * of _mm_rsqrt_ps
+ *
+ * @param v starting values
+ * @return 1 / sqrt(v[i])
+ */
+inline Vect128f rsqrt(const Vect128f& v) {
+    float32x4_t y = vrsqrteq_f32(v);
+    // y * y first, 0 * inf would turn rsqrt(0) into NaN
+    return vmulq_f32(y, vrsqrtsq_f32(vmulq_f32(y, y), v));
+}
+
+/**
+ * @brief The reciprocal of values in a vector
+ *
+ * The NEON estimate only has 8 bits, one step brings it past the 12 bits
+ * of _mm_rcp_ps
+ *
+ * @param v starting values
+ * @return 1 / v[i]
+ */
+inline Vect128f reciprocal(const Vect128f& v) {
+    float32x4_t y = vrecpeq_f32(v);
+    return vmulq_f32(y, vrecpsq_f32(v, y));
+}
+
+/**
+ * @brief The square root of values in a vector
+ *
+ * This method isn't guaranteed to be accurate, see sqrt_precise()
+ *
+ * @param v starting values
+ * @return the square root of v[i]
+ */
+inline Vect128f sqrt(const Vect128f& v) {
+    return reciprocal(rsqrt(v));
+}
+
+/**
+ * @brief Fused multiply-add (r[i] = a[i] * b[i] + c[i])
+ *
+ * Always rounds once, every AArch64 CPU has FMA
+ *
+ * @param a, b values to multiply
+ * @param c value to add (or subtract)
+ */
+inline Vect128f fma(const Vect128f& a, const Vect128f& b,
+                    const Vect128f& c) {
+    return vfmaq_f32(c, a, b);
+}
+
+/**
+ * @brief Fused multiply-subtract (r[i] = a[i] * b[i] - c[i])
+ *
+ * @param a, b values to multiply
+ * @param c value to add (or subtract)
+ */
+inline Vect128f fms(const Vect128f& a, const Vect128f& b,
+                    const Vect128f& c) {
+    return vnegq_f32(vfmsq_f32(c, a, b));
+}
+
+/**
+ * @brief Fused negated multiply-add (r[i] = c[i] - a[i] * b[i])
+ *
+ * @param a, b values to multiply
+ * @param c value to add (or subtract)
+ */
+inline Vect128f fnma(const Vect128f& a, const Vect128f& b,
+                     const Vect128f& c) {
+    return vfmsq_f32(c, a, b);
+}
+
+/**
+ * @brief The square root of values in a vector, correctly rounded
+ *
+ * Uses the native square root instruction, which is slower than sqrt()
+ *
+ * @param v starting values
+ * @return the square root of v[i]
+ */
+inline Vect128f sqrt_precise(const Vect128f& v) {
+    return vsqrtq_f32(v);
+}
+
+/**
+ * @brief The reciprocal square root of values in a vector, correctly rounded
+ *
+ * Uses the native square root and divide instructions
+ *
+ * @param v starting values
+ * @return 1 / sqrt(v[i])
+ */
+inline Vect128f rsqrt_precise(const Vect128f& v) {
+    return Vect128f(1) / sqrt_precise(v);
+}
+
+/**
+ * @brief The reciprocal of values in a vector, correctly rounded
+ *
+ * Uses the native divide instruction
+ *
+ * @param v starting values
+ * @return 1 / v[i]
+ */
+inline Vect128f reciprocal_precise(const Vect128f& v) {
+    return Vect128f(1) / v;
+}
+
+/**
+ * @brief The reciprocal square root of values in a vector, refined once
+ *
+ * One Newton-Raphson step on top of rsqrt(), which gets close to full float
+ * precision for much less than a square root and divide. 0 and infinity
+ * give NaN, use rsqrt_precise() if those can happen
+ *
+ * @param v starting values
+ * @return 1 / sqrt(v[i])
+ */
+inline Vect128f rsqrt_refined(const Vect128f& v) {
+    Vect128f y = rsqrt(v);
+    Vect128f half_y = Vect128f(0.5) * y;
+    return half_y * fnma(v * y, y, Vect128f(3));
+}
+
+/**
+ * @brief The reciprocal of values in a vector, refined once
+ *
+ * One Newton-Raphson step on top of reciprocal(), which gets close to full
+ * float precision for much less than a divide. 0 and infinity give NaN, use
+ * reciprocal_precise() if those can happen
+ *
+ * @param v starting values
+ * @return 1 / v[i]
+ */
+inline Vect128f reciprocal_refined(const Vect128f& v) {
+    Vect128f y = reciprocal(v);
+    return fma(y, fnma(v, y, Vect128f(1)), y);
+}
+
+/**
+ * @brief Reads one value of a vector without going through memory
+ *
+ * @param I index in vector (0 - 3)
+ * @param v vector to read from
+ * @return v[I]
+ */
+template <int I>
+inline int32_t extract(const Vect128i& v) {
+    static_assert(I >= 0 && I < 4, "index outside of vector");
+    return vgetq_lane_s32(v, I);
+}
+
+/**
+ * @brief Reads one value of a vector without going through memory
+ *
+ * @param I index in vector (0 - 3)
+ * @param v vector to read from
+ * @return v[I]
+ */
+template <int I>
+inline float extract(const Vect128f& v) {
+    static_assert(I >= 0 && I < 4, "index outside of vector");
+    return vgetq_lane_f32(v, I);
+}
+
+/**
+ * @brief Adds every value of a vector together
+ *
+ * @param v values to add
+ * @return v[0] + v[1] + v[2] + v[3]
+ */
+inline int32_t hsum(const Vect128i& v) {
+    return vaddvq_s32(v);
+}
+
+/**
+ * @brief Adds every value of a vector together
+ *
+ * Pairwise, (v[0] + v[1]) + (v[2] + v[3]), the same order as on x86
+ *
+ * @param v values to add
+ * @return v[0] + v[1] + v[2] + v[3]
+ */
+inline float hsum(const Vect128f& v) {
+    return vaddvq_f32(v);
+}
+
+/**
+ * @brief Lowest value of a vector
+ *
+ * @param v values to compare
+ * @return minimum of v[0], v[1], v[2] and v[3]
+ */
+inline int32_t hmin(const Vect128i& v) {
+    return vminvq_s32(v);
+}
+
+/**
+ * @brief Lowest value of a vector
+ *
+ * Goes through lowest(), so NaN lanes behave like on x86
+ *
+ * @param v values to compare
+ * @return minimum of v[0], v[1], v[2] and v[3]
+ */
+inline float hmin(const Vect128f& v) {
+    Vect128f mins = lowest(v, Vect128f(vrev64q_f32(v)));
+    return extract<0>(lowest(mins, Vect128f(vextq_f32(mins, mins, 2))));
+}
+
+/**
+ * @brief Highest value of a vector
+ *
+ * @param v values to compare
+ * @return maximum of v[0], v[1], v[2] and v[3]
+ */
+inline int32_t hmax(const Vect128i& v) {
+    return vmaxvq_s32(v);
+}
+
+/**
+ * @brief Highest value of a vector
+ *
+ * Goes through highest(), so NaN lanes behave like on x86
+ *
+ * @param v values to compare
+ * @return maximum of v[0], v[1], v[2] and v[3]
+ */
+inline float hmax(const Vect128f& v) {
+    Vect128f maxs = highest(v, Vect128f(vrev64q_f32(v)));
+    return extract<0>(highest(maxs, Vect128f(vextq_f32(maxs, maxs, 2))));
+}
+
+/**
+ * @brief Dot product of two vectors
+ *
+ * @param v first vector
+ * @param v2 second vector
+ * @return v[0] * v2[0] + v[1] * v2[1] + v[2] * v2[2] + v[3] * v2[3]
+ */
+inline float dot(const Vect128f& v, const Vect128f& v2) {
+    return hsum(v * v2);
+}
+
+/**
+ * @brief Reorders the values of a vector (r = {v[A], v[B], v[C], v[D]})
+ *
+ * @param A, B, C, D indices to take each lane from
+ * @param v vector to reorder
+ */
+template <int A, int B, int C, int D>
+inline Vect128i shuffle(const Vect128i& v) {
+    static_assert(A >= 0 && A < 4 && B >= 0 && B < 4 && C >= 0 && C < 4
+                  && D >= 0 && D < 4, "index outside of vector");
+    return detail::shuffleLanes<A, B, C, D>(int32x4_t(v), int32x4_t(v));
+}
+
+/**
+ * @brief Reorders the values of a vector (r = {v[A], v[B], v[C], v[D]})
+ *
+ * @param A, B, C, D indices to take each lane from
+ * @param v vector to reorder
+ */
+template <int A, int B, int C, int D>
+inline Vect128f shuffle(const Vect128f& v) {
+    static_assert(A >= 0 && A < 4 && B >= 0 && B < 4 && C >= 0 && C < 4
+                  && D >= 0 && D < 4, "index outside of vector");
+    return detail::shuffleLanes<A, B, C, D>(float32x4_t(v), float32x4_t(v));
+}
+
+/**
+ * @brief Picks two values of each vector (r = {v[A], v[B], v2[C], v2[D]})
+ *
+ * @param A, B indices into v for lanes 0 and 1
+ * @param C, D indices into v2 for lanes 2 and 3
+ * @param v, v2 vectors to take values from
+ */
+template <int A, int B, int C, int D>
+inline Vect128f shuffle(const Vect128f& v, const Vect128f& v2) {
+    static_assert(A >= 0 && A < 4 && B >= 0 && B < 4 && C >= 0 && C < 4
+                  && D >= 0 && D < 4, "index outside of vector");
+    return detail::shuffleLanes<A, B, C + 4, D + 4>(float32x4_t(v),
+                                                    float32x4_t(v2));
+}
+
+/**
+ * @brief Interleaves the lower halves (r = {v[0], v2[0], v[1], v2[1]})
+ *
+ * @param v, v2 vectors to interleave
+ */
+inline Vect128i unpacklo(const Vect128i& v, const Vect128i& v2) {
+    return vzip1q_s32(v, v2);
+}
+
+/**
+ * @brief Interleaves the upper halves (r = {v[2], v2[2], v[3], v2[3]})
+ *
+ * @param v, v2 vectors to interleave
+ */
+inline Vect128i unpackhi(const Vect128i& v, const Vect128i& v2) {
+    return vzip2q_s32(v, v2);
+}
+
+/**
+ * @brief Interleaves the lower halves (r = {v[0], v2[0], v[1], v2[1]})
+ *
+ * @param v, v2 vectors to interleave
+ */
+inline Vect128f unpacklo(const Vect128f& v, const Vect128f& v2) {
+    return vzip1q_f32(v, v2);
+}
+
+/**
+ * @brief Interleaves the upper halves (r = {v[2], v2[2], v[3], v2[3]})
+ *
+ * @param v, v2 vectors to interleave
+ */
+inline Vect128f unpackhi(const Vect128f& v, const Vect128f& v2) {
+    return vzip2q_f32(v, v2);
+}
+
+/**
+ * @brief Transposes the 4x4 matrix made of four rows in place
+ *
+ * @param r0, r1, r2, r3 rows of the matrix
+ */
+inline void transpose(Vect128i& r0, Vect128i& r1, Vect128i& r2,
+                      Vect128i& r3) {
+    // pairs of lanes as 64 bit values move as one
+    int64x2_t t0 = vreinterpretq_s64_s32(unpacklo(r0, r1));
+    int64x2_t t1 = vreinterpretq_s64_s32(unpacklo(r2, r3));
+    int64x2_t t2 = vreinterpretq_s64_s32(unpackhi(r0, r1));
+    int64x2_t t3 = vreinterpretq_s64_s32(unpackhi(r2, r3));
+    r0 = vreinterpretq_s32_s64(vzip1q_s64(t0, t1));
+    r1 = vreinterpretq_s32_s64(vzip2q_s64(t0, t1));
+    r2 = vreinterpretq_s32_s64(vzip1q_s64(t2, t3));
+    r3 = vreinterpretq_s32_s64(vzip2q_s64(t2, t3));
+}
+
+/**
+ * @brief Transposes the 4x4 matrix made of four rows in place
+ *
+ * Afterwards r0 holds the first column, r1 the second and so on. Turns four
+ * xyzw structs into one vector per field, and back
+ *
+ * @param r0, r1, r2, r3 rows of the matrix
+ */
+inline void transpose(Vect128f& r0, Vect128f& r1, Vect128f& r2,
+                      Vect128f& r3) {
+    Vect128i i0 = as_int(r0), i1 = as_int(r1), i2 = as_int(r2),
+             i3 = as_int(r3);
+    transpose(i0, i1, i2, i3);
+    r0 = as_float(i0);
+    r1 = as_float(i1);
+    r2 = as_float(i2);
+    r3 = as_float(i3);
+}
+
+/**
+ * @brief Shifts each value left by the same runtime amount
+ *
+ * @param v vector to shift
+ * @param count amount of bits, 32 or more gives 0
+ */
+inline Vect128i shl(const Vect128i& v, int count) {
+    // register shifts only read a signed byte, so large counts are clamped
+    return vshlq_s32(v, vdupq_n_s32(std::min(count, 32)));
+}
+
+/**
+ * @brief Shifts each value right by the same runtime amount, filling with
+ * zeros
+ *
+ * @param v vector to shift
+ * @param count amount of bits, 32 or more gives 0
+ */
+inline Vect128i shr(const Vect128i& v, int count) {
+    // negative counts shift right
+    return vreinterpretq_s32_u32(vshlq_u32(vreinterpretq_u32_s32(v),
+                                           vdupq_n_s32(-std::min(count, 32))));
+}
+
+/**
+ * @brief Shifts each value right by the same runtime amount, filling with
+ * the sign bit
+ *
+ * @param v vector to shift
+ * @param count amount of bits, 32 or more fills every bit with the sign
+ */
+inline Vect128i sar(const Vect128i& v, int count) {
+    return vshlq_s32(v, vdupq_n_s32(-std::min(count, 32)));
+}
+
+/**
+ * @brief Shifts each value left by N bits (r[i] = v[i] << N)
+ *
+ * @param N amount of bits, 32 or more gives 0
+ * @param v vector to shift
+ */
+template <int N>
+inline Vect128i shl(const Vect128i& v) {
+    static_assert(N >= 0, "negative shift");
+    // the immediate forms stop at 31, the compiler folds the constant
+    return shl(v, N);
+}
+
+/**
+ * @brief Shifts each value right by N bits, filling with zeros
+ *
+ * @param N amount of bits, 32 or more gives 0
+ * @param v vector to shift
+ */
+template <int N>
+inline Vect128i shr(const Vect128i& v) {
+    static_assert(N >= 0, "negative shift");
+    return shr(v, N);
+}
+
+/**
+ * @brief Shifts each value right by N bits, filling with the sign bit
+ *
+ * @param N amount of bits, 32 or more fills every bit with the sign
+ * @param v vector to shift
+ */
+template <int N>
+inline Vect128i sar(const Vect128i& v) {
+    static_assert(N >= 0, "negative shift");
+    return sar(v, N);
+}
+
+namespace detail {
+
+/// Per lane counts clamped to 32, as signed bytes are all NEON reads
+inline int32x4_t shiftCounts(const Vect128i& counts) {
+    return vreinterpretq_s32_u32(
+        vminq_u32(vreinterpretq_u32_s32(counts), vdupq_n_u32(32)));
+}
+
+}  // namespace detail
+
+/**
+ * @brief Shifts each value left by its own amount (r[i] = v[i] << c[i])
+ *
+ * @param v vector to shift
+ * @param counts amount of bits per lane, 32 or more (as unsigned) gives 0
+ */
+inline Vect128i shl(const Vect128i& v, const Vect128i& counts) {
+    return vshlq_s32(v, detail::shiftCounts(counts));
+}
+
+/**
+ * @brief Shifts each value right by its own amount, filling with zeros
+ *
+ * @param v vector to shift
+ * @param counts amount of bits per lane, 32 or more (as unsigned) gives 0
+ */
+inline Vect128i shr(const Vect128i& v, const Vect128i& counts) {
+    return vreinterpretq_s32_u32(
+        vshlq_u32(vreinterpretq_u32_s32(v),
+                  vnegq_s32(detail::shiftCounts(counts))));
+}
+
+/**
+ * @brief Shifts each value right by its own amount, filling with the sign
+ * bit
+ *
+ * @param v vector to shift
+ * @param counts amount of bits per lane, 32 or more (as unsigned) fills
+ * every bit with the sign
+ */
+inline Vect128i sar(const Vect128i& v, const Vect128i& counts) {
+    return vshlq_s32(v, vnegq_s32(detail::shiftCounts(counts)));
+}
+
+/**
+ * @brief Picks values from two vectors using a mask (r[i] = m[i] ? a[i] : b[i])
+ *
+ * @param m lanes to take from a
+ * @param a values used where m is set
+ * @param b values used where m is not set
+ */
+inline Vect128i select(const Mask128& m, const Vect128i& a, const Vect128i& b) {
+    return vbslq_s32(m, a, b);
+}
+
+/**
+ * @brief Picks values from two vectors using a mask (r[i] = m[i] ? a[i] : b[i])
+ *
+ * @param m lanes to take from a
+ * @param a values used where m is set
+ * @param b values used where m is not set
+ */
+inline Vect128f select(const Mask128& m, const Vect128f& a, const Vect128f& b) {
+    return vbslq_f32(m, a, b);
+}
+
+/**
+ * @brief Bits of a mask, lane i is bit i (like _mm_movemask_ps)
+ *
+ * @param m mask, ie. the result of a comparison
+ */
+inline uint32_t movemask(const Mask128& m) {
+    return m.bits();
+}
+
+/**
+ * @brief Checks if any lane of a mask is set
+ *
+ * @param m mask, ie. the result of a comparison
+ */
+inline bool any(const Mask128& m) {
+    return vmaxvq_u32(m) != 0;
+}
+
+/**
+ * @brief Checks if every lane of a mask is set
+ *
+ * @param m mask, ie. the result of a comparison
+ */
+inline bool all(const Mask128& m) {
+    return m.bits() == 0xF;
+}
+
+/**
+ * @brief Checks if no lane of a mask is set
+ *
+ * @param m mask, ie. the result of a comparison
+ */
+inline bool none(const Mask128& m) {
+    return !any(m);
+}
+
+/**
+ * @brief High 32 bits of each signed 64 bit product (a[i] * b[i] >> 32)
+ *
+ * @param a, b vectors to multiply
+ */
+inline Vect128i mulhi(const Vect128i& a, const Vect128i& b) {
+    int64x2_t lo = vmull_s32(vget_low_s32(a), vget_low_s32(b));
+    int64x2_t hi = vmull_high_s32(a, b);
+    // the odd 32 bit halves are the high halves of the products
+    return vuzp2q_s32(vreinterpretq_s32_s64(lo), vreinterpretq_s32_s64(hi));
+}
+
+/**
+ * @brief Loads base[idx[i]] into each lane
+ *
+ * @param base start of the table
+ * @param idx index of each value, counted in int32's from base
+ */
+inline Vect128i gather(const int32_t* base, const Vect128i& idx) {
+    alignas(16) int32_t i[4];
+    idx.store(i);
+    return Vect128i(base[i[0]], base[i[1]], base[i[2]], base[i[3]]);
+}
+
+/**
+ * @brief Loads base[idx[i]] into each lane
+ *
+ * @param base start of the table
+ * @param idx index of each value, counted in floats from base
+ */
+inline Vect128f gather(const float* base, const Vect128i& idx) {
+    alignas(16) int32_t i[4];
+    idx.store(i);
+    return Vect128f(base[i[0]], base[i[1]], base[i[2]], base[i[3]]);
+}
+
+/**
+ * @brief Stores each lane to base[idx[i]]
+ *
+ * There is no scatter instruction, so the lanes are stored one by one, in
+ * order (the last lane wins for repeated indices)
+ *
+ * @param base start of the table
+ * @param idx index of each value, counted in int32's from base
+ * @param v values to store
+ */
+inline void scatter(int32_t* base, const Vect128i& idx, const Vect128i& v) {
+    alignas(16) int32_t i[4], values[4];
+    idx.store(i);
+    v.store(values);
+    for (int l = 0; l < 4; l++) {
+        base[i[l]] = values[l];
+    }
+}
+
+/**
+ * @brief Stores each lane to base[idx[i]]
+ *
+ * Same as the int32 version
+ *
+ * @param base start of the table
+ * @param idx index of each value, counted in floats from base
+ * @param v values to store
+ */
+inline void scatter(float* base, const Vect128i& idx, const Vect128f& v) {
+    alignas(16) int32_t i[4];
+    alignas(16) float values[4];
+    idx.store(i);
+    v.store(values);
+    for (int l = 0; l < 4; l++) {
+        base[i[l]] = values[l];
+    }
+}
+
+}  // namespace sight
@@ -0,0 +1,440 @@
+#pragma once
+
+#include "simd_memory.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+#ifdef __linux__
+    #include <sys/syscall.h>
+#endif
+
+namespace sight {
+
+/// Page sizes a PageResource can map with
+enum class Pages : int {
+    Small,  // the system page size, usually 4K
+    Huge    // 2M aligned and advised for transparent huge pages
+};
+
+/**
+ * @brief Memory mapped directly from the OS, one mapping per allocation
+ *
+ * Meant for large, long-lived arrays. Huge pages cut TLB misses on
+ * streaming kernels, they come from the kernel's transparent huge pages
+ * (madvise(MADV_HUGEPAGE)) and silently fall back to small pages when
+ * those are disabled. Binding to a NUMA node keeps the pages on that node
+ * no matter which thread touches them first.
+ *
+ * The memory starts out zeroed, but pages only get placed once they are
+ * written, see parallelClear()
+ *
+ * @code
+ * PageResource pages(Pages::Huge, 0);  // on NUMA node 0
+ * AlignedStorage<float, 64> big(1 << 28, pages);
+ * @endcode
+ */
+class PageResource : public MemoryResource {
+  public:
+    /// Huge page size (x86-64 and aarch64 with 4K base pages)
+    static const size_t HugePage = size_t(2) << 20;
+
+    /// Node value for no binding
+    static const int AnyNode = -1;
+
+    /**
+     * @param pages page size to map with
+     * @param node NUMA node to bind to, or AnyNode. Only Linux can bind
+     */
+    explicit PageResource(Pages pages = Pages::Huge, int node = AnyNode)
+        : pages(pages), node(node) {
+        if (node < AnyNode || node >= MaxNodes) {
+            throw std::invalid_argument("NUMA node out of range");
+        }
+    }
+
+    /**
+     * @brief Maps bytes (rounded up to whole pages), aligned to align
+     *
+     * Throws std::bad_alloc if the mapping fails and std::system_error if
+     * the node binding does
+     */
+    void* allocate(size_t bytes, size_t align) override {
+        size_t size = mappedSize(bytes);
+        size_t step = boundary(align);
+        if (size > std::numeric_limits<size_t>::max() - step) {
+            throw std::bad_alloc();
+        }
+
+        // map a step more than needed, then cut off the unaligned ends
+        size_t total = size + step;
+        void* raw = mmap(nullptr, total, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        uintptr_t base = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t start = (base + step - 1) / step * step;
+        if (start > base) {
+            munmap(raw, start - base);
+        }
+        if (base + total > start + size) {
+            munmap(reinterpret_cast<void*>(start + size),
+                   base + total - start - size);
+        }
+
+        void* p = reinterpret_cast<void*>(start);
+        #ifdef MADV_HUGEPAGE
+        if (pages == Pages::Huge) {
+            madvise(p, size, MADV_HUGEPAGE);  // only a hint
+        }
+        #endif
+        if (node != AnyNode) {
+            int error = bind(p, size);
+            if (error) {
+                munmap(p, size);
+                throw std::system_error(error, std::generic_category(),
+                                        "binding memory to a NUMA node");
+            }
+        }
+        return p;
+    }
+
+    void deallocate(void* p, size_t bytes, size_t) override {
+        if (p) {
+            munmap(p, mappedSize(bytes));
+        }
+    }
+
+    /// Page size this resource maps with
+    inline size_t pageSize() const {
+        if (pages == Pages::Huge) {
+            return HugePage;
+        }
+        return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+
+  private:
+    static const int MaxNodes = 1024;
+
+    inline size_t mappedSize(size_t bytes) const {
+        size_t page = pageSize();
+        if (bytes == 0) {
+            bytes = 1;
+        }
+        if (bytes > std::numeric_limits<size_t>::max() - page) {
+            throw std::bad_alloc();
+        }
+        return (bytes + page - 1) / page * page;
+    }
+
+    // smallest multiple of both the page size and align
+    inline size_t boundary(size_t align) const {
+        size_t page = pageSize();
+        if (align == 0) {
+            throw std::bad_alloc();
+        }
+        size_t a = page, b = align;
+        while (b) {
+            size_t r = a % b;
+            a = b;
+            b = r;
+        }
+        if (align / a > std::numeric_limits<size_t>::max() / page) {
+            throw std::bad_alloc();
+        }
+        return page * (align / a);
+    }
+
+    // mbind(MPOL_BIND), called directly as libnuma may not be installed
+    inline int bind(void* p, size_t size) const {
+        #if defined(__linux__) && defined(SYS_mbind)
+        const int mpol_bind = 2;
+        const size_t bits = sizeof(unsigned long) * 8;
+        unsigned long mask[MaxNodes / (sizeof(unsigned long) * 8)] = {};
+        mask[node / bits] = 1ul << (node % bits);
+        // the kernel expects one more than the amount of bits in the mask
+        if (syscall(SYS_mbind, p, size, mpol_bind, mask,
+                    static_cast<unsigned long>(MaxNodes + 1), 0) != 0) {
+            return errno;
+        }
+        return 0;
+        #else
+        (void)p;
+        (void)size;
+        return ENOSYS;
+        #endif
+    }
+
+    Pages pages;
+    int node;
+};
+
+/**
+ * @brief Zeroes storage from several threads, each writing one slice
+ *
+ * Without a node binding, pages are placed on the node of the thread that
+ * first writes them. Clearing a new allocation this way spreads it over
+ * the nodes the same way a parallel kernel splitting the array into equal
+ * contiguous slices will read it, instead of putting everything on the
+ * node of the thread calling clear(). Slices are split on page boundaries
+ *
+ * @param storage values to zero
+ * @param threads amount of threads, all hardware threads by default
+ */
+template <typename T, int Align>
+inline void parallelClear(AlignedStorage<T, Align>& storage,
+                          unsigned threads = 0) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    char* data = reinterpret_cast<char*>(static_cast<T*>(storage));
+    const size_t bytes = storage.length() * sizeof(T);
+    const uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t base = reinterpret_cast<uintptr_t>(data);
+    if (threads <= 1 || bytes < threads * page) {
+        storage.clear();
+        return;
+    }
+
+    // slice k ends on the first page boundary after k + 1 equal parts
+    std::vector<size_t> ends;
+    for (unsigned k = 1; k < threads; k++) {
+        uintptr_t end = base + bytes / threads * k;
+        ends.push_back((end + page - 1) / page * page - base);
+    }
+    ends.push_back(bytes);
+
+    std::vector<std::thread> workers;
+    for (unsigned k = 1; k < threads; k++) {
+        size_t start = ends[k - 1], length = ends[k] - ends[k - 1];
+        workers.push_back(std::thread([=] {
+            memset(data + start, 0, length);
+        }));
+    }
+    memset(data, 0, ends[0]);
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+}
+
+/// How a MappedStorage maps its file
+enum class Mapping : int {
+    ReadOnly,    // writing to the values crashes
+    CopyOnWrite  // writes go to private copies of the pages, not the file
+};
+
+/**
+ * @brief Values of a file, mapped into memory instead of read
+ *
+ * The file is used as raw, native endian T's, nothing is copied up front:
+ * pages are read on first access and shared with the page cache (and so
+ * with other processes mapping the same file). Same interface as
+ * AlignedStorage, so vectors load from it directly. The data is page
+ * aligned when offset is 0
+ *
+ * @code
+ * MappedStorage<float> features("features.f32");
+ * Vect128f first = Vect128f::load(features);
+ * @endcode
+ *
+ * @param T type of the values in the file
+ */
+template <typename T>
+class MappedStorage {
+  public:
+    /**
+     * @brief Maps a file, throws std::system_error if that fails
+     *
+     * @param path file to map
+     * @param mode ReadOnly, or CopyOnWrite to allow changing the values
+     * @param offset bytes to skip at the start of the file, ie. a header
+     */
+    explicit MappedStorage(const std::string& path,
+                           Mapping mode = Mapping::ReadOnly,
+                           size_t offset = 0)
+        : count(0), mapping(nullptr), size(0), data(nullptr) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(),
+                                    "opening " + path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            int error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(),
+                                    "reading the size of " + path);
+        }
+        size_t bytes = static_cast<size_t>(info.st_size);
+        if (offset > bytes) {
+            close(fd);
+            throw std::out_of_range("offset is past the end of " + path);
+        }
+
+        count = (bytes - offset) / sizeof(T);
+        if (count > 0) {
+            // mmap needs a page aligned file offset
+            size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            size_t start = offset / page * page;
+            size = offset - start + count * sizeof(T);
+            int prot = PROT_READ;
+            int flags = MAP_SHARED;
+            if (mode == Mapping::CopyOnWrite) {
+                prot |= PROT_WRITE;
+                flags = MAP_PRIVATE;
+            }
+            void* p = mmap(nullptr, size, prot, flags, fd,
+                           static_cast<off_t>(start));
+            if (p == MAP_FAILED) {
+                int error = errno;
+                close(fd);
+                throw std::system_error(error, std::generic_category(),
+                                        "mapping " + path);
+            }
+            mapping = p;
+            data = reinterpret_cast<T*>(static_cast<char*>(p) + offset
+                                        - start);
+        }
+        close(fd);  // the mapping keeps the file open
+    }
+
+    inline MappedStorage(MappedStorage&& other)
+        : count(other.count), mapping(other.mapping), size(other.size),
+          data(other.data) {
+        other.count = 0;
+        other.mapping = nullptr;
+        other.size = 0;
+        other.data = nullptr;
+    }
+
+    inline MappedStorage& operator=(MappedStorage&& other) {
+        std::swap(count, other.count);
+        std::swap(mapping, other.mapping);
+        std::swap(size, other.size);
+        std::swap(data, other.data);
+        return *this;
+    }
+
+    MappedStorage(const MappedStorage&) = delete;
+    MappedStorage& operator=(const MappedStorage&) = delete;
+
+    inline ~MappedStorage() {
+        if (mapping) {
+            munmap(mapping, size);
+        }
+    }
+
+    /// Amount of whole T's in the file after offset
+    inline size_t length() const {
+        return count;
+    }
+
+    /**
+     * @brief Tells the kernel the values will be read soon
+     *
+     * Reading ahead in the background avoids a page fault per page on the
+     * first pass over the data
+     */
+    inline void willNeed() const {
+        if (mapping) {
+            madvise(mapping, size, MADV_WILLNEED);
+        }
+    }
+
+    /// Casts to a non-const pointer
+    inline operator T*() {
+        return data;
+    }
+
+    /// Casts to a const pointer
+    inline operator const T*() const {
+        return data;
+    }
+
+    /**
+     * @brief Returns an offset pointer
+     *
+     * @param i offset from main pointer
+     * @return pointer of data + i
+     */
+    inline T* operator+(ptrdiff_t i) {
+        return data + i;
+    }
+
+    /**
+     * @brief Returns an offset const pointer
+     *
+     * @param i offset from main pointer
+     * @return pointer of data + i
+     */
+    inline const T* operator+(ptrdiff_t i) const {
+        return data + i;
+    }
+
+    /**
+     * @brief Returns data at an index
+     *
+     * @param i index of data
+     * @return writable reference to data (CopyOnWrite only)
+     */
+    inline T& operator[](size_t i) {
+        return data[i];
+    }
+
+    /**
+     * @brief Returns data at an index
+     *
+     * @param i index of data
+     * @return data found at index
+     */
+    inline const T& operator[](size_t i) const {
+        return data[i];
+    }
+
+    /**
+     * @brief Returns data at an index, with a bounds check
+     *
+     * @param i index of data
+     * @return writable reference to data (CopyOnWrite only)
+     */
+    inline T& at(size_t i) {
+        if (i >= count) {
+            throw std::out_of_range("outside of mapped storage boundary");
+        }
+        return data[i];
+    }
+
+    /**
+     * @brief Returns data at an index, with a bounds check
+     *
+     * @param i index of data
+     * @return data found at index
+     */
+    inline const T& at(size_t i) const {
+        if (i >= count) {
+            throw std::out_of_range("outside of mapped storage boundary");
+        }
+        return data[i];
+    }
+
+  private:
+    size_t count;
+    void* mapping;
+    size_t size;
+    T* data;
+};
+
+}  // namespace sight
@@ -0,0 +1,446 @@
+#pragma once
+
+#include "simd.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/**
+ * Parallel kernels split their arrays into chunks of about this many bytes.
+ * Chunks are the unit of work stealing, so they should be much smaller than
+ * an array divided by the amount of threads, yet large enough that taking
+ * one costs nothing next to processing it
+ */
+#ifndef SIGHT_PARALLEL_GRAIN
+    #define SIGHT_PARALLEL_GRAIN (size_t(64) << 10)
+#endif
+
+namespace sight {
+
+/**
+ * @brief Fixed set of threads running batches of numbered tasks
+ *
+ * run(count, task) calls task(0) to task(count - 1) and returns once all
+ * of them are done, with the calling thread working along. The tasks are
+ * dealt out in contiguous ranges, one per thread, so neighbouring tasks
+ * (and the memory they touch) stay on the same thread. A thread that
+ * finishes its range steals tasks from the end of the others, which evens
+ * out slow cores and uneven tasks.
+ *
+ * Any class with the same run() can be passed as the executor of the
+ * parallel kernels instead, ie. to use an existing pool.
+ *
+ * @code
+ * ThreadPool pool(8);
+ * parallelTransform(src, dst, op, pool);
+ * @endcode
+ */
+class ThreadPool {
+  public:
+    /**
+     * @brief Starts threads - 1 worker threads
+     *
+     * @param threads amount of threads including the caller of run(), all
+     * hardware threads by default
+     */
+    explicit ThreadPool(unsigned threads = 0)
+        : job(nullptr), generation(0), active(0), stop(false) {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        ranges.reset(new Range[threads]);
+        for (unsigned k = 0; k + 1 < threads; k++) {
+            workers.push_back(std::thread([this, k] { work(k); }));
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    inline ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stop = true;
+        }
+        wake.notify_all();
+        for (size_t k = 0; k < workers.size(); k++) {
+            workers[k].join();
+        }
+    }
+
+    /// Amount of threads taking part in run(), including the caller
+    inline unsigned size() const {
+        return static_cast<unsigned>(workers.size()) + 1;
+    }
+
+    /**
+     * @brief Calls task(i) for every i in [0, count), in parallel
+     *
+     * Runs the tasks on the calling thread alone when they are nested in
+     * another run() or the pool is busy with one from another thread. The
+     * first exception thrown by a task is rethrown here, after all the
+     * other tasks are done
+     *
+     * @param count amount of tasks
+     * @param task functor taking the size_t index of a task
+     */
+    template <typename Task>
+    inline void run(size_t count, const Task& task) {
+        if (count == 0) {
+            return;
+        }
+        if (count == 1 || workers.empty() || inside()) {
+            serial(count, task);
+            return;
+        }
+        std::unique_lock<std::mutex> exclusive(busy, std::try_to_lock);
+        if (!exclusive.owns_lock()) {
+            serial(count, task);
+            return;
+        }
+
+        const std::function<void(size_t)> f = [&task](size_t i) { task(i); };
+        const unsigned threads = size();
+        for (unsigned k = 0; k < threads; k++) {
+            std::lock_guard<std::mutex> guard(ranges[k].lock);
+            ranges[k].front = count * k / threads;
+            ranges[k].back = count * (k + 1) / threads;
+        }
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            job = &f;
+            error = nullptr;
+            active = static_cast<unsigned>(workers.size());
+            generation++;
+        }
+        wake.notify_all();
+
+        participate(threads - 1, f);
+
+        std::unique_lock<std::mutex> guard(lock);
+        finished.wait(guard, [this] { return active == 0; });
+        job = nullptr;
+        if (error) {
+            std::exception_ptr e = error;
+            error = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+    /**
+     * @brief Pool with a thread per hardware thread, started on first use
+     */
+    static inline ThreadPool& shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+  private:
+    // tasks [front, back) dealt to one thread, padded to a cache line
+    struct Range {
+        std::mutex lock;
+        size_t front = 0;
+        size_t back = 0;
+        char padding[64];
+    };
+
+    // set while the thread works on a run(), to catch nested calls
+    static inline bool& inside() {
+        static thread_local bool flag = false;
+        return flag;
+    }
+
+    template <typename Task>
+    static inline void serial(size_t count, const Task& task) {
+        for (size_t i = 0; i < count; i++) {
+            task(i);
+        }
+    }
+
+    inline bool take(unsigned k, size_t& task) {
+        std::lock_guard<std::mutex> guard(ranges[k].lock);
+        if (ranges[k].front == ranges[k].back) {
+            return false;
+        }
+        task = ranges[k].front++;
+        return true;
+    }
+
+    inline bool steal(unsigned k, size_t& task) {
+        std::lock_guard<std::mutex> guard(ranges[k].lock);
+        if (ranges[k].front == ranges[k].back) {
+            return false;
+        }
+        task = --ranges[k].back;
+        return true;
+    }
+
+    // runs the tasks of range k, then steals until every range is empty
+    inline void participate(unsigned k, const std::function<void(size_t)>& f) {
+        inside() = true;
+        const unsigned threads = size();
+        size_t task;
+        for (;;) {
+            bool found = take(k, task);
+            for (unsigned v = 1; !found && v < threads; v++) {
+                found = steal((k + v) % threads, task);
+            }
+            if (!found) {
+                break;
+            }
+            try {
+                f(task);
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(lock);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        inside() = false;
+    }
+
+    inline void work(unsigned k) {
+        size_t seen = 0;
+        for (;;) {
+            const std::function<void(size_t)>* f;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                wake.wait(guard, [&] { return stop || generation != seen; });
+                if (stop) {
+                    return;
+                }
+                seen = generation;
+                f = job;
+            }
+            participate(k, *f);
+            std::lock_guard<std::mutex> guard(lock);
+            if (--active == 0) {
+                finished.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::unique_ptr<Range[]> ranges;
+    std::mutex busy;  // one run() at a time
+
+    // guarded by lock
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const std::function<void(size_t)>* job;
+    std::exception_ptr error;
+    size_t generation;
+    unsigned active;  // workers that didn't finish the current job yet
+    bool stop;
+};
+
+namespace detail {
+
+/**
+ * @brief Splits [0, length) into chunks that start on a cache line
+ *
+ * Boundaries only depend on the length and on where the data starts, so
+ * every run (and every amount of threads) processes the same chunks, and
+ * no two chunks write to the same cache line
+ */
+template <typename T>
+class Chunks {
+  public:
+    inline Chunks(const T* data, size_t length) : length(length) {
+        const size_t line = sizeof(T) < 64 ? 64 / sizeof(T) : 1;
+        grain = std::max(line, SIGHT_PARALLEL_GRAIN / sizeof(T) / line * line);
+        size_t misaligned = reinterpret_cast<uintptr_t>(data) % 64;
+        skew = misaligned ? (64 - misaligned) / sizeof(T) % line : 0;
+    }
+
+    /// Amount of chunks, at least 1
+    inline size_t count() const {
+        if (length <= skew + grain) {
+            return 1;
+        }
+        return 1 + (length - skew - 1) / grain;
+    }
+
+    /// First index of chunk k
+    inline size_t begin(size_t k) const {
+        return k == 0 ? 0 : skew + k * grain;
+    }
+
+    /// One past the last index of chunk k
+    inline size_t end(size_t k) const {
+        return std::min(length, skew + (k + 1) * grain);
+    }
+
+  private:
+    size_t length;
+    size_t grain;
+    size_t skew;  // values before the first cache line
+};
+
+}  // namespace detail
+
+/**
+ * @brief transform() split into chunks, run on several threads
+ *
+ * Same results as transform(). op is copied for every chunk and called from
+ * several threads at once
+ *
+ * @param V vector type to process with (the widest one for T by default)
+ * @param src values to transform
+ * @param dst where to store results, can be the same storage as src
+ * @param op functor taking and returning a V
+ * @param executor threads to run on, the shared pool by default
+ */
+template <typename V, typename T, int Align, int Align2, typename Op,
+          typename Executor = ThreadPool>
+inline void parallelTransform(const AlignedStorage<T, Align>& src,
+                              AlignedStorage<T, Align2>& dst, Op op,
+                              Executor& executor = ThreadPool::shared()) {
+    if (dst.length() < src.length()) {
+        throw std::out_of_range("destination is smaller than source");
+    }
+    const size_t length = src.length();
+    SIGHT_TIME(ParallelTransform, length);
+    const T* s = src;
+    T* d = dst;
+
+    const bool stream = detail::streams<T>(length);
+    const detail::Chunks<T> chunks(d, length);
+    executor.run(chunks.count(), [&](size_t k) {
+        const size_t begin = chunks.begin(k);
+        Op f(op);
+        detail::transformRange<V>(s + begin, d + begin,
+                                  chunks.end(k) - begin, stream, f);
+    });
+}
+
+/**
+ * @brief transform() on several threads using the widest vector for T
+ */
+template <typename T, int Align, int Align2, typename Op,
+          typename Executor = ThreadPool>
+inline void parallelTransform(const AlignedStorage<T, Align>& src,
+                              AlignedStorage<T, Align2>& dst, Op op,
+                              Executor& executor = ThreadPool::shared()) {
+    parallelTransform<typename detail::Widest<T>::type>(src, dst, op, executor);
+}
+
+/**
+ * @brief zip() split into chunks, run on several threads
+ *
+ * Same results as zip(). op is copied for every chunk and called from
+ * several threads at once
+ *
+ * @param V vector type to process with (the widest one for T by default)
+ * @param a, b values to combine, both need at least a.length() values
+ * @param dst where to store results, can be the same storage as a or b
+ * @param op functor taking two V and returning a V
+ * @param executor threads to run on, the shared pool by default
+ */
+template <typename V, typename T, int Align, int Align2, int Align3,
+          typename Op, typename Executor = ThreadPool>
+inline void parallelZip(const AlignedStorage<T, Align>& a,
+                        const AlignedStorage<T, Align2>& b,
+                        AlignedStorage<T, Align3>& dst, Op op,
+                        Executor& executor = ThreadPool::shared()) {
+    if (b.length() < a.length()) {
+        throw std::out_of_range("second source is smaller than first source");
+    }
+    if (dst.length() < a.length()) {
+        throw std::out_of_range("destination is smaller than source");
+    }
+    const size_t length = a.length();
+    SIGHT_TIME(ParallelZip, length);
+    const T* pa = a;
+    const T* pb = b;
+    T* d = dst;
+
+    const bool stream = detail::streams<T>(length);
+    const detail::Chunks<T> chunks(d, length);
+    executor.run(chunks.count(), [&](size_t k) {
+        const size_t begin = chunks.begin(k);
+        Op f(op);
+        detail::zipRange<V>(pa + begin, pb + begin, d + begin,
+                            chunks.end(k) - begin, stream, f);
+    });
+}
+
+/**
+ * @brief zip() on several threads using the widest vector for T
+ */
+template <typename T, int Align, int Align2, int Align3, typename Op,
+          typename Executor = ThreadPool>
+inline void parallelZip(const AlignedStorage<T, Align>& a,
+                        const AlignedStorage<T, Align2>& b,
+                        AlignedStorage<T, Align3>& dst, Op op,
+                        Executor& executor = ThreadPool::shared()) {
+    parallelZip<typename detail::Widest<T>::type>(a, b, dst, op, executor);
+}
+
+/**
+ * @brief reduce() split into chunks, run on several threads
+ *
+ * Every chunk is folded on its own, then the results are folded in chunk
+ * order on the calling thread. The chunks don't depend on the amount of
+ * threads or on which thread takes which chunk, so a float sum comes out
+ * the same every time (although not the same as reduce(), which folds in
+ * a different order). op has the same requirements as for reduce()
+ *
+ * @param V vector type to process with (the widest one for T by default)
+ * @param src values to fold
+ * @param init starting value, used once
+ * @param op functor taking two V and returning a V
+ * @param executor threads to run on, the shared pool by default
+ * @return init folded with every value of src
+ */
+template <typename V, typename T, int Align, typename Op,
+          typename Executor = ThreadPool>
+inline T parallelReduce(const AlignedStorage<T, Align>& src, T init, Op op,
+                        Executor& executor = ThreadPool::shared()) {
+    const size_t length = src.length();
+    if (length == 0) {
+        return init;
+    }
+    SIGHT_TIME(ParallelReduce, length);
+    const T* s = src;
+    const detail::Chunks<T> chunks(s, length);
+    std::vector<T> partial(chunks.count());
+    executor.run(chunks.count(), [&](size_t k) {
+        const size_t begin = chunks.begin(k), end = chunks.end(k);
+        Op f(op);
+        if (k == 0) {
+            partial[0] = detail::reduceRange<V>(s, end, init, f);
+        } else {
+            // no init, op has no identity, and begin is on a cache line
+            partial[k] = detail::reduceRange<V>(s + begin, end - begin, f);
+        }
+    });
+
+    V result(partial[0]);
+    for (size_t k = 1; k < partial.size(); k++) {
+        result = op(result, V(partial[k]));
+    }
+    return result[0];
+}
+
+/**
+ * @brief reduce() on several threads using the widest vector for T
+ */
+template <typename T, int Align, typename Op, typename Executor = ThreadPool>
+inline T parallelReduce(const AlignedStorage<T, Align>& src, T init, Op op,
+                        Executor& executor = ThreadPool::shared()) {
+    return parallelReduce<typename detail::Widest<T>::type>(src, init, op,
+                                                            executor);
+}
+
+}  // namespace sight
@@ -0,0 +1,491 @@
+#pragma once
+
+#include "simd.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+/*
+ * Searching, comparing and scanning whole arrays, the vector versions of
+ * std::find, std::count_if, std::equal, std::min_element and
+ * std::inclusive_scan.
+ *
+ * Predicates are functors that take a vector and return a comparison
+ * result, ie. v == V('\n'), and are only ever called with whole vectors.
+ * Positions are returned as indices, with src.length() for "not found".
+ */
+
+namespace sight {
+namespace detail {
+
+/// Keeps a function parameter out of template argument deduction
+template <typename T>
+struct Identity {
+    typedef T type;
+};
+
+/// The lower n bits set
+inline uint64_t lowBits(int n) {
+    return n >= 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+}
+
+template <typename V, bool Aligned, typename T>
+inline V loadAs(const T* p) {
+    return Aligned ? V::load(p) : V::loadu(p);
+}
+
+template <typename V, bool Aligned, typename T, typename Pred>
+inline size_t findIf(const T* s, size_t length, Pred& pred) {
+    const int L = V::lanes;
+    size_t i = 0;
+    // four vectors per branch, their masks fit in 64 bits
+    for (; room<4 * L>(i, length); i += 4 * L) {
+        uint64_t bits = movemask(pred(loadAs<V, Aligned>(s + i)))
+            | uint64_t(movemask(pred(loadAs<V, Aligned>(s + i + L)))) << L
+            | uint64_t(movemask(pred(loadAs<V, Aligned>(s + i + 2 * L))))
+                  << 2 * L
+            | uint64_t(movemask(pred(loadAs<V, Aligned>(s + i + 3 * L))))
+                  << 3 * L;
+        if (bits) {
+            return i + __builtin_ctzll(bits);
+        }
+    }
+    for (; room<L>(i, length); i += L) {
+        uint32_t bits = movemask(pred(loadAs<V, Aligned>(s + i)));
+        if (bits) {
+            return i + __builtin_ctz(bits);
+        }
+    }
+    if (i < length) {
+        const int n = static_cast<int>(length - i);
+        uint64_t bits = movemask(pred(V::load_partial(s + i, n))) & lowBits(n);
+        if (bits) {
+            return i + __builtin_ctzll(bits);
+        }
+    }
+    return length;
+}
+
+template <typename V, bool Aligned, typename T, typename Pred>
+inline size_t countIf(const T* s, size_t length, Pred& pred) {
+    const int L = V::lanes;
+    size_t count = 0, i = 0;
+    for (; room<L>(i, length); i += L) {
+        count += __builtin_popcount(movemask(pred(loadAs<V, Aligned>(s + i))));
+    }
+    if (i < length) {
+        const int n = static_cast<int>(length - i);
+        count += __builtin_popcountll(
+            movemask(pred(V::load_partial(s + i, n))) & lowBits(n));
+    }
+    return count;
+}
+
+/// Lowest value, where NaN never wins
+struct Smallest {
+    template <typename T>
+    static inline T start() {
+        return std::numeric_limits<T>::has_infinity
+                   ? std::numeric_limits<T>::infinity()
+                   : std::numeric_limits<T>::max();
+    }
+    // lowest() returns its second argument for NaN
+    template <typename V>
+    static inline V pick(const V& v, const V& best) {
+        return lowest(v, best);
+    }
+    template <typename T>
+    static inline bool better(T v, T best) {
+        return v < best;
+    }
+};
+
+/// Highest value, where NaN never wins
+struct Largest {
+    template <typename T>
+    static inline T start() {
+        return std::numeric_limits<T>::has_infinity
+                   ? -std::numeric_limits<T>::infinity()
+                   : std::numeric_limits<T>::lowest();
+    }
+    template <typename V>
+    static inline V pick(const V& v, const V& best) {
+        return highest(v, best);
+    }
+    template <typename T>
+    static inline bool better(T v, T best) {
+        return v > best;
+    }
+};
+
+template <typename V, bool Aligned, typename Pick, typename T>
+inline T extreme(const T* s, size_t length) {
+    T best = Pick::template start<T>();
+    if (length < static_cast<size_t>(V::lanes)) {
+        for (size_t i = 0; i < length; i++) {
+            if (Pick::better(s[i], best)) {
+                best = s[i];
+            }
+        }
+        return best;
+    }
+    V acc(best);
+    size_t i = 0;
+    for (; room<V::lanes>(i, length); i += V::lanes) {
+        acc = Pick::pick(loadAs<V, Aligned>(s + i), acc);
+    }
+    // the last vector again, overlapping values don't change the result
+    acc = Pick::pick(V::loadu(s + length - V::lanes), acc);
+
+    alignas(V) T lanes[V::lanes];
+    acc.store(lanes);
+    for (int l = 0; l < V::lanes; l++) {
+        if (Pick::better(lanes[l], best)) {
+            best = lanes[l];
+        }
+    }
+    return best;
+}
+
+template <typename V>
+struct Equals {
+    typename V::value_type value;
+    inline auto operator()(const V& v) const -> decltype(v == v) {
+        return v == V(value);
+    }
+};
+
+/// Index of the first value picked by Pick, see min_element()
+template <typename V, typename Pick, typename T, int Align>
+inline size_t element(const AlignedStorage<T, Align>& src) {
+    const T* s = src;
+    const size_t length = src.length();
+    T best = isAligned<sizeof(V)>(s) ? extreme<V, true, Pick>(s, length)
+                                     : extreme<V, false, Pick>(s, length);
+    // second pass, usually much shorter
+    Equals<V> pred = {best};
+    return isAligned<sizeof(V)>(s) ? findIf<V, true>(s, length, pred)
+                                   : findIf<V, false>(s, length, pred);
+}
+
+// Inclusive scan inside of one vector, in log2(lanes) shifts and adds
+
+inline Vect128i scan(const Vect128i& v) {
+    #ifdef HAVE_NEON
+    const int32x4_t zero = vdupq_n_s32(0);
+    Vect128i x = v + Vect128i(vextq_s32(zero, v, 3));
+    return x + Vect128i(vextq_s32(zero, x, 2));
+    #else
+    Vect128i x = v + Vect128i(_mm_slli_si128(v, 4));
+    return x + Vect128i(_mm_slli_si128(x, 8));
+    #endif
+}
+
+inline Vect128f scan(const Vect128f& v) {
+    #ifdef HAVE_NEON
+    const float32x4_t zero = vdupq_n_f32(0);
+    Vect128f x = v + Vect128f(vextq_f32(zero, v, 3));
+    return x + Vect128f(vextq_f32(zero, x, 2));
+    #else
+    Vect128f x = v + Vect128f(_mm_castsi128_ps(
+                         _mm_slli_si128(_mm_castps_si128(v), 4)));
+    return x + Vect128f(_mm_castsi128_ps(
+                   _mm_slli_si128(_mm_castps_si128(x), 8)));
+    #endif
+}
+
+/// Every lane set to the last lane of v
+inline Vect128i broadcastLast(const Vect128i& v) {
+    return shuffle<3, 3, 3, 3>(v);
+}
+
+inline Vect128f broadcastLast(const Vect128f& v) {
+    return shuffle<3, 3, 3, 3>(v);
+}
+
+#ifdef HAVE_AVX
+inline Vect256i scan(const Vect256i& v) {
+    Vect128i lo = scan(low(v));
+    Vect128i hi = scan(high(v)) + broadcastLast(lo);
+    return combine(lo, hi);
+}
+
+inline Vect256f scan(const Vect256f& v) {
+    Vect128f lo = scan(low(v));
+    Vect128f hi = scan(high(v)) + broadcastLast(lo);
+    return combine(lo, hi);
+}
+
+inline Vect256i broadcastLast(const Vect256i& v) {
+    Vect128i last = broadcastLast(high(v));
+    return combine(last, last);
+}
+
+inline Vect256f broadcastLast(const Vect256f& v) {
+    Vect128f last = broadcastLast(high(v));
+    return combine(last, last);
+}
+#endif
+
+#ifdef HAVE_AVX512F
+SIGHT_AVX512_WARNINGS_BEGIN
+
+/// Lanes of v moved up by N, zeros shifted in
+template <int N>
+inline __m512i shiftLanes(__m512i v) {
+    return _mm512_alignr_epi32(v, _mm512_setzero_si512(), 16 - N);
+}
+
+inline Vect512i scan(const Vect512i& v) {
+    Vect512i x = v + Vect512i(shiftLanes<1>(v));
+    x = x + Vect512i(shiftLanes<2>(x));
+    x = x + Vect512i(shiftLanes<4>(x));
+    return x + Vect512i(shiftLanes<8>(x));
+}
+
+inline Vect512f scan(const Vect512f& v) {
+    Vect512f x = v;
+    x = x + Vect512f(_mm512_castsi512_ps(
+                shiftLanes<1>(_mm512_castps_si512(x))));
+    x = x + Vect512f(_mm512_castsi512_ps(
+                shiftLanes<2>(_mm512_castps_si512(x))));
+    x = x + Vect512f(_mm512_castsi512_ps(
+                shiftLanes<4>(_mm512_castps_si512(x))));
+    return x + Vect512f(_mm512_castsi512_ps(
+                   shiftLanes<8>(_mm512_castps_si512(x))));
+}
+
+inline Vect512i broadcastLast(const Vect512i& v) {
+    return _mm512_permutexvar_epi32(_mm512_set1_epi32(15), v);
+}
+
+inline Vect512f broadcastLast(const Vect512f& v) {
+    return _mm512_permutexvar_ps(_mm512_set1_epi32(15), v);
+}
+
+SIGHT_AVX512_WARNINGS_END
+#endif
+
+}  // namespace detail
+
+/**
+ * @brief Index of the first value pred matches (like std::find_if)
+ *
+ * @param V vector type to search with (the widest one for T by default)
+ * @param src values to search
+ * @param pred functor taking a V and returning a comparison result
+ * @return index of the first match, or src.length() if there's none
+ */
+template <typename V, typename T, int Align, typename Pred>
+inline size_t find_if(const AlignedStorage<T, Align>& src, Pred pred) {
+    const T* s = src;
+    if (isAligned<sizeof(V)>(s)) {
+        return detail::findIf<V, true>(s, src.length(), pred);
+    }
+    return detail::findIf<V, false>(s, src.length(), pred);
+}
+
+/**
+ * @brief Index of the first value pred matches, using the widest vector
+ */
+template <typename T, int Align, typename Pred>
+inline size_t find_if(const AlignedStorage<T, Align>& src, Pred pred) {
+    return find_if<typename detail::Widest<T>::type>(src, pred);
+}
+
+/**
+ * @brief Index of the first value equal to value (like std::find)
+ *
+ * Finding a byte, ie. the next '\n', checks 64 bytes per branch
+ *
+ * @param V vector type to search with (the widest one for T by default)
+ * @param src values to search
+ * @param value value to look for
+ * @return index of the first match, or src.length() if there's none
+ */
+template <typename V, typename T, int Align>
+inline size_t find(const AlignedStorage<T, Align>& src,
+                   typename detail::Identity<T>::type value) {
+    return find_if<V>(src, detail::Equals<V>{value});
+}
+
+/**
+ * @brief Index of the first value equal to value, using the widest vector
+ */
+template <typename T, int Align>
+inline size_t find(const AlignedStorage<T, Align>& src,
+                   typename detail::Identity<T>::type value) {
+    return find<typename detail::Widest<T>::type>(src, value);
+}
+
+/**
+ * @brief Amount of values pred matches (like std::count_if)
+ *
+ * @param V vector type to count with (the widest one for T by default)
+ * @param src values to check
+ * @param pred functor taking a V and returning a comparison result
+ */
+template <typename V, typename T, int Align, typename Pred>
+inline size_t count_if(const AlignedStorage<T, Align>& src, Pred pred) {
+    const T* s = src;
+    if (isAligned<sizeof(V)>(s)) {
+        return detail::countIf<V, true>(s, src.length(), pred);
+    }
+    return detail::countIf<V, false>(s, src.length(), pred);
+}
+
+/**
+ * @brief Amount of values pred matches, using the widest vector
+ */
+template <typename T, int Align, typename Pred>
+inline size_t count_if(const AlignedStorage<T, Align>& src, Pred pred) {
+    return count_if<typename detail::Widest<T>::type>(src, pred);
+}
+
+/**
+ * @brief Amount of values equal to value (like std::count)
+ */
+template <typename V, typename T, int Align>
+inline size_t count(const AlignedStorage<T, Align>& src,
+                    typename detail::Identity<T>::type value) {
+    return count_if<V>(src, detail::Equals<V>{value});
+}
+
+/**
+ * @brief Amount of values equal to value, using the widest vector
+ */
+template <typename T, int Align>
+inline size_t count(const AlignedStorage<T, Align>& src,
+                    typename detail::Identity<T>::type value) {
+    return count<typename detail::Widest<T>::type>(src, value);
+}
+
+/**
+ * @brief Checks if two arrays have the same length and values
+ *
+ * Values are compared with ==, so like std::equal a NaN is never equal and
+ * 0 equals -0. Stops at the first vector that differs
+ *
+ * @param V vector type to compare with (the widest one for T by default)
+ */
+template <typename V, typename T, int Align, int Align2>
+inline bool equal(const AlignedStorage<T, Align>& a,
+                  const AlignedStorage<T, Align2>& b) {
+    const size_t length = a.length();
+    if (b.length() != length) {
+        return false;
+    }
+    const T* pa = a;
+    const T* pb = b;
+    const uint32_t every = static_cast<uint32_t>(detail::lowBits(V::lanes));
+    size_t i = 0;
+    for (; room<V::lanes>(i, length); i += V::lanes) {
+        if (movemask(V::loadu(pa + i) == V::loadu(pb + i)) != every) {
+            return false;
+        }
+    }
+    if (i < length) {
+        const int n = static_cast<int>(length - i);
+        // zero padding compares equal
+        return movemask(V::load_partial(pa + i, n)
+                        == V::load_partial(pb + i, n)) == every;
+    }
+    return true;
+}
+
+/**
+ * @brief Checks if two arrays are equal, using the widest vector
+ */
+template <typename T, int Align, int Align2>
+inline bool equal(const AlignedStorage<T, Align>& a,
+                  const AlignedStorage<T, Align2>& b) {
+    return equal<typename detail::Widest<T>::type>(a, b);
+}
+
+/**
+ * @brief Index of the first smallest value (like std::min_element)
+ *
+ * Takes two passes: a vector reduction to the smallest value, then a
+ * search for it. NaN values are skipped
+ *
+ * @param V vector type to search with (the widest one for T by default)
+ * @param src values to search
+ * @return index of the smallest value, or src.length() if src is empty or
+ * only holds NaN
+ */
+template <typename V, typename T, int Align>
+inline size_t min_element(const AlignedStorage<T, Align>& src) {
+    return detail::element<V, detail::Smallest>(src);
+}
+
+/**
+ * @brief Index of the first smallest value, using the widest vector
+ */
+template <typename T, int Align>
+inline size_t min_element(const AlignedStorage<T, Align>& src) {
+    return min_element<typename detail::Widest<T>::type>(src);
+}
+
+/**
+ * @brief Index of the first largest value (like std::max_element)
+ *
+ * @see min_element()
+ */
+template <typename V, typename T, int Align>
+inline size_t max_element(const AlignedStorage<T, Align>& src) {
+    return detail::element<V, detail::Largest>(src);
+}
+
+/**
+ * @brief Index of the first largest value, using the widest vector
+ */
+template <typename T, int Align>
+inline size_t max_element(const AlignedStorage<T, Align>& src) {
+    return max_element<typename detail::Widest<T>::type>(src);
+}
+
+/**
+ * @brief Running totals, dst[i] = src[0] + ... + src[i]
+ *
+ * Each vector is summed up in log2(lanes) shift and add steps, then the
+ * total of the vectors before it is added. Float sums are rounded in a
+ * different order than a scalar loop would. int32 and float only
+ *
+ * @param V vector type to sum with (NativeVect<T> by default)
+ * @param src values to sum
+ * @param dst where to store the totals, can be the same storage as src
+ */
+template <typename V, typename T, int Align, int Align2>
+inline void prefix_sum(const AlignedStorage<T, Align>& src,
+                       AlignedStorage<T, Align2>& dst) {
+    if (dst.length() < src.length()) {
+        throw std::out_of_range("destination is smaller than source");
+    }
+    const size_t length = src.length();
+    const T* s = src;
+    T* d = dst;
+    V carry(0);
+    size_t i = 0;
+    for (; room<V::lanes>(i, length); i += V::lanes) {
+        V x = detail::scan(V::loadu(s + i)) + carry;
+        x.storeu(d + i);
+        carry = detail::broadcastLast(x);
+    }
+    if (i < length) {
+        const int n = static_cast<int>(length - i);
+        V x = detail::scan(V::load_partial(s + i, n)) + carry;
+        x.store_partial(d + i, n);
+    }
+}
+
+/**
+ * @brief Running totals using NativeVect<T>
+ */
+template <typename T, int Align, int Align2>
+inline void prefix_sum(const AlignedStorage<T, Align>& src,
+                       AlignedStorage<T, Align2>& dst) {
+    prefix_sum<NativeVect<T>>(src, dst);
+}
+
+}  // namespace sight
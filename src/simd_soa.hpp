@@ -0,0 +1,217 @@
+#pragma once
+
+#include "simd.hpp"
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+
+namespace sight {
+namespace detail {
+
+/// Compile time list of indices (std::index_sequence is C++14)
+template <size_t... I>
+struct Indices {};
+
+template <size_t N, size_t... I>
+struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+
+template <size_t... I>
+struct MakeIndices<0, I...> {
+    typedef Indices<I...> type;
+};
+
+/// Smallest sizeof of a list of types
+template <typename T>
+constexpr size_t smallest() {
+    return sizeof(T);
+}
+
+template <typename T, typename U, typename... Rest>
+constexpr size_t smallest() {
+    return sizeof(T) < smallest<U, Rest...>() ? sizeof(T)
+                                              : smallest<U, Rest...>();
+}
+
+}  // namespace detail
+
+/**
+ * @brief Structure of arrays, one aligned column per field
+ *
+ * Records with fields Fields... are stored column by column, so a vector
+ * load gives the same field of consecutive records. Every column starts on
+ * a cache line and all of them are padded (with zeros) to the same length,
+ * a whole number of cache lines for the smallest field, so full width
+ * aligned loads and stores never need a remainder loop.
+ *
+ * @code
+ * struct Particle { float x, y; int32_t id; };
+ * SoA<float, float, int32_t> soa(count);
+ * soa.fromAoS(particles, count, &Particle::x, &Particle::y, &Particle::id);
+ * for (size_t i = 0; i < soa.padded(); i += Vect128f::lanes) {
+ *     soa.store<0>(i, soa.load<0, Vect128f>(i) + soa.load<1, Vect128f>(i));
+ * }
+ * @endcode
+ */
+template <typename... Fields>
+class SoA {
+  public:
+    /// Alignment (and padding granularity) of each column
+    static const int Align = 64;
+
+    /// Type of field I
+    template <size_t I>
+    using Field = typename std::tuple_element<I, std::tuple<Fields...>>::type;
+
+    /// Column storing field I
+    template <size_t I>
+    using Column = AlignedStorage<Field<I>, Align>;
+
+    /**
+     * @brief Allocates zeroed columns for length records
+     *
+     * @param length amount of records
+     */
+    explicit SoA(size_t length)
+        : count(length),
+          columns(AlignedStorage<Fields, Align>(pad(length))...) {
+        clear(Indexes());
+    }
+
+    /// Amount of records
+    inline size_t size() const {
+        return count;
+    }
+
+    /**
+     * @brief Length of the columns including padding
+     *
+     * Loops over whole vectors can run up to here, the padding starts out as
+     * zero and isn't part of any record
+     */
+    inline size_t padded() const {
+        return pad(count);
+    }
+
+    /**
+     * @brief Storage of field I
+     */
+    template <size_t I>
+    inline Column<I>& column() {
+        return std::get<I>(columns);
+    }
+
+    /**
+     * @brief Storage of field I
+     */
+    template <size_t I>
+    inline const Column<I>& column() const {
+        return std::get<I>(columns);
+    }
+
+    /**
+     * @brief Loads field I of records [i, i + V::lanes)
+     *
+     * @param V vector type, the widest one for the field type by default
+     * @param i first record, a multiple of V::lanes
+     */
+    template <size_t I, typename V = typename detail::Widest<Field<I>>::type>
+    inline V load(size_t i) const {
+        return V::load(static_cast<const Field<I>*>(column<I>()) + i);
+    }
+
+    /**
+     * @brief Stores v into field I of records [i, i + V::lanes)
+     *
+     * @param i first record, a multiple of V::lanes
+     * @param v values to store
+     */
+    template <size_t I, typename V>
+    inline void store(size_t i, const V& v) {
+        v.store(static_cast<Field<I>*>(column<I>()) + i);
+    }
+
+    /**
+     * @brief Copies records from an array of structs into the columns
+     *
+     * @param src records to copy
+     * @param length amount of records, at most size()
+     * @param members member of S for each field, in order
+     */
+    template <typename S>
+    inline void fromAoS(const S* src, size_t length,
+                        Fields S::*... members) {
+        check(length);
+        copyIn(Indexes(), src, length, members...);
+    }
+
+    /**
+     * @brief Copies the columns back into an array of structs
+     *
+     * @param dst records to write (only the given members are touched)
+     * @param length amount of records, at most size()
+     * @param members member of S for each field, in order
+     */
+    template <typename S>
+    inline void toAoS(S* dst, size_t length, Fields S::*... members) const {
+        check(length);
+        copyOut(Indexes(), dst, length, members...);
+    }
+
+  private:
+    typedef typename detail::MakeIndices<sizeof...(Fields)>::type Indexes;
+
+    static inline size_t pad(size_t length) {
+        const size_t block = Align / detail::smallest<Fields...>();
+        return (length + block - 1) / block * block;
+    }
+
+    inline void check(size_t length) const {
+        if (length > count) {
+            throw std::out_of_range("more records than the SoA holds");
+        }
+    }
+
+    template <size_t... I>
+    inline void clear(detail::Indices<I...>) {
+        int expand[] = {0, (std::get<I>(columns).clear(), 0)...};
+        (void)expand;
+    }
+
+    // one column at a time, so the writes are sequential
+    template <typename S, size_t... I>
+    inline void copyIn(detail::Indices<I...>, const S* src, size_t length,
+                       Fields S::*... members) {
+        int expand[] = {0, (copyColumn<Field<I>>(column<I>(), src, length,
+                                                 members), 0)...};
+        (void)expand;
+    }
+
+    template <typename S, size_t... I>
+    inline void copyOut(detail::Indices<I...>, S* dst, size_t length,
+                        Fields S::*... members) const {
+        int expand[] = {0, (spreadColumn<Field<I>>(column<I>(), dst, length,
+                                                   members), 0)...};
+        (void)expand;
+    }
+
+    template <typename T, typename S>
+    static inline void copyColumn(T* column, const S* src, size_t length,
+                                  T S::*member) {
+        for (size_t i = 0; i < length; i++) {
+            column[i] = src[i].*member;
+        }
+    }
+
+    template <typename T, typename S>
+    static inline void spreadColumn(const T* column, S* dst, size_t length,
+                                    T S::*member) {
+        for (size_t i = 0; i < length; i++) {
+            dst[i].*member = column[i];
+        }
+    }
+
+    size_t count;
+    std::tuple<AlignedStorage<Fields, Align>...> columns;
+};
+
+}  // namespace sight
@@ -0,0 +1,294 @@
+#pragma once
+
+#include "simd.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
+/*
+ * Opt-in counters for the hot paths, to see in production which call sites
+ * miss the vector fast path (unaligned arrays, short inputs, remainders) and
+ * where the time goes.
+ *
+ * Define SIGHT_INSTRUMENT (for the whole program, every translation unit has
+ * to agree) to enable them. Without it the SIGHT_COUNT and SIGHT_TIME hooks
+ * expand to nothing and statsSnapshot() only ever returns zeros, so exporting
+ * code doesn't need its own #ifdef.
+ *
+ * Each hit is a relaxed atomic add on a counter shared by every thread, which
+ * is cheap next to a kernel call but not next to a single load, so expect
+ * loops of Vect128f/Vect128i loads to slow down a few times when enabled.
+ *
+ * @code
+ * StatsSnapshot s = statsSnapshot();
+ * for (int k = 0; k < int(Kernel::Count); k++) {
+ *     metrics.add(kernelName(Kernel(k)), s.kernels[k].calls,
+ *                 s.kernels[k].cycles);
+ * }
+ * @endcode
+ */
+
+#ifdef SIGHT_INSTRUMENT
+    /// Adds one to a sight::Counter
+    #define SIGHT_COUNT(counter) \
+        ::sight::detail::countEvent(::sight::Counter::counter)
+    /// Times the rest of the scope as one call of a sight::Kernel
+    #define SIGHT_TIME(kernel, values) \
+        ::sight::detail::KernelTimer sight_timer_(::sight::Kernel::kernel, \
+                                                  values)
+    /// Adds one call to a dispatch tier (a sight::Isa)
+    #define SIGHT_DISPATCHED(isa) \
+        ::sight::detail::countDispatch(static_cast<int>(isa))
+#else
+    #define SIGHT_COUNT(counter) ((void)0)
+    #define SIGHT_TIME(kernel, values) ((void)0)
+    #define SIGHT_DISPATCHED(isa) ((void)0)
+#endif
+
+namespace sight {
+
+/**
+ * @brief Events counted by SIGHT_COUNT
+ *
+ * The loads and stores are the ones of Vect128f and Vect128i. Without AVX
+ * (and on NEON) partial loads and stores go through a buffer, so they also
+ * add an aligned load or store. The runs and tails are counted once per call
+ * of a bulk kernel, or once per chunk for the parallel ones
+ */
+enum class Counter : int {
+    AlignedLoad,
+    UnalignedLoad,
+    PartialLoad,
+    AlignedStore,
+    UnalignedStore,
+    PartialStore,
+    StreamStore,
+    /// Bulk kernel runs with streaming stores
+    StreamedRun,
+    /// Bulk kernel runs where every array was aligned
+    AlignedRun,
+    /// Bulk kernel runs that needed unaligned loads or stores
+    UnalignedRun,
+    /// Remainders done by recomputing the last whole vector
+    OverlappedTail,
+    /// Remainders done with a zero padded vector
+    PartialTail,
+    /// reduce() inputs shorter than a vector, folded one value at a time
+    ScalarInput,
+    Count
+};
+
+/**
+ * @brief Kernels timed by SIGHT_TIME
+ *
+ * Dispatch covers every sight::dispatch kernel, whatever the tier
+ */
+enum class Kernel : int {
+    Transform,
+    Zip,
+    Reduce,
+    Evaluate,
+    ParallelTransform,
+    ParallelZip,
+    ParallelReduce,
+    ParallelEvaluate,
+    Dispatch,
+    Count
+};
+
+/// Calls, values processed and time spent in one kernel
+struct KernelStats {
+    uint64_t calls;
+    uint64_t values;
+    /// Time stamp counter ticks (rdtsc on x86), not core clock cycles
+    uint64_t cycles;
+};
+
+/**
+ * @brief Copy of every counter at one point in time
+ *
+ * Counters keep running while the copy is taken, so values from different
+ * threads can be a few events apart
+ */
+struct StatsSnapshot {
+    /// If the program was built with SIGHT_INSTRUMENT
+    bool enabled;
+    uint64_t counters[static_cast<int>(Counter::Count)];
+    KernelStats kernels[static_cast<int>(Kernel::Count)];
+    /// Dispatched calls per tier, indexed by static_cast<int>(Isa)
+    uint64_t dispatched[4];
+
+    /**
+     * @brief Value of one counter
+     *
+     * @param c counter to read
+     */
+    inline uint64_t operator[](Counter c) const {
+        return counters[static_cast<int>(c)];
+    }
+
+    /**
+     * @brief Statistics of one kernel
+     *
+     * @param k kernel to read
+     */
+    inline const KernelStats& operator[](Kernel k) const {
+        return kernels[static_cast<int>(k)];
+    }
+};
+
+namespace detail {
+
+enum {
+    counterCount = static_cast<int>(Counter::Count),
+    kernelCount = static_cast<int>(Kernel::Count),
+    tierCount = 4
+};
+
+/// Shared by every thread, one instance for the whole program
+struct Stats {
+    std::atomic<uint64_t> counters[counterCount];
+    std::atomic<uint64_t> calls[kernelCount];
+    std::atomic<uint64_t> values[kernelCount];
+    std::atomic<uint64_t> cycles[kernelCount];
+    std::atomic<uint64_t> dispatched[tierCount];
+
+    inline Stats() {
+        reset();
+    }
+
+    inline void reset() {
+        for (int c = 0; c < counterCount; c++) {
+            counters[c].store(0, std::memory_order_relaxed);
+        }
+        for (int k = 0; k < kernelCount; k++) {
+            calls[k].store(0, std::memory_order_relaxed);
+            values[k].store(0, std::memory_order_relaxed);
+            cycles[k].store(0, std::memory_order_relaxed);
+        }
+        for (int t = 0; t < tierCount; t++) {
+            dispatched[t].store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+inline Stats& stats() {
+    static Stats s;
+    return s;
+}
+
+/// Reads the time stamp counter, or the closest thing on other CPUs
+inline uint64_t cycles() {
+    #if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+    #elif defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+    #else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+    #endif
+}
+
+inline void countEvent(Counter c) {
+    stats().counters[static_cast<int>(c)].fetch_add(
+        1, std::memory_order_relaxed);
+}
+
+inline void countDispatch(int tier) {
+    stats().dispatched[tier].fetch_add(1, std::memory_order_relaxed);
+}
+
+/// Adds a call of kernel k, and the time until it goes out of scope
+class KernelTimer {
+    const int kernel;
+    const uint64_t start;
+
+  public:
+    inline KernelTimer(Kernel k, size_t values)
+        : kernel(static_cast<int>(k)), start(cycles()) {
+        stats().calls[kernel].fetch_add(1, std::memory_order_relaxed);
+        stats().values[kernel].fetch_add(values, std::memory_order_relaxed);
+    }
+
+    inline ~KernelTimer() {
+        stats().cycles[kernel].fetch_add(cycles() - start,
+                                         std::memory_order_relaxed);
+    }
+
+    KernelTimer(const KernelTimer&) = delete;
+    KernelTimer& operator=(const KernelTimer&) = delete;
+};
+
+}  // namespace detail
+
+/**
+ * @brief Copies every counter, ie. to export them to a metrics system
+ *
+ * All zeros unless the program was built with SIGHT_INSTRUMENT
+ */
+inline StatsSnapshot statsSnapshot() {
+    StatsSnapshot s;
+    #ifdef SIGHT_INSTRUMENT
+    s.enabled = true;
+    #else
+    s.enabled = false;
+    #endif
+    detail::Stats& current = detail::stats();
+    for (int c = 0; c < detail::counterCount; c++) {
+        s.counters[c] = current.counters[c].load(std::memory_order_relaxed);
+    }
+    for (int k = 0; k < detail::kernelCount; k++) {
+        s.kernels[k].calls = current.calls[k].load(std::memory_order_relaxed);
+        s.kernels[k].values = current.values[k].load(std::memory_order_relaxed);
+        s.kernels[k].cycles = current.cycles[k].load(std::memory_order_relaxed);
+    }
+    for (int t = 0; t < detail::tierCount; t++) {
+        s.dispatched[t] = current.dispatched[t].load(std::memory_order_relaxed);
+    }
+    return s;
+}
+
+/**
+ * @brief Sets every counter back to zero
+ *
+ * Events from other threads that run at the same time may or may not be
+ * kept
+ */
+inline void resetStats() {
+    detail::stats().reset();
+}
+
+/**
+ * @brief Name of a counter, for exporting (ie. "unaligned_load")
+ *
+ * @param c counter to name
+ */
+inline const char* counterName(Counter c) {
+    static const char* const names[detail::counterCount] = {
+        "aligned_load", "unaligned_load", "partial_load", "aligned_store",
+        "unaligned_store", "partial_store", "stream_store", "streamed_run",
+        "aligned_run", "unaligned_run", "overlapped_tail", "partial_tail",
+        "scalar_input"};
+    return names[static_cast<int>(c)];
+}
+
+/**
+ * @brief Name of a kernel, for exporting (ie. "parallel_reduce")
+ *
+ * @param k kernel to name
+ */
+inline const char* kernelName(Kernel k) {
+    static const char* const names[detail::kernelCount] = {
+        "transform", "zip", "reduce", "evaluate", "parallel_transform",
+        "parallel_zip", "parallel_reduce", "parallel_evaluate", "dispatch"};
+    return names[static_cast<int>(k)];
+}
+
+}  // namespace sight
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "simd.hpp"
+#include <cstddef>
+
+/*
+ * Loop unrolling at compile time, to keep several independent operations
+ * in flight.
+ *
+ * A loop like acc = acc + x[i] waits for every add to finish before the
+ * next one starts (about 4 cycles for floats on most CPUs), while the CPU
+ * could start one or two per cycle. Splitting acc in K accumulators that
+ * only get merged after the loop hides that latency.
+ *
+ * @code
+ * MultiAccumulator<NativeVectf, 4> acc(NativeVectf(0));
+ * size_t i = unrolled<NativeVectf, 4>(0, n, [&](size_t j, int k) {
+ *     acc[k] = fma(NativeVectf::loadu(x + j), NativeVectf::loadu(w + j),
+ *                  acc[k]);
+ * });
+ * float dot = acc.sum();  // plus x[i...n) * w[i...n)
+ * @endcode
+ */
+
+namespace sight {
+namespace detail {
+
+template <int I, int K>
+struct Repeat {
+    template <typename F>
+    static inline void run(F& f) {
+        f(I);
+        Repeat<I + 1, K>::run(f);
+    }
+};
+
+template <int K>
+struct Repeat<K, K> {
+    template <typename F>
+    static inline void run(F&) {}
+};
+
+/// Folds Count values starting at First as a balanced tree
+template <int First, int Count>
+struct Merge {
+    template <typename V, typename Op>
+    static inline V run(const V* values, Op& op) {
+        return op(Merge<First, Count / 2>::run(values, op),
+                  Merge<First + Count / 2, Count - Count / 2>::run(values,
+                                                                   op));
+    }
+};
+
+template <int First>
+struct Merge<First, 1> {
+    template <typename V, typename Op>
+    static inline V run(const V* values, Op&) {
+        return values[First];
+    }
+};
+
+template <typename V>
+struct Sum {
+    inline V operator()(const V& a, const V& b) const {
+        return a + b;
+    }
+};
+
+}  // namespace detail
+
+/**
+ * @brief Calls f(0), f(1) ... f(K - 1), unrolled at compile time
+ *
+ * @param K amount of calls
+ * @param f functor taking an int
+ */
+template <int K, typename F>
+inline void repeat(F f) {
+    static_assert(K >= 0, "negative amount of calls");
+    detail::Repeat<0, K>::run(f);
+}
+
+/**
+ * @brief Runs over the whole vectors of [begin, length), K per iteration
+ *
+ * Calls f(j, k) for each vector starting at j, where k cycles through
+ * 0 ... K - 1 and picks which accumulator to use, so K vectors that don't
+ * depend on each other go through the loop body at once. The last vectors
+ * that don't make a group of K are done one by one with k = 0
+ *
+ * @param V vector type, for the amount of lanes
+ * @param K vectors per iteration
+ * @param begin index of the first value
+ * @param length total amount of values
+ * @param f functor taking a size_t index and an int accumulator number
+ * @return where the whole vectors end, fewer than V::lanes values remain
+ */
+template <typename V, int K, typename F>
+inline size_t unrolled(size_t begin, size_t length, F f) {
+    static_assert(K > 0, "at least one vector per iteration");
+    const size_t L = V::lanes;
+    size_t i = begin;
+    for (; i + K * L <= length; i += K * L) {
+        repeat<K>([&](int k) { f(i + k * L, k); });
+    }
+    for (; i + L <= length; i += L) {
+        f(i, 0);
+    }
+    return i;
+}
+
+/**
+ * @brief K independent vector accumulators, merged at the end
+ *
+ * merge() combines them as a balanced tree, so the amount of rounding
+ * steps on floats is the same as in a single accumulator, but in another
+ * order
+ *
+ * @param V vector type
+ * @param K amount of accumulators, 4 to 8 hide the latency of most ops
+ */
+template <typename V, int K>
+class MultiAccumulator {
+    static_assert(K > 0, "at least one accumulator");
+    V acc[K];
+
+  public:
+    /// Amount of accumulators
+    enum { count = K };
+
+    /**
+     * @brief Starts every accumulator at the same value
+     *
+     * @param init identity of the operation, ie. 0 for sums
+     */
+    inline explicit MultiAccumulator(const V& init) {
+        for (int k = 0; k < K; k++) {
+            acc[k] = init;
+        }
+    }
+
+    /**
+     * @brief Accumulator k, not bounds checked
+     *
+     * @param k accumulator number (0 - K-1)
+     */
+    inline V& operator[](int k) {
+        return acc[k];
+    }
+
+    /**
+     * @brief Accumulator k, not bounds checked
+     *
+     * @param k accumulator number (0 - K-1)
+     */
+    inline const V& operator[](int k) const {
+        return acc[k];
+    }
+
+    /**
+     * @brief Combines the accumulators into one vector
+     *
+     * @param op functor taking two V and returning a V
+     */
+    template <typename Op>
+    inline V merge(Op op) const {
+        return detail::Merge<0, K>::run(acc, op);
+    }
+
+    /**
+     * @brief Adds every lane of every accumulator together
+     */
+    inline typename V::value_type sum() const {
+        return hsum(merge(detail::Sum<V>()));
+    }
+};
+
+}  // namespace sight
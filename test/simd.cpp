@@ -1,17 +1,11 @@
 #include <gtest/gtest.h>
 
 #include "simd.hpp"
+#include "test.hpp"
 #include <cmath>
 
 using namespace sight;
 
-template <typename T, typename B>
-void checkEqual(T p, B p1, size_t size) {
-    for (int x = 0; x < size; x++) {
-        ASSERT_EQ(p[x], p1[x]);
-    }
-}
-
 TEST(simd, aligned_ptr) {
     AlignedStorage<float, 128> f(256);
     ASSERT_EQ(0, ((uintptr_t) (float*) f) % 128);
@@ -69,6 +63,14 @@ TEST(simd, vect128i_construction) {
         checkEqual(i, p, 4);
     }
 
+    {
+        AlignedStorage<int32_t, 16> p(4);
+        Vect128i i(0, 1, 2, 3);
+        i.stream(p);
+        streamFence();
+        checkEqual(i, p, 4);
+    }
+
     {
         Vect128i i(0, 1, 2, 3);
         Vect128i d; d = i;
@@ -89,7 +91,11 @@ TEST(simd, vect128i_construction) {
 
     {
         Vect128i p(0, 1, 2, 3);
+        #ifdef HAVE_NEON
+        int32x4_t m = p;
+        #else
         __m128i m = p;
+        #endif
         Vect128i pd = m;
         int s[4] = {0, 1, 2, 3};
         checkEqual(pd, s, 4);
@@ -271,6 +277,14 @@ TEST(simd, vect128f_construction) {
         checkEqual(i, p, 4);
     }
 
+    {
+        AlignedStorage<float, 16> p(4);
+        Vect128f i(0, 0.1, 1, 2);
+        i.stream(p);
+        streamFence();
+        checkEqual(i, p, 4);
+    }
+
     {
         Vect128f i(0, 0.1, 1, 2);
         Vect128f d; d = i;
@@ -291,7 +305,11 @@ TEST(simd, vect128f_construction) {
 
     {
         Vect128f p(0, 0.1, 1, 2);
+        #ifdef HAVE_NEON
+        float32x4_t m = p;
+        #else
         __m128 m = p;
+        #endif
         Vect128f pd = m;
         float s[4] = {0, 0.1, 1, 2};
         checkEqual(pd, s, 4);
@@ -493,6 +511,133 @@ TEST(simd, vect128f_operators) {
     }
 }
 
+template <typename V>
+void checkGeneric() {
+    typedef typename V::value_type T;
+    T in[V::lanes], out[V::lanes];
+    for (int x = 0; x < V::lanes; x++) {
+        in[x] = static_cast<T>(x - 2);
+    }
+
+    auto v = V::loadu(in);
+    highest(v * v - V(1), V(0)).storeu(out);
+    for (int x = 0; x < V::lanes; x++) {
+        ASSERT_EQ(std::max<T>(in[x] * in[x] - 1, 0), out[x]);
+    }
+}
+
+TEST(simd, vect_generic) {
+    static_assert(std::is_same<Vect128f, Vect<float, 4>>::value, "alias");
+    static_assert(std::is_same<Vect128i, Vect<int32_t, 4>>::value, "alias");
+    static_assert(NativeVectf::lanes * sizeof(float) == native_width,
+                  "native width");
+    static_assert(int(NativeVecti::lanes) == int(NativeVectf::lanes),
+                  "native lanes");
+
+    checkGeneric<Vect128f>();
+    checkGeneric<Vect128i>();
+    checkGeneric<NativeVectf>();
+    checkGeneric<NativeVecti>();
+}
+
+TEST(simd, vect128_select) {
+    checkSelect<Vect128i>();
+    checkSelect<Vect128f>();
+
+    Mask128 m = Vect128i(1, 2, 3, 4) > Vect128i(2);
+    ASSERT_EQ(0xCu, m.bits());
+    ASSERT_EQ(0x3u, (~m).bits());
+    ASSERT_TRUE(m[3]);
+    ASSERT_FALSE(m[0]);
+    ASSERT_EQ(0x4u, (m & Mask128(Vect128f(1, 2, 3, 4) < Vect128f(4))).bits());
+    ASSERT_EQ(0xDu, (m | Mask128(Vect128f(1, 2, 3, 4) == Vect128f(1))).bits());
+}
+
+TEST(simd, vect128_partial) {
+    checkPartial<Vect128i>();
+    checkPartial<Vect128f>();
+}
+
+TEST(simd, vect128_gather) {
+    checkGather<Vect128i>();
+    checkGather<Vect128f>();
+}
+
+TEST(simd, vect128_rounding) {
+    checkRounding<Vect128f>();
+}
+
+TEST(simd, vect128_shuffle) {
+    Vect128i i(1, 2, 3, 4);
+    checkEqual(shuffle<3, 2, 1, 0>(i), Vect128i(4, 3, 2, 1), 4);
+    checkEqual(shuffle<0, 0, 2, 2>(i), Vect128i(1, 1, 3, 3), 4);
+    Vect128f f(1, 2, 3, 4), f2(5, 6, 7, 8);
+    checkEqual(shuffle<1, 1, 0, 3>(f), Vect128f(2, 2, 1, 4), 4);
+    checkEqual(shuffle<0, 1, 2, 3>(f, f2), Vect128f(1, 2, 7, 8), 4);
+    checkEqual(unpacklo(f, f2), Vect128f(1, 5, 2, 6), 4);
+    checkEqual(unpackhi(f, f2), Vect128f(3, 7, 4, 8), 4);
+    checkEqual(unpacklo(i, Vect128i(0)), Vect128i(1, 0, 2, 0), 4);
+    checkEqual(unpackhi(i, Vect128i(0)), Vect128i(3, 0, 4, 0), 4);
+
+    // four xyzw points become one vector per coordinate
+    float points[16];
+    for (int x = 0; x < 16; x++) {
+        points[x] = static_cast<float>(x);
+    }
+    Vect128f r0 = Vect128f::loadu(points), r1 = Vect128f::loadu(points + 4);
+    Vect128f r2 = Vect128f::loadu(points + 8);
+    Vect128f r3 = Vect128f::loadu(points + 12);
+    transpose(r0, r1, r2, r3);
+    checkEqual(r0, Vect128f(0, 4, 8, 12), 4);
+    checkEqual(r1, Vect128f(1, 5, 9, 13), 4);
+    checkEqual(r3, Vect128f(3, 7, 11, 15), 4);
+    transpose(r0, r1, r2, r3);
+    checkEqual(r2, Vect128f(8, 9, 10, 11), 4);
+
+    Vect128i c0(0, 1, 2, 3), c1(4, 5, 6, 7);
+    Vect128i c2(8, 9, 10, 11), c3(12, 13, 14, 15);
+    transpose(c0, c1, c2, c3);
+    checkEqual(c0, Vect128i(0, 4, 8, 12), 4);
+    checkEqual(c3, Vect128i(3, 7, 11, 15), 4);
+}
+
+TEST(simd, vect128_shift) {
+    Vect128i v(1, -8, 0x40000000, -1);
+    checkEqual(shl<2>(v), Vect128i(4, -32, 0, -4), 4);
+    checkEqual(shr<1>(v), Vect128i(0, 0x7FFFFFFC, 0x20000000, 0x7FFFFFFF), 4);
+    checkEqual(sar<1>(v), Vect128i(0, -4, 0x20000000, -1), 4);
+    checkEqual(shl<32>(v), Vect128i(0), 4);
+    checkEqual(sar<40>(v), Vect128i(0, -1, 0, -1), 4);
+    checkEqual(shl(v, 2), shl<2>(v), 4);
+    checkEqual(shr(v, 1), shr<1>(v), 4);
+    checkEqual(sar(v, 1), sar<1>(v), 4);
+
+    Vect128i counts(0, 1, 31, 32);
+    checkEqual(shl(v, counts), Vect128i(1, -16, 0, 0), 4);
+    checkEqual(shr(v, counts), Vect128i(1, 0x7FFFFFFC, 0, 0), 4);
+    checkEqual(sar(v, counts), Vect128i(1, -4, 0, -1), 4);
+}
+
+TEST(simd, vect128_horizontal) {
+    checkHorizontal<Vect128i>();
+    checkHorizontal<Vect128f>();
+    checkDot<Vect128f>();
+}
+
+TEST(simd, vect128_fma) {
+    checkFma<Vect128f>();
+
+    #ifdef HAVE_FMA
+    // only a fused multiply-add keeps the rounding error of a * a
+    Vect128f a(1 + 1.0f / 4096);
+    ASSERT_EQ(1.0f / (1 << 24), fma(a, a, Vect128f(0) - a * a)[0]);
+    #endif
+}
+
+TEST(simd, vect128_precision) {
+    checkPrecision<Vect128f>();
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,166 @@
+#include "test.hpp"
+
+using namespace sight;
+
+#ifdef HAVE_SSE
+
+/// Checks the operators shared by every 128 bit integer vector
+template <typename V>
+void checkIntOperators() {
+    typedef typename V::value_type T;
+    ASSERT_EQ(16 / static_cast<int>(sizeof(T)), int(V::lanes));
+
+    alignas(16) T a[V::lanes], b[V::lanes], r[V::lanes];
+    for (int x = 0; x < V::lanes; x++) {
+        a[x] = static_cast<T>(x * 3 + 1);
+        b[x] = static_cast<T>(V::lanes * 2 - x * 2);
+    }
+    V va = V::load(a), vb = V::loadu(b);
+    (va + vb).store(r);
+    for (int x = 0; x < V::lanes; x++) {
+        ASSERT_EQ(static_cast<T>(a[x] + b[x]), r[x]);
+    }
+    (va - vb).storeu(r);
+    for (int x = 0; x < V::lanes; x++) {
+        ASSERT_EQ(static_cast<T>(a[x] - b[x]), r[x]);
+    }
+    V prod = va * vb;
+    V low = lowest(va, vb), high = highest(va, vb);
+    for (int x = 0; x < V::lanes; x++) {
+        ASSERT_EQ(static_cast<T>(a[x] * b[x]), prod[x]);
+        ASSERT_EQ(std::min(a[x], b[x]), low[x]);
+        ASSERT_EQ(std::max(a[x], b[x]), high[x]);
+        ASSERT_EQ(a[x] < b[x], (va < vb)[x] != 0);
+        ASSERT_EQ(a[x] <= b[x], (va <= vb)[x] != 0);
+        ASSERT_EQ(a[x] > b[x], (va > vb)[x] != 0);
+        ASSERT_EQ(a[x] >= b[x], (va >= vb)[x] != 0);
+        ASSERT_EQ(static_cast<T>(a[x] & b[x]), (va & vb)[x]);
+        ASSERT_EQ(static_cast<T>(a[x] | b[x]), (va | vb)[x]);
+        ASSERT_EQ(static_cast<T>(a[x] ^ b[x]), (va ^ vb)[x]);
+        ASSERT_EQ(static_cast<T>(~a[x]), (~va)[x]);
+    }
+
+    V sel = select(va < vb, va, vb);
+    for (int x = 0; x < V::lanes; x++) {
+        ASSERT_EQ(low[x], sel[x]);
+    }
+    ASSERT_TRUE(all(va == va));
+    ASSERT_TRUE(none(va != va));
+    ASSERT_TRUE(any(va < vb));
+
+    V acc = va;
+    acc += vb;
+    acc -= vb;
+    acc *= V(1);
+    acc &= va;
+    acc |= va;
+    acc ^= V(0);
+    ASSERT_TRUE(all(acc == va));
+}
+
+TEST(simd, vect128_int_operators) {
+    checkIntOperators<Vect128i8>();
+    checkIntOperators<Vect128u8>();
+    checkIntOperators<Vect128i16>();
+    checkIntOperators<Vect128u16>();
+    checkIntOperators<Vect128i64>();
+}
+
+TEST(simd, vect128_int_construction) {
+    Vect128u8 u8(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 255);
+    ASSERT_EQ(1, u8[0]);
+    ASSERT_EQ(255, u8[15]);
+    Vect128i16 i16(-1, 2, -3, 4, -5, 6, -7, 32767);
+    ASSERT_EQ(-7, i16[6]);
+    ASSERT_EQ(32767, i16[7]);
+    Vect128i64 i64(-5000000000LL, 7);
+    ASSERT_EQ(-5000000000LL, i64[0]);
+    ASSERT_EQ(7, i64[1]);
+    ASSERT_EQ(-12, Vect128i8(-12)[9]);
+    ASSERT_EQ(60000, Vect128u16(60000)[3]);
+}
+
+TEST(simd, vect128_int_unsigned_order) {
+    // values above the signed range still compare as unsigned
+    Vect128u8 a(200), b(100);
+    ASSERT_TRUE(all(a > b));
+    ASSERT_EQ(200, highest(a, b)[0]);
+    Vect128u16 c(60000), d(5);
+    ASSERT_TRUE(all(c > d));
+    ASSERT_EQ(5, lowest(c, d)[7]);
+    Vect128i64 e(-1), f(1LL << 40);
+    ASSERT_TRUE(all(e < f));
+    ASSERT_EQ(-1, lowest(e, f)[1]);
+    ASSERT_EQ(3000000000LL * 3, (Vect128i64(3000000000LL) * Vect128i64(3))[0]);
+}
+
+TEST(simd, vect128_int_saturated) {
+    ASSERT_EQ(255, add_saturated(Vect128u8(250), Vect128u8(10))[0]);
+    ASSERT_EQ(0, sub_saturated(Vect128u8(5), Vect128u8(10))[0]);
+    ASSERT_EQ(127, add_saturated(Vect128i8(120), Vect128i8(10))[0]);
+    ASSERT_EQ(-128, sub_saturated(Vect128i8(-120), Vect128i8(10))[0]);
+    ASSERT_EQ(32767, add_saturated(Vect128i16(32000), Vect128i16(1000))[0]);
+    ASSERT_EQ(65535, add_saturated(Vect128u16(65000), Vect128u16(1000))[0]);
+    ASSERT_EQ(0, sub_saturated(Vect128u16(1), Vect128u16(2))[0]);
+}
+
+TEST(simd, vect128_int_conversions) {
+    Vect128u8 pixels(0, 1, 2, 3, 4, 5, 6, 7, 200, 201, 202, 203, 204, 205,
+                     206, 255);
+    Vect128u16 lo = widen_lo(pixels), hi = widen_hi(pixels);
+    ASSERT_EQ(7, lo[7]);
+    ASSERT_EQ(255, hi[7]);
+    Vect128u8 back = narrow(lo, hi);
+    ASSERT_TRUE(all(back == pixels));
+    ASSERT_EQ(255, narrow(Vect128u16(1000), lo)[0]);
+
+    Vect128i8 signs(-1, 2, -3, 4, -5, 6, -7, 8, -9, 10, -11, 12, -13, 14, -15,
+                    -128);
+    ASSERT_EQ(-1, widen_lo(signs)[0]);
+    ASSERT_EQ(-128, widen_hi(signs)[7]);
+    ASSERT_TRUE(all(narrow(widen_lo(signs), widen_hi(signs)) == signs));
+    ASSERT_EQ(127, narrow(Vect128i16(300), Vect128i16(0))[0]);
+
+    Vect128i16 samples(-30000, 2, 3, 4, 5, 6, 7, 30000);
+    ASSERT_EQ(-30000, widen_lo(samples)[0]);
+    ASSERT_EQ(30000, widen_hi(samples)[3]);
+    ASSERT_EQ(0, narrow_unsigned(samples, samples)[0]);
+    ASSERT_EQ(255, narrow_unsigned(samples, samples)[7]);
+    ASSERT_EQ(-32768, narrow(Vect128i(-40000), Vect128i(0))[0]);
+    ASSERT_EQ(60000, widen_hi(Vect128u16(60000))[0]);
+    ASSERT_EQ(65535, narrow_unsigned(Vect128i(70000), Vect128i(-5))[0]);
+    ASSERT_EQ(0, narrow_unsigned(Vect128i(70000), Vect128i(-5))[4]);
+    ASSERT_EQ(40000, narrow_unsigned(Vect128i(40000), Vect128i(0))[1]);
+
+    Vect128i ints(-3, 4, -5, 6);
+    ASSERT_EQ(-3, widen_lo(ints)[0]);
+    ASSERT_EQ(6, widen_hi(ints)[1]);
+    Vect128i packed = narrow(widen_lo(ints), widen_hi(ints));
+    checkEqual(packed, ints, 4);
+}
+
+TEST(simd, vect128_int_partial) {
+    checkPartial<Vect128i8>();
+    checkPartial<Vect128u8>();
+    checkPartial<Vect128i16>();
+    checkPartial<Vect128u16>();
+    checkPartial<Vect128i64>();
+}
+
+TEST(simd, vect128_int_lookup) {
+    // popcount of each nibble
+    Vect128u8 counts(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    Vect128u8 idx(0, 1, 2, 3, 4, 5, 6, 7, 15, 14, 13, 12, 16, 0x3F, 0xF7, 255);
+    Vect128u8 r = lookup(counts, idx);
+    for (int i = 0; i < 16; i++) {
+        ASSERT_EQ(counts[idx[i] & 15], r[i]);
+    }
+
+    Vect128i8 table(-8, -7, -6, -5, -4, -3, -2, -1, 0, 1, 2, 3, 4, 5, 6, 7);
+    Vect128i8 s = lookup(table, idx);
+    for (int i = 0; i < 16; i++) {
+        ASSERT_EQ((idx[i] & 15) - 8, s[i]);
+    }
+}
+
+#endif  // HAVE_SSE
@@ -0,0 +1,55 @@
+#include "test.hpp"
+
+using namespace sight;
+
+#ifdef HAVE_SSE
+
+TEST(simd, vect128d_construction) {
+    Vect128d v(1.5, -2.25);
+    ASSERT_EQ(1.5, v[0]);
+    ASSERT_EQ(-2.25, v[1]);
+    ASSERT_EQ(3.0, Vect128d(3.0)[1]);
+
+    alignas(16) double values[2] = {0.1, 1e300};
+    Vect128d loaded = Vect128d::load(values);
+    ASSERT_EQ(1e300, loaded[1]);
+    double out[2];
+    loaded.storeu(out);
+    checkEqual(out, values, 2);
+}
+
+TEST(simd, vect128d_operators) {
+    Vect128d a(1.0, 4.0), b(0.5, 8.0);
+    ASSERT_EQ(1.5, (a + b)[0]);
+    ASSERT_EQ(-4.0, (a - b)[1]);
+    ASSERT_EQ(32.0, (a * b)[1]);
+    ASSERT_EQ(2.0, (a / b)[0]);
+    ASSERT_TRUE(all(a == a));
+    ASSERT_TRUE(none(a != a));
+    ASSERT_TRUE(any(a < b));
+    ASSERT_FALSE(all(a < b));
+    ASSERT_EQ(0.5, lowest(a, b)[0]);
+    ASSERT_EQ(8.0, highest(a, b)[1]);
+    ASSERT_EQ(0.5, select(a < b, a, b)[0]);
+    ASSERT_EQ(4.0, select(a < b, a, b)[1]);
+    ASSERT_EQ(2.0, sqrt(a)[1]);
+    ASSERT_EQ(5.0, hsum(a));
+    ASSERT_EQ(4.5, fma(a, b, Vect128d(4))[0]);
+    ASSERT_EQ(-1.0, (~Vect128d(0.0) & Vect128d(-1.0))[1]);
+    ASSERT_EQ(2.0, (Vect128d(-2.0) ^ Vect128d(-0.0))[0]);
+}
+
+TEST(simd, vect128d_conversions) {
+    Vect128f f(0.1f, 2.5f, -3.0f, 1e30f);
+    ASSERT_EQ(static_cast<double>(0.1f), widen_lo(f)[0]);
+    ASSERT_EQ(1e30f, widen_hi(f)[1]);
+    Vect128f back = narrow(widen_lo(f), widen_hi(f));
+    checkEqual(back, f, 4);
+    ASSERT_EQ(-7.0, to_double(Vect128i(-7, 3, 0, 0))[0]);
+}
+
+TEST(simd, vect128d_partial) {
+    checkPartial<Vect128d>();
+}
+
+#endif  // HAVE_SSE
@@ -0,0 +1,312 @@
+#include <gtest/gtest.h>
+
+#include "simd.hpp"
+#include "test.hpp"
+#include <cmath>
+
+using namespace sight;
+
+#ifdef HAVE_AVX
+
+TEST(simd, vect256i_construction) {
+    {
+        int x[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+        Vect256i i = Vect256i::loadu(x);
+        checkEqual(i, x, 8);
+    }
+
+    {
+        AlignedStorage<int32_t, 32> p(8);
+        for (int x = 0; x < 8; x++) {
+            p[x] = x;
+        }
+        Vect256i i = Vect256i::load(p);
+        checkEqual(i, p, 8);
+    }
+
+    {
+        int q[8];
+        Vect256i i(0, 1, 2, 3, 4, 5, 6, 7);
+        i.storeu(q);
+        checkEqual(q, i, 8);
+    }
+
+    {
+        AlignedStorage<int32_t, 32> p(8);
+        Vect256i i(0, 1, 2, 3, 4, 5, 6, 7);
+        i.store(p);
+        checkEqual(i, p, 8);
+    }
+
+    {
+        AlignedStorage<int32_t, 32> p(8);
+        Vect256i i(0, 1, 2, 3, 4, 5, 6, 7);
+        i.stream(p);
+        streamFence();
+        checkEqual(i, p, 8);
+    }
+
+    {
+        Vect256i i(1);
+        int r[8] = {1, 1, 1, 1, 1, 1, 1, 1};
+        checkEqual(i, r, 8);
+    }
+
+    {
+        Vect256i p(0, 1, 2, 3, 4, 5, 6, 7);
+        __m256i m = p;
+        Vect256i pd = m;
+        int s[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+        checkEqual(pd, s, 8);
+    }
+}
+
+TEST(simd, vect256i_operators) {
+    {
+        Vect256i v(0xFF00FF00);
+        Vect256i s(0x00FF00FF);
+        checkEqual(v, ~s, 8);
+        checkEqual(s, ~v, 8);
+    }
+
+    {
+        Vect256i i(0, -1, 1, 2147483647, 5, 6, -7, 8);
+        Vect256i s(1,  1, 1,          1, 2, 2,  2, 2);
+        Vect256i r(1,  0, 2, 2147483648, 7, 8, -5, 10);
+        checkEqual(r, i + s, 8);
+
+        i += s;
+        checkEqual(r, i, 8);
+    }
+
+    {
+        Vect256i i( 0, -1, 1, 2147483648, 5, 6, -7, 8);
+        Vect256i s( 1,  1, 1,          1, 2, 2,  2, 2);
+        Vect256i r(-1, -2, 0, 2147483647, 3, 4, -9, 6);
+        checkEqual(r, i - s, 8);
+
+        i -= s;
+        checkEqual(r, i, 8);
+    }
+
+    {
+        Vect256i i(0, -1, 1, 2147483648, 5,  6, -7,  8);
+        Vect256i s(1,  1, 1,          1, 2, -2,  2,  3);
+        Vect256i r(0, -1, 1, 2147483648, 10, -12, -14, 24);
+        checkEqual(r, i * s, 8);
+
+        i *= s;
+        checkEqual(r, i, 8);
+    }
+
+    {
+        Vect256i i(0xF0F10);
+        Vect256i s(0xF001F);
+        checkEqual(Vect256i(0xF0F10 & 0xF001F), i & s, 8);
+        checkEqual(Vect256i(0xF0F10 | 0xF001F), i | s, 8);
+        checkEqual(Vect256i(0xF0F10 ^ 0xF001F), i ^ s, 8);
+    }
+
+    {
+        Vect256i i( 0,  1, -1, 2147483647, 3, -3, 4, 4);
+        Vect256i s( 0,  0,  0,          0, 4,  4, 3, 4);
+        checkEqual(Vect256i( 0, -1,  0, -1,  0,  0, -1,  0), i > s, 8);
+        checkEqual(Vect256i( 0,  0, -1,  0, -1, -1,  0,  0), i < s, 8);
+        checkEqual(Vect256i(-1, -1,  0, -1,  0,  0, -1, -1), i >= s, 8);
+        checkEqual(Vect256i(-1,  0, -1,  0, -1, -1,  0, -1), i <= s, 8);
+        checkEqual(Vect256i(-1,  0,  0,  0,  0,  0,  0, -1), i == s, 8);
+        checkEqual(Vect256i( 0, -1, -1, -1, -1, -1, -1,  0), i != s, 8);
+    }
+
+    {
+        Vect256i i(0, 1, -1, 2147483647, 3, -3, 4, 4);
+        Vect256i s(0, 0,  0,          0, 4,  4, 3, 4);
+        checkEqual(Vect256i(0, 0, -1, 0, 3, -3, 3, 4), lowest(i, s), 8);
+        checkEqual(Vect256i(0, 1, 0, 2147483647, 4, 4, 4, 4),
+                   highest(i, s), 8);
+    }
+}
+
+TEST(simd, vect256f_construction) {
+    {
+        Vect256f vect(23);
+        Vect256i vect2 = vect.to_int();
+        checkEqual(vect, vect2, 8);
+    }
+
+    {
+        Vect256i vect(23);
+        Vect256f vect2 = vect;
+        checkEqual(vect, vect2, 8);
+    }
+
+    {
+        float x[8] = {0, 0.1, 1, 2, 3, 4, 5, 6};
+        Vect256f i = Vect256f::loadu(x);
+        checkEqual(i, x, 8);
+    }
+
+    {
+        AlignedStorage<float, 32> p(8);
+        for (int x = 0; x < 8; x++) {
+            p[x] = x * 0.1;
+        }
+        Vect256f i = Vect256f::load(p);
+        checkEqual(i, p, 8);
+    }
+
+    {
+        float q[8];
+        Vect256f i(0, 0.1, 1, 2, 3, 4, 5, 6);
+        i.storeu(q);
+        checkEqual(q, i, 8);
+    }
+
+    {
+        AlignedStorage<float, 32> p(8);
+        Vect256f i(0, 0.1, 1, 2, 3, 4, 5, 6);
+        i.store(p);
+        checkEqual(i, p, 8);
+    }
+
+    {
+        AlignedStorage<float, 32> p(8);
+        Vect256f i(0, 0.1, 1, 2, 3, 4, 5, 6);
+        i.stream(p);
+        streamFence();
+        checkEqual(i, p, 8);
+    }
+
+    {
+        Vect256f p(0, 0.1, 1, 2, 3, 4, 5, 6);
+        __m256 m = p;
+        Vect256f pd = m;
+        float s[8] = {0, 0.1, 1, 2, 3, 4, 5, 6};
+        checkEqual(pd, s, 8);
+    }
+}
+
+TEST(simd, vect256f_operators) {
+    {
+        Vect256f v(1.203);
+        auto r = ~v == v;
+        auto r2 = ~~v == v;
+        for (int x = 0; x < 8; x++) {
+            ASSERT_FALSE(std::isnan(r[x]));
+            ASSERT_TRUE(std::isnan(r2[x]));
+        }
+    }
+
+    {
+        Vect256f i(0, -1, 1,  1, 2, 3, 4, 5);
+        Vect256f s(1,  1, 1, -2, 2, 2, 2, 2);
+        checkEqual(Vect256f(1, 0, 2, -1, 4, 5, 6, 7), i + s, 8);
+        checkEqual(Vect256f(-1, -2, 0, 3, 0, 1, 2, 3), i - s, 8);
+        checkEqual(Vect256f(0, -1, 1, -2, 4, 6, 8, 10), i * s, 8);
+        checkEqual(Vect256f(0, -1, 1, -0.5, 1, 1.5, 2, 2.5), i / s, 8);
+
+        i += s;
+        checkEqual(Vect256f(1, 0, 2, -1, 4, 5, 6, 7), i, 8);
+        i -= s;
+        i *= s;
+        checkEqual(Vect256f(0, -1, 1, -2, 4, 6, 8, 10), i, 8);
+    }
+
+    {
+        Vect256f i(0.1);
+        Vect256f s(0.0);
+        checkEqual(Vect256f(0.0), i & s, 8);
+        checkEqual(Vect256f(0.1), i | s, 8);
+        checkEqual(Vect256f(0.1), i ^ s, 8);
+        checkEqual(Vect256f(0.0), i ^ i, 8);
+    }
+
+    {
+        Vect256f i(0, 1, -1, 3.4e+29, 2, 2, -2, 0);
+        Vect256f s(0, 0,  0,       1, 2, 3, -3, 1);
+        bool gt[8] = {false, true, false, true, false, false, true, false};
+        bool eq[8] = {true, false, false, false, true, false, false, false};
+        auto rgt = i > s;
+        auto rlt = i < s;
+        auto rge = i >= s;
+        auto rle = i <= s;
+        auto req = i == s;
+        auto rne = i != s;
+        for (int x = 0; x < 8; x++) {
+            ASSERT_EQ(gt[x], std::isnan(rgt[x]));
+            ASSERT_EQ(!gt[x] && !eq[x], std::isnan(rlt[x]));
+            ASSERT_EQ(gt[x] || eq[x], std::isnan(rge[x]));
+            ASSERT_EQ(!gt[x], std::isnan(rle[x]));
+            ASSERT_EQ(eq[x], std::isnan(req[x]));
+            ASSERT_EQ(!eq[x], std::isnan(rne[x]));
+        }
+    }
+
+    {
+        Vect256f i(0, 1, -1, 4, 2, 2, -2, 0);
+        Vect256f s(0, 0,  0, 1, 2, 3, -3, 1);
+        checkEqual(Vect256f(0, 0, -1, 1, 2, 2, -3, 0), lowest(i, s), 8);
+        checkEqual(Vect256f(0, 1, 0, 4, 2, 3, -2, 1), highest(i, s), 8);
+    }
+
+    {
+        Vect256f v(0.2, 1.4, 1.6, 2.5, 10, 99.9, 0, 3.49);
+        checkEqual(Vect256i(0, 1, 2, 3, 10, 100, 0, 3), round(v), 8);
+
+        Vect256f sq(1, 4, 9, 16, 25, 36, 49, 64);
+        auto root = sqrt(sq);
+        auto inv = rsqrt(sq);
+        for (int x = 0; x < 8; x++) {
+            ASSERT_NEAR(x + 1, root[x], (x + 1) * 1e-2);
+            ASSERT_NEAR(1.0 / (x + 1), inv[x], 1e-3);
+        }
+    }
+}
+
+TEST(simd, vect256_select) {
+    checkSelect<Vect256i>();
+    checkSelect<Vect256f>();
+
+    Mask256 m = Vect256i(1, 2, 3, 4, 5, 6, 7, 8) > Vect256i(6);
+    ASSERT_EQ(0xC0u, m.bits());
+    ASSERT_EQ(0x3Fu, (~m).bits());
+    ASSERT_TRUE(m[7]);
+    ASSERT_FALSE(m[0]);
+}
+
+TEST(simd, vect256_partial) {
+    checkPartial<Vect256i>();
+    checkPartial<Vect256f>();
+}
+
+TEST(simd, vect256_gather) {
+    checkGather<Vect256i>();
+    checkGather<Vect256f>();
+}
+
+TEST(simd, vect256_rounding) {
+    checkRounding<Vect256f>();
+}
+
+TEST(simd, vect256_shift) {
+    Vect256i v(-8);
+    checkEqual(shl<2>(v), Vect256i(-32), Vect256i::lanes);
+    checkEqual(shr<28>(v), Vect256i(15), Vect256i::lanes);
+    checkEqual(sar<1>(v), Vect256i(-4), Vect256i::lanes);
+}
+
+TEST(simd, vect256_horizontal) {
+    checkHorizontal<Vect256i>();
+    checkHorizontal<Vect256f>();
+    checkDot<Vect256f>();
+}
+
+TEST(simd, vect256_fma) {
+    checkFma<Vect256f>();
+}
+
+TEST(simd, vect256_precision) {
+    checkPrecision<Vect256f>();
+}
+
+#endif  // HAVE_AVX
@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+
+#include "simd.hpp"
+#include "test.hpp"
+#include <cmath>
+
+using namespace sight;
+
+#ifdef HAVE_AVX512F
+
+TEST(simd, mask512) {
+    Mask512 m(0x00FF);
+    ASSERT_EQ(0x00FFu, m.bits());
+    ASSERT_TRUE(m[0]);
+    ASSERT_TRUE(m[7]);
+    ASSERT_FALSE(m[8]);
+    ASSERT_EQ(0xFF00u, (~m).bits());
+    ASSERT_EQ(0x000Fu, (m & Mask512(0xF00F)).bits());
+    ASSERT_EQ(0xF0FFu, (m | Mask512(0xF00F)).bits());
+    ASSERT_EQ(0xF0F0u, (m ^ Mask512(0xF00F)).bits());
+}
+
+TEST(simd, vect512i_construction) {
+    {
+        int x[16];
+        for (int i = 0; i < 16; i++) {
+            x[i] = i - 8;
+        }
+        Vect512i i = Vect512i::loadu(x);
+        checkEqual(i, x, 16);
+
+        int q[16];
+        i.storeu(q);
+        checkEqual(q, x, 16);
+    }
+
+    {
+        AlignedStorage<int32_t, 64> p(16);
+        for (int x = 0; x < 16; x++) {
+            p[x] = x;
+        }
+        Vect512i i = Vect512i::load(p);
+        checkEqual(i, p, 16);
+
+        AlignedStorage<int32_t, 64> q(16);
+        i.store(q);
+        checkEqual(q, p, 16);
+        i.stream(q);
+        streamFence();
+        checkEqual(q, p, 16);
+    }
+
+    {
+        Vect512i i(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        for (int x = 0; x < 16; x++) {
+            ASSERT_EQ(x, i[x]);
+        }
+        checkEqual(Vect512i(3), Vect512f(3.7).to_int(), 16);
+        checkEqual(Vect512f(3), Vect512f(Vect512i(3)), 16);
+    }
+}
+
+TEST(simd, vect512i_operators) {
+    Vect512i a(0, -1, 1, 2147483647, 5, 6, -7, 8,
+               9, 10, 11, 12, 13, 14, 15, 16);
+    Vect512i b(1);
+    int x[16], y[16];
+    a.storeu(x);
+
+    (a + b).storeu(y);
+    for (int i = 0; i < 16; i++) {
+        ASSERT_EQ(static_cast<int32_t>(static_cast<uint32_t>(x[i]) + 1), y[i]);
+    }
+    (a - b).storeu(y);
+    for (int i = 0; i < 16; i++) {
+        ASSERT_EQ(static_cast<int32_t>(static_cast<uint32_t>(x[i]) - 1), y[i]);
+    }
+    (a * Vect512i(-3)).storeu(y);
+    for (int i = 0; i < 16; i++) {
+        ASSERT_EQ(static_cast<int32_t>(static_cast<uint32_t>(x[i]) * -3u),
+                  y[i]);
+    }
+
+    checkEqual(Vect512i(0xF0F10 & 0xF001F),
+               Vect512i(0xF0F10) & Vect512i(0xF001F), 16);
+    checkEqual(Vect512i(0xF0F10 | 0xF001F),
+               Vect512i(0xF0F10) | Vect512i(0xF001F), 16);
+    checkEqual(Vect512i(0xF0F10 ^ 0xF001F),
+               Vect512i(0xF0F10) ^ Vect512i(0xF001F), 16);
+    checkEqual(Vect512i(0x00FF00FF), ~Vect512i(0xFF00FF00), 16);
+
+    Vect512i c(5);
+    for (int i = 0; i < 16; i++) {
+        ASSERT_EQ(x[i] < 5, (a < c)[i]);
+        ASSERT_EQ(x[i] <= 5, (a <= c)[i]);
+        ASSERT_EQ(x[i] > 5, (a > c)[i]);
+        ASSERT_EQ(x[i] >= 5, (a >= c)[i]);
+        ASSERT_EQ(x[i] == 5, (a == c)[i]);
+        ASSERT_EQ(x[i] != 5, (a != c)[i]);
+        ASSERT_EQ(std::min(x[i], 5), lowest(a, c)[i]);
+        ASSERT_EQ(std::max(x[i], 5), highest(a, c)[i]);
+    }
+
+    auto m = a > c;
+    checkEqual(select(m, a, c), highest(a, c), 16);
+    auto added = mask_add(Vect512i(-100), m, a, b);
+    auto zeroed = maskz_mul(m, a, Vect512i(2));
+    for (int i = 0; i < 16; i++) {
+        ASSERT_EQ(m[i] ? x[i] + 1 : -100, added[i]);
+        ASSERT_EQ(m[i] ? x[i] * 2 : 0, zeroed[i]);
+    }
+}
+
+TEST(simd, vect512f_operators) {
+    Vect512f a(0, -1, 1, 3.5, 5, 6, -7, 8,
+               9, 10, 11, 12, 13, 14, 15, 16);
+    float x[16];
+    a.storeu(x);
+
+    Vect512f b(2);
+    for (int i = 0; i < 16; i++) {
+        ASSERT_FLOAT_EQ(x[i] + 2, (a + b)[i]);
+        ASSERT_FLOAT_EQ(x[i] - 2, (a - b)[i]);
+        ASSERT_FLOAT_EQ(x[i] * 2, (a * b)[i]);
+        ASSERT_FLOAT_EQ(x[i] / 2, (a / b)[i]);
+        ASSERT_EQ(x[i] < 2, (a < b)[i]);
+        ASSERT_EQ(x[i] <= 2, (a <= b)[i]);
+        ASSERT_EQ(x[i] > 2, (a > b)[i]);
+        ASSERT_EQ(x[i] >= 2, (a >= b)[i]);
+        ASSERT_EQ(x[i] == 2, (a == b)[i]);
+        ASSERT_EQ(x[i] != 2, (a != b)[i]);
+        ASSERT_FLOAT_EQ(std::min(x[i], 2.0f), lowest(a, b)[i]);
+        ASSERT_FLOAT_EQ(std::max(x[i], 2.0f), highest(a, b)[i]);
+    }
+
+    checkEqual(Vect512f(0.0), Vect512f(0.1) & Vect512f(0.0), 16);
+    checkEqual(Vect512f(0.1), Vect512f(0.1) | Vect512f(0.0), 16);
+    checkEqual(Vect512f(0.0), Vect512f(0.1) ^ Vect512f(0.1), 16);
+    checkEqual(Vect512f(0.1), ~~Vect512f(0.1), 16);
+
+    Vect512f nan(NAN);
+    ASSERT_EQ(0u, (nan == nan).bits());
+    ASSERT_EQ(0xFFFFu, (nan != nan).bits());
+    ASSERT_EQ(0u, (nan < b).bits());
+    ASSERT_EQ(0xFFFFu, (nan <= b).bits());
+
+    auto m = a < b;
+    checkEqual(select(m, a, b), lowest(a, b), 16);
+    auto divided = mask_div(a, m, b, a);
+    auto zeroed = maskz_sub(m, a, b);
+    for (int i = 0; i < 16; i++) {
+        ASSERT_FLOAT_EQ(m[i] ? 2 / x[i] : x[i], divided[i]);
+        ASSERT_FLOAT_EQ(m[i] ? x[i] - 2 : 0, zeroed[i]);
+    }
+
+    Vect512f sq(4);
+    for (int i = 0; i < 16; i++) {
+        ASSERT_NEAR(2, sqrt(sq)[i], 1e-3);
+        ASSERT_NEAR(0.5, rsqrt(sq)[i], 1e-4);
+        ASSERT_NEAR(0.25, reciprocal(sq)[i], 1e-4);
+        ASSERT_EQ(4, round(Vect512f(3.6))[i]);
+    }
+}
+
+TEST(simd, vect512_select) {
+    checkSelect<Vect512i>();
+    checkSelect<Vect512f>();
+}
+
+TEST(simd, vect512_partial) {
+    checkPartial<Vect512i>();
+    checkPartial<Vect512f>();
+}
+
+TEST(simd, vect512_gather) {
+    checkGather<Vect512i>();
+    checkGather<Vect512f>();
+}
+
+TEST(simd, vect512_rounding) {
+    checkRounding<Vect512f>();
+}
+
+TEST(simd, vect512_shift) {
+    Vect512i v(-8);
+    checkEqual(shl<2>(v), Vect512i(-32), Vect512i::lanes);
+    checkEqual(shr<28>(v), Vect512i(15), Vect512i::lanes);
+    checkEqual(sar<1>(v), Vect512i(-4), Vect512i::lanes);
+}
+
+TEST(simd, vect512_horizontal) {
+    checkHorizontal<Vect512i>();
+    checkHorizontal<Vect512f>();
+    checkDot<Vect512f>();
+}
+
+TEST(simd, vect512_fma) {
+    checkFma<Vect512f>();
+}
+
+TEST(simd, vect512_precision) {
+    checkPrecision<Vect512f>();
+}
+
+#endif  // HAVE_AVX512F
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+
+#include "simd.hpp"
+#include "test.hpp"
+#include <algorithm>
+
+using namespace sight;
+
+namespace {
+
+struct Scale {
+    template <typename V>
+    V operator()(const V& v) const {
+        return v * V(3) - V(1);
+    }
+};
+
+struct Add {
+    template <typename V>
+    V operator()(const V& a, const V& b) const {
+        return a + b;
+    }
+};
+
+struct AddOne {
+    template <typename V>
+    V operator()(const V& v) const {
+        return v + V(1);
+    }
+};
+
+struct Lowest {
+    template <typename V>
+    V operator()(const V& a, const V& b) const {
+        return lowest(a, b);
+    }
+};
+
+template <typename V>
+void checkBulk() {
+    typedef typename V::value_type T;
+    for (int length = 0; length < 40; length++) {
+        AlignedStorage<T, 64> a(length), b(length), r(length + 1);
+        for (int i = 0; i < length; i++) {
+            a[i] = static_cast<T>(i - 5);
+            b[i] = static_cast<T>(length - i * 2);
+        }
+        r[length] = 42;
+
+        transform<V>(a, r, Scale());
+        for (int i = 0; i < length; i++) {
+            ASSERT_EQ(a[i] * 3 - 1, r[i]) << length;
+        }
+        ASSERT_EQ(42, r[length]);
+
+        zip<V>(a, b, r, Add());
+        for (int i = 0; i < length; i++) {
+            ASSERT_EQ(a[i] + b[i], r[i]) << length;
+        }
+        ASSERT_EQ(42, r[length]);
+
+        // in place has to use the padded remainder
+        transform<V>(a, a, Scale());
+        zip<V>(a, b, b, Add());
+        for (int i = 0; i < length; i++) {
+            ASSERT_EQ((i - 5) * 3 - 1, a[i]) << length;
+            ASSERT_EQ((i - 5) * 3 - 1 + length - i * 2, b[i]) << length;
+        }
+
+        T sum = 10, low = 1000;
+        for (int i = 0; i < length; i++) {
+            sum += a[i];
+            low = std::min(low, a[i]);
+        }
+        ASSERT_EQ(sum, reduce<V>(a, static_cast<T>(10), Add())) << length;
+        ASSERT_EQ(low, reduce<V>(a, static_cast<T>(1000), Lowest())) << length;
+    }
+}
+
+}  // namespace
+
+TEST(simd, bulk_kernels) {
+    checkBulk<Vect128f>();
+    checkBulk<Vect128i>();
+    checkBulk<NativeVectf>();
+    checkBulk<NativeVecti>();
+}
+
+TEST(simd, bulk_unaligned) {
+    AlignedStorage<float, 4> a(37), r(37);
+    for (int i = 0; i < 37; i++) {
+        a[i] = i * 0.5f;
+    }
+    transform(a, r, Scale());
+    for (int i = 0; i < 37; i++) {
+        ASSERT_FLOAT_EQ(a[i] * 3 - 1, r[i]);
+    }
+    ASSERT_FLOAT_EQ(37 * 0.5f * 36 / 2, reduce(a, 0.0f, Add()));
+
+    AlignedStorage<float, 16> small(4);
+    ASSERT_THROW(transform(a, small, Scale()), std::out_of_range);
+    ASSERT_THROW(zip(a, small, r, Add()), std::out_of_range);
+}
+
+TEST(simd, bulk_lambda) {
+    AlignedStorage<float, 64> a(19), r(19);
+    for (int i = 0; i < 19; i++) {
+        a[i] = i;
+    }
+    transform(a, r, [](const NativeVectf& v) { return v * v; });
+    for (int i = 0; i < 19; i++) {
+        ASSERT_FLOAT_EQ(i * i, r[i]);
+    }
+}
+
+TEST(simd, bulk_streaming) {
+    // above the threshold, with a remainder
+    const size_t length = SIGHT_STREAM_THRESHOLD / sizeof(int32_t) + 7;
+    AlignedStorage<int32_t, 64> a(length + 1), b(length + 1), r(length + 1);
+    for (size_t i = 0; i < length + 1; i++) {
+        a[i] = static_cast<int32_t>(i);
+        b[i] = 3;
+    }
+    prefetch<Hint::NTA>(static_cast<int32_t*>(a), 64);
+
+    zip<Vect128i>(a, b, r, Add());
+    for (size_t i = 0; i < length; i += 997) {
+        ASSERT_EQ(static_cast<int32_t>(i + 3), r[i]);
+    }
+    ASSERT_EQ(static_cast<int32_t>(length + 3), r[length]);
+
+    AlignedStorage<int32_t, 64> shifted(length);
+    memcpy(shifted, a + 1, length * sizeof(int32_t));
+    transform(shifted, r, Scale());
+    for (size_t i = 0; i < length; i += 997) {
+        ASSERT_EQ(static_cast<int32_t>((i + 1) * 3 - 1), r[i]);
+    }
+    ASSERT_EQ(static_cast<int32_t>(length * 3 - 1), r[length - 1]);
+}
+
+#ifdef HAVE_SSE
+TEST(simd, bulk_double) {
+    // there are no 256 or 512 bit double vectors, the default has to fit
+    AlignedStorage<double, 64> a(37), b(37), r(37);
+    for (size_t i = 0; i < 37; i++) {
+        a[i] = static_cast<double>(i) * 0.5;
+        b[i] = 2;
+    }
+    transform(a, r, Scale());
+    for (size_t i = 0; i < 37; i++) {
+        ASSERT_EQ(a[i] * 3 - 1, r[i]);
+    }
+    zip(a, b, r, Add());
+    for (size_t i = 0; i < 37; i++) {
+        ASSERT_EQ(a[i] + 2, r[i]);
+    }
+    ASSERT_EQ(36 * 37 / 4.0 + 1, reduce(a, 1.0, Add()));
+    ASSERT_EQ(0, reduce(a, 5.0, Lowest()));
+}
+
+TEST(simd, bulk_beyond_int_max) {
+    // bytes, so only 2 GiB get written
+    LargeMapping map(beyondIntMax);
+    ASSERT_NE(MAP_FAILED, map.data);
+    uint8_t* p = static_cast<uint8_t*>(map.data);
+    const size_t samples[] = {0, size_t(1) << 30, (size_t(1) << 31) - 1,
+                              size_t(1) << 31, beyondIntMax - 1};
+
+    // in place, so the remainder goes through the padded vector
+    AddOne addOne;
+    detail::transformRange<Vect128u8>(p, p, beyondIntMax, false, addOne);
+    for (size_t i : samples) {
+        ASSERT_EQ(1, p[i]) << i;
+    }
+    Add add;
+    detail::zipRange<Vect128u8>(p, p, p, beyondIntMax, false, add);
+    for (size_t i : samples) {
+        ASSERT_EQ(2, p[i]) << i;
+    }
+}
+#endif
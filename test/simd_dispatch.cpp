@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include "simd.hpp"
+#include <algorithm>
+#include <vector>
+
+using namespace sight;
+
+#ifdef HAVE_SSE
+
+TEST(simd, dispatch_detect) {
+    ASSERT_EQ(detectIsa(), cpuIsa());
+    ASSERT_LE(static_cast<int>(activeIsa()), static_cast<int>(cpuIsa()));
+    ASSERT_STRNE("unknown", isaName(cpuIsa()));
+
+    limitIsa(Isa::SSE2);
+    ASSERT_EQ(Isa::SSE2, activeIsa());
+    limitIsa(Isa::AVX512F);
+    ASSERT_EQ(cpuIsa(), activeIsa());
+}
+
+TEST(simd, dispatch_kernels) {
+    for (int tier = 0; tier <= static_cast<int>(cpuIsa()); tier++) {
+        limitIsa(static_cast<Isa>(tier));
+        for (size_t length : {0, 1, 3, 4, 7, 8, 15, 16, 17, 33, 100}) {
+            std::vector<int32_t> a(length), b(length), r(length);
+            for (size_t i = 0; i < length; i++) {
+                a[i] = static_cast<int32_t>(i * 7919) - 300;
+                b[i] = 100 - static_cast<int32_t>(i * 13);
+            }
+            a.push_back(-1), b.push_back(-1), r.push_back(42);
+
+            dispatch::multiply(a.data(), b.data(), r.data(), length);
+            for (size_t i = 0; i < length; i++) {
+                ASSERT_EQ(a[i] * b[i], r[i]) << isaName(activeIsa());
+            }
+            ASSERT_EQ(42, r[length]) << "wrote past the end";
+
+            dispatch::lowest(a.data(), b.data(), r.data(), length);
+            for (size_t i = 0; i < length; i++) {
+                ASSERT_EQ(std::min(a[i], b[i]), r[i]) << isaName(activeIsa());
+            }
+
+            dispatch::highest(a.data(), b.data(), r.data(), length);
+            for (size_t i = 0; i < length; i++) {
+                ASSERT_EQ(std::max(a[i], b[i]), r[i]) << isaName(activeIsa());
+            }
+            ASSERT_EQ(42, r[length]) << "wrote past the end";
+        }
+    }
+    limitIsa(Isa::AVX512F);
+}
+
+#endif  // HAVE_SSE
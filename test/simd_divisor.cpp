@@ -0,0 +1,64 @@
+#include "test.hpp"
+
+#include <limits>
+#include <vector>
+
+using namespace sight;
+
+namespace {
+
+/// Checks / and % of every vector in values against the int32_t operators
+template <typename V>
+void checkDivisor(const Divisor& d, const std::vector<int32_t>& values) {
+    const int32_t divisor = d.value();
+    for (size_t i = 0; i + V::lanes <= values.size(); i += V::lanes) {
+        V n = V::loadu(&values[i]);
+        V q = n / d, r = n % d;
+        for (int l = 0; l < V::lanes; l++) {
+            int32_t x = values[i + l];
+            if (divisor == -1 && x == std::numeric_limits<int32_t>::min()) {
+                ASSERT_EQ(x, q[l]);  // wraps around
+                continue;
+            }
+            ASSERT_EQ(x / divisor, q[l]) << x << " / " << divisor;
+            ASSERT_EQ(x % divisor, r[l]) << x << " % " << divisor;
+            ASSERT_EQ(x / divisor, d.divide(x)) << x << " / " << divisor;
+        }
+    }
+}
+
+}  // namespace
+
+TEST(simd, divisor) {
+    const int32_t min = std::numeric_limits<int32_t>::min();
+    const int32_t max = std::numeric_limits<int32_t>::max();
+
+    std::vector<int32_t> values = {0, 1, -1, 2, -2, 3, -3, 7, -7, 100, -100,
+                                   max, min, max - 1, min + 1, 1 << 30,
+                                   -(1 << 30), 12345678, -12345678};
+    uint32_t x = 1;
+    for (int i = 0; i < 237; i++) {
+        x = x * 1664525u + 1013904223u;
+        values.push_back(static_cast<int32_t>(x));
+        values.push_back(static_cast<int32_t>(x >> (i % 31)));
+    }
+    while (values.size() % 16) {
+        values.push_back(static_cast<int32_t>(values.size()));
+    }
+
+    std::vector<int32_t> divisors = {1, -1, 2, -2, 3, -3, 5, 7, -7, 10, 641,
+                                     1 << 16, 6700417, max, min, min + 1,
+                                     max - 1, -(1 << 30), 1 << 30};
+    for (int32_t d = -300; d <= 300; d++) {
+        if (d != 0) {
+            divisors.push_back(d);
+        }
+    }
+    for (size_t i = 0; i < divisors.size(); i++) {
+        Divisor d(divisors[i]);
+        checkDivisor<Vect128i>(d, values);
+        checkDivisor<NativeVecti>(d, values);
+    }
+
+    ASSERT_THROW(Divisor(0), std::invalid_argument);
+}
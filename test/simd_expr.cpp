@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include "simd.hpp"
+#include "test.hpp"
+#include <cmath>
+#include <stdexcept>
+
+using namespace sight;
+
+namespace {
+
+struct Square {
+    template <typename V>
+    V operator()(const V& v) const {
+        return v * v;
+    }
+};
+
+template <typename V>
+void checkExpr() {
+    for (size_t length : {0, 1, 5, 16, 37, 1000}) {
+        AlignedStorage<float, 64> a(length), b(length), c(length),
+            d(length), r(length + 1);
+        for (size_t i = 0; i < length; i++) {
+            a[i] = static_cast<float>(i);
+            b[i] = static_cast<float>(i % 7) - 3;
+            c[i] = 0.5f + static_cast<float>(i % 3);
+            d[i] = static_cast<float>(length - i);
+        }
+        r[length] = 42;
+
+        evaluate<V>((lazy(a) + b) * c - d, r);
+        for (size_t i = 0; i < length; i++) {
+            ASSERT_EQ((a[i] + b[i]) * c[i] - d[i], r[i]) << length;
+        }
+        ASSERT_EQ(42, r[length]);
+
+        // scalars on either side, unary functions
+        evaluate<V>(2 * lowest(lazy(b), 1.0f) / c + sqrt(lazy(a)), r);
+        for (size_t i = 0; i < length; i++) {
+            float expected = 2 * std::min(b[i], 1.0f) / c[i]
+                             + std::sqrt(a[i]);
+            ASSERT_NEAR(expected, r[i], 1e-3 * (1 + std::sqrt(a[i])));
+        }
+
+        evaluate<V>(-map(highest(lazy(b), 0), Square()), r);
+        for (size_t i = 0; i < length; i++) {
+            float positive = std::max(b[i], 0.0f);
+            ASSERT_EQ(-positive * positive, r[i]);
+        }
+
+        // the destination can be one of the arrays
+        evaluate<V>(lazy(a) * 2 + a, a);
+        for (size_t i = 0; i < length; i++) {
+            ASSERT_EQ(static_cast<float>(i) * 3, a[i]);
+        }
+    }
+}
+
+}  // namespace
+
+TEST(simd, expr_evaluate) {
+    checkExpr<Vect128f>();
+    checkExpr<NativeVectf>();
+
+    AlignedStorage<int32_t, 64> n(100), m(100);
+    for (int i = 0; i < 100; i++) {
+        n[i] = i - 50;
+    }
+    evaluate(highest(lazy(n) * n - 7, n), m);
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(std::max((i - 50) * (i - 50) - 7, i - 50), m[i]);
+    }
+}
+
+TEST(simd, expr_lengths) {
+    AlignedStorage<float, 64> a(10), b(11), r(9);
+    ASSERT_THROW(lazy(a) + b, std::out_of_range);
+    ASSERT_THROW(evaluate(lazy(a) + 1, r), std::out_of_range);
+    auto e = lazy(a) * 2;
+    ASSERT_EQ(10u, e.length());
+}
+
+TEST(simd, expr_parallel) {
+    const size_t length = 3 * SIGHT_PARALLEL_GRAIN / sizeof(float) + 5;
+    AlignedStorage<float, 64> a(length), b(length), r(length);
+    for (size_t i = 0; i < length; i++) {
+        a[i] = static_cast<float>(i % 1000);
+        b[i] = static_cast<float>(i % 13);
+    }
+    ThreadPool pool(4);
+    parallelEvaluate(lazy(a) * b + 1, r, pool);
+    for (size_t i = 0; i < length; i++) {
+        ASSERT_EQ(a[i] * b[i] + 1, r[i]);
+    }
+}
+
+#ifdef HAVE_SSE
+TEST(simd, expr_double) {
+    // there are no 256 or 512 bit double vectors, the default has to fit
+    const size_t length = 2 * SIGHT_PARALLEL_GRAIN / sizeof(double) + 3;
+    AlignedStorage<double, 64> a(length), r(length);
+    for (size_t i = 0; i < length; i++) {
+        a[i] = static_cast<double>(i % 100);
+    }
+    evaluate(lazy(a) * a - 1.0, r);
+    for (size_t i = 0; i < length; i++) {
+        ASSERT_EQ(a[i] * a[i] - 1, r[i]);
+    }
+    ThreadPool pool(2);
+    parallelEvaluate(lazy(a) + 0.5, r, pool);
+    for (size_t i = 0; i < length; i++) {
+        ASSERT_EQ(a[i] + 0.5, r[i]);
+    }
+}
+
+TEST(simd, expr_beyond_int_max) {
+    // bytes, so only 2 GiB get written
+    LargeMapping map(beyondIntMax);
+    ASSERT_NE(MAP_FAILED, map.data);
+    uint8_t* p = static_cast<uint8_t*>(map.data);
+    p[0] = 1;
+    p[size_t(1) << 31] = 2;
+    p[beyondIntMax - 1] = 3;
+
+    Expr<detail::Leaf<uint8_t>> x(detail::Leaf<uint8_t>(p, beyondIntMax));
+    detail::evaluateRange<Vect128u8>((x + x).node(), p, 0, beyondIntMax,
+                                     false);
+    ASSERT_EQ(2, p[0]);
+    ASSERT_EQ(4, p[size_t(1) << 31]);
+    ASSERT_EQ(6, p[beyondIntMax - 1]);
+}
+#endif
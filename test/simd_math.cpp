@@ -0,0 +1,19 @@
+#include "test.hpp"
+
+using namespace sight;
+
+TEST(simd, vect128_math) {
+    checkMath<Vect128f>();
+}
+
+#ifdef HAVE_AVX
+TEST(simd, vect256_math) {
+    checkMath<Vect256f>();
+}
+#endif
+
+#ifdef HAVE_AVX512F
+TEST(simd, vect512_math) {
+    checkMath<Vect512f>();
+}
+#endif
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include "simd.hpp"
+#include <stdexcept>
+
+using namespace sight;
+
+namespace {
+
+void checkMatrix(const float* expected, const Mat4f& m) {
+    float values[16];
+    m.storeu(values);
+    for (int i = 0; i < 16; i++) {
+        ASSERT_EQ(expected[i], values[i]) << i;
+    }
+}
+
+// small integers, so every sum is exact whatever the order
+template <int A>
+void fill(AlignedStorage<float, A>& s, int seed) {
+    for (size_t i = 0; i < s.length(); i++) {
+        s[i] = static_cast<float>((i * 7 + seed) % 11) - 5;
+    }
+}
+
+template <typename V>
+void checkGemv() {
+    for (size_t rows : {0, 1, 3, 4, 9}) {
+        for (size_t cols : {0, 1, 5, 16, 37, 4100}) {
+            AlignedStorage<float, 64> a(rows * cols), x(cols), y(rows + 1);
+            fill(a, 1);
+            fill(x, 2);
+            y[rows] = 42;
+            gemv<V>(a, x, y, rows, cols);
+            for (size_t i = 0; i < rows; i++) {
+                float expected = 0;
+                for (size_t j = 0; j < cols; j++) {
+                    expected += a[i * cols + j] * x[j];
+                }
+                ASSERT_EQ(expected, y[i]) << rows << " x " << cols;
+            }
+            ASSERT_EQ(42, y[rows]);
+        }
+    }
+}
+
+template <typename V>
+void checkGemm(size_t m, size_t k, size_t n) {
+    AlignedStorage<float, 64> a(m * k), b(k * n), c(m * n + 1);
+    fill(a, 3);
+    fill(b, 4);
+    c[m * n] = 42;
+    gemm<V>(a, b, c, m, k, n);
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < n; j++) {
+            float expected = 0;
+            for (size_t p = 0; p < k; p++) {
+                expected += a[i * k + p] * b[p * n + j];
+            }
+            ASSERT_EQ(expected, c[i * n + j])
+                << m << " x " << k << " x " << n << " at " << i << ", " << j;
+        }
+    }
+    ASSERT_EQ(42, c[m * n]);
+}
+
+template <typename V>
+void checkGemm() {
+    for (size_t m : {1, 4, 7}) {
+        for (size_t k : {1, 3, 16}) {
+            for (size_t n : {1, 5, 2 * V::lanes, 2 * V::lanes + 3}) {
+                checkGemm<V>(m, k, n);
+            }
+        }
+    }
+    // more than one block in every direction
+    checkGemm<V>(SIGHT_GEMM_MC + 5, SIGHT_GEMM_KC + 3, SIGHT_GEMM_NC + 7);
+}
+
+}  // namespace
+
+TEST(simd, matrix_mat4f) {
+    const float values[16] = {1, 2, 3, 4, 5, 6, 7, 8,
+                              9, 10, 11, 12, 13, 14, 15, 16};
+    Mat4f m = Mat4f::loadu(values);
+    checkMatrix(values, m * Mat4f::identity());
+    checkMatrix(values, Mat4f::identity() * m);
+
+    const float transposed[16] = {1, 5, 9, 13, 2, 6, 10, 14,
+                                  3, 7, 11, 15, 4, 8, 12, 16};
+    checkMatrix(transposed, transpose(m));
+
+    const float squared[16] = {90, 100, 110, 120, 202, 228, 254, 280,
+                               314, 356, 398, 440, 426, 484, 542, 600};
+    checkMatrix(squared, m * m);
+
+    Vect128f v = m * Vect128f(1, 0, -1, 2);
+    ASSERT_EQ(6, v[0]);
+    ASSERT_EQ(14, v[1]);
+    ASSERT_EQ(22, v[2]);
+    ASSERT_EQ(30, v[3]);
+
+    // translation of a point
+    Mat4f move = Mat4f::identity();
+    move[0] = Vect128f(1, 0, 0, 10);
+    v = move * Vect128f(1, 2, 3, 1);
+    ASSERT_EQ(11, v[0]);
+    ASSERT_EQ(2, v[1]);
+    ASSERT_EQ(1, v[3]);
+}
+
+TEST(simd, matrix_transform) {
+    const float values[16] = {0, 1, 0, 0, 2, 0, 0, 0,
+                              0, 0, 1, 5, 0, 0, 0, 1};
+    Mat4f m = Mat4f::loadu(values);
+    AlignedStorage<float, 16> points(40), out(40), small(36), odd(38);
+    fill(points, 5);
+    transform(m, points, out);
+    for (size_t i = 0; i < 40; i += 4) {
+        Vect128f expected = m * Vect128f::load(points + i);
+        for (int j = 0; j < 4; j++) {
+            ASSERT_EQ(expected[j], out[i + j]);
+        }
+    }
+    transform(m, points, points);
+    for (size_t i = 0; i < 40; i++) {
+        ASSERT_EQ(out[i], points[i]);
+    }
+    ASSERT_THROW(transform(m, points, small), std::out_of_range);
+    ASSERT_THROW(transform(m, odd, odd), std::invalid_argument);
+}
+
+TEST(simd, matrix_gemv) {
+    checkGemv<Vect128f>();
+    checkGemv<NativeVectf>();
+
+    AlignedStorage<float, 64> a(12), x(4), y(3);
+    ASSERT_THROW(gemv(a, x, y, 3, 5), std::out_of_range);
+    ASSERT_THROW(gemv(a, x, y, 4, 3), std::out_of_range);
+    ASSERT_THROW(gemv(a, x, x, 3, 4), std::invalid_argument);
+    ASSERT_THROW(gemv(a, x, a, 3, 4), std::invalid_argument);
+}
+
+TEST(simd, matrix_gemm) {
+    checkGemm<Vect128f>();
+    checkGemm<NativeVectf>();
+
+    checkGemm<NativeVectf>(0, 3, 3);
+    AlignedStorage<float, 64> a(6), b(6), c(4);
+    c[0] = 42;
+    gemm(a, b, c, 2, 0, 2);
+    ASSERT_EQ(0, c[0]);
+    ASSERT_THROW(gemm(a, b, c, 3, 2, 2), std::out_of_range);
+    ASSERT_THROW(gemm(a, b, a, 2, 3, 2), std::invalid_argument);
+}
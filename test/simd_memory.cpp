@@ -0,0 +1,260 @@
+#include "test.hpp"
+
+#include <utility>
+#include <vector>
+
+using namespace sight;
+
+TEST(simd, aligned_allocator) {
+    std::vector<float, AlignedAllocator<float, 64>> v;
+    for (int i = 0; i < 1000; i++) {
+        v.push_back(static_cast<float>(i));
+        ASSERT_TRUE(isAligned<64>(v.data()));
+    }
+    ASSERT_EQ(999.0f, v.back());
+
+    std::vector<int32_t, AlignedAllocator<int32_t, 16>> ints(7, 3);
+    Vect128i head = Vect128i::load(ints.data());
+    ASSERT_EQ(3, head[3]);
+
+    // rebinding keeps the alignment
+    AlignedAllocator<double, 4096> pages;
+    AlignedAllocator<char, 4096>::rebind<double>::other rebound(pages);
+    double* p = rebound.allocate(3);
+    ASSERT_TRUE(isAligned<4096>(p));
+    rebound.deallocate(p, 3);
+    ASSERT_TRUE(pages == rebound);
+
+    // alignments that aren't a power of two still work
+    for (size_t n = 0; n < 40; n++) {
+        void* q = AlignedAllocator<char, 17>::allocateBytes(n);
+        ASSERT_TRUE(isAligned<17>(static_cast<char*>(q)));
+        memset(q, 1, n);
+        AlignedAllocator<char, 17>::deallocateBytes(q);
+    }
+}
+
+TEST(simd, aligned_storage_move) {
+    AlignedStorage<int32_t, 64> a(5);
+    a[4] = 42;
+    const int32_t* data = a;
+    AlignedStorage<int32_t, 64> b(std::move(a));
+    ASSERT_EQ(5u, b.length());
+    ASSERT_EQ(0u, a.length());
+    ASSERT_EQ(data, static_cast<const int32_t*>(b));
+    ASSERT_EQ(42, b[4]);
+
+    AlignedStorage<int32_t, 64> c(1);
+    c = std::move(b);
+    ASSERT_EQ(42, c.at(4));
+    ASSERT_THROW(c.at(5), std::out_of_range);
+}
+
+TEST(simd, aligned_storage_beyond_int_max) {
+    // the heap only commits the pages that get written
+    AlignedStorage<uint8_t, 64> s(beyondIntMax);
+    const size_t last = beyondIntMax - 1;
+    s[0] = 1;
+    s[last] = 2;
+    ASSERT_EQ(static_cast<uint8_t*>(s) + last, s + last);
+    ASSERT_EQ(2, *(s + last));
+    ASSERT_EQ(2, s.at(last));
+    ASSERT_THROW(s.at(beyondIntMax), std::out_of_range);
+}
+
+TEST(simd, aligned_storage_resize) {
+    AlignedStorage<float, 32> s(3);
+    s[0] = 1, s[1] = 2, s[2] = 3;
+    s.resize(100);
+    ASSERT_EQ(100u, s.length());
+    ASSERT_TRUE(isAligned<32>(static_cast<float*>(s)));
+    ASSERT_EQ(3.0f, s[2]);
+    s.resize(2);
+    ASSERT_EQ(2u, s.length());
+    ASSERT_EQ(2.0f, s[1]);
+    ASSERT_THROW(s.at(2), std::out_of_range);
+
+    AlignedStorage<long long, 17> odd(4);
+    odd[3] = 7;
+    odd.resize(50);
+    ASSERT_TRUE(isAligned<17>(static_cast<long long*>(odd)));
+    ASSERT_EQ(7, odd[3]);
+}
+
+TEST(simd, aligned_arena) {
+    AlignedArena arena(4096);
+    ASSERT_EQ(0u, arena.capacity());
+
+    char* a = static_cast<char*>(arena.allocate(10, 64));
+    char* b = static_cast<char*>(arena.allocate(1, 17));
+    char* c = static_cast<char*>(arena.allocate(100, 64));
+    ASSERT_TRUE(isAligned<64>(a));
+    ASSERT_TRUE(isAligned<17>(b));
+    ASSERT_TRUE(isAligned<64>(c));
+    ASSERT_TRUE(a + 10 <= b && b + 1 <= c);
+    ASSERT_EQ(4096u, arena.capacity());
+
+    // the last allocation can be given back
+    arena.deallocate(c, 100, 64);
+    ASSERT_EQ(c, arena.allocate(100, 64));
+    arena.deallocate(a, 10, 64);
+    ASSERT_NE(a, arena.allocate(10, 64));
+
+    // larger than a chunk
+    void* big = arena.allocate(10000, 4096);
+    ASSERT_TRUE(isAligned<4096>(static_cast<char*>(big)));
+    memset(big, 1, 10000);
+    size_t capacity = arena.capacity();
+    ASSERT_GE(capacity, 4096u + 10000u);
+
+    // reset reuses the same memory
+    arena.reset();
+    ASSERT_EQ(a, arena.allocate(10, 64));
+    ASSERT_EQ(big, arena.allocate(10000, 4096));
+    ASSERT_EQ(capacity, arena.capacity());
+
+    arena.release();
+    ASSERT_EQ(0u, arena.capacity());
+    ASSERT_EQ(&AlignedArena::local(), &AlignedArena::local());
+}
+
+TEST(simd, aligned_arena_storage) {
+    AlignedArena arena;
+    AlignedArena::Marker start = arena.mark();
+    {
+        AlignedArena::Scope scope(arena);
+        AlignedStorage<float, 64> a(7, arena);
+        AlignedStorage<int32_t, 32> b(5, arena);
+        ASSERT_TRUE(isAligned<64>(static_cast<float*>(a)));
+        ASSERT_TRUE(isAligned<32>(static_cast<int32_t*>(b)));
+        a[6] = 1.5f;
+        b.resize(100);
+        a.resize(1000);
+        ASSERT_EQ(1.5f, a[6]);
+        ASSERT_TRUE(isAligned<64>(static_cast<float*>(a)));
+
+        AlignedStorage<float, 64> moved(std::move(a));
+        ASSERT_EQ(1.5f, moved.at(6));
+    }
+
+    // the scope rewound everything
+    AlignedArena::Marker end = arena.mark();
+    ASSERT_EQ(start.chunk, end.chunk);
+    ASSERT_EQ(start.offset, end.offset);
+}
+
+TEST(simd, page_resource) {
+    PageResource small(Pages::Small);
+    AlignedStorage<float, 64> a(1000, small);
+    ASSERT_TRUE(isAligned<4096>(static_cast<float*>(a)));
+    ASSERT_EQ(0.0f, a[999]);  // fresh pages are zero
+    a[999] = 2;
+    a.resize(5000);
+    ASSERT_EQ(2.0f, a[999]);
+
+    // alignments other than powers of two
+    void* odd = small.allocate(100, 17 * 4096);
+    ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(odd) % (17 * 4096));
+    small.deallocate(odd, 100, 17 * 4096);
+
+    PageResource huge(Pages::Huge);
+    const size_t hugePage = PageResource::HugePage;
+    ASSERT_EQ(hugePage, huge.pageSize());
+    AlignedStorage<int32_t, 32> b(3 << 20, huge);
+    ASSERT_EQ(0u,
+              reinterpret_cast<uintptr_t>(static_cast<int32_t*>(b)) % hugePage);
+    b[(3 << 20) - 1] = 5;
+
+    // node 0 exists on every machine with NUMA support
+    PageResource bound(Pages::Small, 0);
+    try {
+        AlignedStorage<float, 64> c(100, bound);
+        c[99] = 1;
+    } catch (const std::system_error& e) {
+        ASSERT_EQ(std::errc::function_not_supported,
+                  static_cast<std::errc>(e.code().value()));
+    }
+    ASSERT_THROW(PageResource(Pages::Small, -2), std::invalid_argument);
+}
+
+TEST(simd, parallel_clear) {
+    for (size_t length : {size_t(0), size_t(10), size_t(100000)}) {
+        for (unsigned threads : {0u, 1u, 3u, 8u}) {
+            AlignedStorage<float, 64> s(length);
+            for (size_t i = 0; i < length; i++) {
+                s[i] = 1;
+            }
+            parallelClear(s, threads);
+            for (size_t i = 0; i < length; i++) {
+                ASSERT_EQ(0.0f, s[i]);
+            }
+        }
+    }
+}
+
+TEST(simd, mapped_storage) {
+    char path[] = "/tmp/sight_mappedXXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    float values[1027];
+    for (int i = 0; i < 1027; i++) {
+        values[i] = i * 0.5f;
+    }
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(values)),
+              write(fd, values, sizeof(values)));
+    close(fd);
+
+    {
+        MappedStorage<float> mapped(path);
+        ASSERT_EQ(1027u, mapped.length());
+        ASSERT_TRUE(isAligned<4096>(static_cast<const float*>(mapped)));
+        mapped.willNeed();
+        checkEqual(Vect128f::load(mapped + 1020), values + 1020, 4);
+        ASSERT_EQ(513.0f, mapped.at(1026));
+        ASSERT_THROW(mapped.at(1027), std::out_of_range);
+
+        // copy on write changes only this mapping
+        MappedStorage<float> copy(path, Mapping::CopyOnWrite, 4096 + 4);
+        ASSERT_EQ(1027u - 1025u, copy.length());
+        ASSERT_EQ(values[1025], copy[0]);
+        copy[0] = -1;
+        ASSERT_EQ(values[1025], mapped[1025]);
+
+        MappedStorage<float> moved(std::move(copy));
+        ASSERT_EQ(-1.0f, moved[0]);
+        ASSERT_EQ(0u, copy.length());
+    }
+
+    ASSERT_THROW(MappedStorage<float>(path, Mapping::ReadOnly, 1 << 20),
+                 std::out_of_range);
+    truncate(path, 3);
+    ASSERT_EQ(0u, MappedStorage<float>(path).length());
+    unlink(path);
+    ASSERT_THROW(MappedStorage<float> missing(path), std::system_error);
+}
+
+TEST(simd, mapped_storage_beyond_int_max) {
+    // sparse, only the pages that get written take space
+    char path[] = "/tmp/sight_mappedXXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    const size_t last = beyondIntMax - 1;
+    const uint8_t one = 1, two = 2;
+    ASSERT_EQ(0, ftruncate(fd, static_cast<off_t>(beyondIntMax)));
+    ASSERT_EQ(1, pwrite(fd, &one, 1, static_cast<off_t>(size_t(1) << 31)));
+    ASSERT_EQ(1, pwrite(fd, &two, 1, static_cast<off_t>(last)));
+    close(fd);
+
+    {
+        MappedStorage<uint8_t> mapped(path, Mapping::CopyOnWrite);
+        ASSERT_EQ(beyondIntMax, mapped.length());
+        ASSERT_EQ(1, mapped[size_t(1) << 31]);
+        ASSERT_EQ(2, *(mapped + last));
+        ASSERT_EQ(2, mapped.at(last));
+        ASSERT_THROW(mapped.at(beyondIntMax), std::out_of_range);
+        mapped.at(last) = 3;
+        ASSERT_EQ(3, mapped[last]);
+        ASSERT_EQ(0, mapped[0]);
+    }
+    unlink(path);
+}
@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+
+#include "simd.hpp"
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+using namespace sight;
+
+namespace {
+
+struct Scale {
+    template <typename V>
+    V operator()(const V& v) const {
+        return v * V(3) - V(1);
+    }
+};
+
+struct Add {
+    template <typename V>
+    V operator()(const V& a, const V& b) const {
+        return a + b;
+    }
+};
+
+struct Lowest {
+    template <typename V>
+    V operator()(const V& a, const V& b) const {
+        return lowest(a, b);
+    }
+};
+
+// runs every task in order on the calling thread, counting them
+struct Serial {
+    size_t tasks = 0;
+
+    template <typename Task>
+    void run(size_t count, const Task& task) {
+        for (size_t i = 0; i < count; i++) {
+            task(i);
+        }
+        tasks += count;
+    }
+};
+
+const size_t grain = SIGHT_PARALLEL_GRAIN / sizeof(float);
+const size_t lengths[] = {0, 1, 19, grain - 1, grain, grain + 1,
+                          5 * grain + 3};
+
+}  // namespace
+
+TEST(simd, parallel_pool) {
+    ThreadPool pool(4);
+    ASSERT_EQ(4u, pool.size());
+    for (size_t count : {0, 1, 3, 1000}) {
+        std::vector<std::atomic<int>> hits(count);
+        pool.run(count, [&](size_t i) { hits[i]++; });
+        for (size_t i = 0; i < count; i++) {
+            ASSERT_EQ(1, hits[i].load()) << count;
+        }
+    }
+
+    // nested runs happen on the thread calling them
+    std::atomic<int> inner(0);
+    pool.run(8, [&](size_t) {
+        pool.run(10, [&](size_t) { inner++; });
+    });
+    ASSERT_EQ(80, inner.load());
+
+    // the pool keeps working after a task throws
+    ASSERT_THROW(pool.run(100, [](size_t i) {
+        if (i == 42) {
+            throw std::runtime_error("task failed");
+        }
+    }), std::runtime_error);
+    std::atomic<int> after(0);
+    pool.run(100, [&](size_t) { after++; });
+    ASSERT_EQ(100, after.load());
+}
+
+TEST(simd, parallel_transform) {
+    ThreadPool pool(3);
+    for (size_t length : lengths) {
+        AlignedStorage<float, 64> a(length), b(length), r(length + 1);
+        for (size_t i = 0; i < length; i++) {
+            a[i] = static_cast<float>(i % 1000) - 5;
+            b[i] = static_cast<float>(length - i % 777);
+        }
+        r[length] = 42;
+
+        parallelTransform<Vect128f>(a, r, Scale(), pool);
+        for (size_t i = 0; i < length; i++) {
+            ASSERT_EQ(a[i] * 3 - 1, r[i]) << length;
+        }
+        parallelZip(a, b, r, Add(), pool);
+        for (size_t i = 0; i < length; i++) {
+            ASSERT_EQ(a[i] + b[i], r[i]) << length;
+        }
+        ASSERT_EQ(42, r[length]);
+
+        // in place
+        parallelTransform(a, a, Scale());
+        parallelZip(a, b, b, Add(), pool);
+        for (size_t i = 0; i < length; i++) {
+            float scaled = (static_cast<float>(i % 1000) - 5) * 3 - 1;
+            ASSERT_EQ(scaled, a[i]) << length;
+            ASSERT_EQ(scaled + static_cast<float>(length - i % 777), b[i]);
+        }
+    }
+
+    AlignedStorage<float, 64> a(grain * 2);
+    AlignedStorage<float, 64> c(grain);
+    ASSERT_THROW(parallelTransform(a, c, Scale(), pool), std::out_of_range);
+}
+
+TEST(simd, parallel_reduce) {
+    ThreadPool one(1), three(3), eight(8);
+    for (size_t length : lengths) {
+        AlignedStorage<float, 64> f(length);
+        AlignedStorage<int32_t, 64> n(length);
+        for (size_t i = 0; i < length; i++) {
+            f[i] = 1.0f / static_cast<float>(i + 1);
+            n[i] = static_cast<int32_t>(i % 1000) - 300;
+        }
+
+        // float sums come out bit for bit the same on any amount of threads
+        float sum = parallelReduce(f, 0.5f, Add(), one);
+        float sum3 = parallelReduce(f, 0.5f, Add(), three);
+        float sum8 = parallelReduce(f, 0.5f, Add(), eight);
+        ASSERT_EQ(0, memcmp(&sum, &sum3, sizeof(float))) << length;
+        ASSERT_EQ(0, memcmp(&sum, &sum8, sizeof(float))) << length;
+        ASSERT_NEAR(reduce(f, 0.5f, Add()), sum, 1e-4) << length;
+
+        int32_t expected = 7, low = 1000;
+        for (size_t i = 0; i < length; i++) {
+            expected += n[i];
+            low = std::min(low, n[i]);
+        }
+        ASSERT_EQ(expected, parallelReduce<Vect128i>(n, 7, Add(), eight));
+        ASSERT_EQ(low, parallelReduce(n, 1000, Lowest()));
+    }
+}
+
+TEST(simd, parallel_executor) {
+    const size_t length = 3 * grain;
+    AlignedStorage<float, 64> a(length), r(length);
+    for (size_t i = 0; i < length; i++) {
+        a[i] = static_cast<float>(i % 100);
+    }
+
+    Serial serial;
+    parallelTransform(a, r, Scale(), serial);
+    ASSERT_EQ(3u, serial.tasks);
+    for (size_t i = 0; i < length; i++) {
+        ASSERT_EQ(a[i] * 3 - 1, r[i]);
+    }
+    ASSERT_EQ(parallelReduce(a, 0.0f, Add()),
+              parallelReduce(a, 0.0f, Add(), serial));
+}
+
+#ifdef HAVE_SSE
+TEST(simd, parallel_double) {
+    // there are no 256 or 512 bit double vectors, the default has to fit
+    const size_t length = 2 * SIGHT_PARALLEL_GRAIN / sizeof(double) + 3;
+    AlignedStorage<double, 64> a(length), b(length), r(length);
+    for (size_t i = 0; i < length; i++) {
+        a[i] = static_cast<double>(i % 100);
+        b[i] = 0.5;
+    }
+    Serial serial;
+    parallelTransform(a, r, Scale(), serial);
+    for (size_t i = 0; i < length; i++) {
+        ASSERT_EQ(a[i] * 3 - 1, r[i]);
+    }
+    parallelZip(a, b, r, Add(), serial);
+    for (size_t i = 0; i < length; i++) {
+        ASSERT_EQ(a[i] + 0.5, r[i]);
+    }
+    ASSERT_EQ(-1, parallelReduce(a, -1.0, Lowest(), serial));
+}
+#endif
+
+// only in simd_stats_test, where the counters are enabled
+#ifdef SIGHT_INSTRUMENT
+TEST(simd, parallel_reduce_aligned) {
+    const size_t length = 8 * grain;
+    AlignedStorage<float, 64> a(length);
+    std::fill(a + 0, a + static_cast<int>(length), 1.0f);
+    resetStats();
+    Serial serial;
+    ASSERT_EQ(static_cast<float>(length),
+              parallelReduce(a, 0.0f, Add(), serial));
+
+    // every chunk starts on a cache line, so none should lose aligned loads
+    StatsSnapshot s = statsSnapshot();
+    ASSERT_EQ(8u, serial.tasks);
+    ASSERT_EQ(serial.tasks, s[Counter::AlignedRun]);
+    ASSERT_EQ(0u, s[Counter::UnalignedRun]);
+}
+#endif
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include "simd.hpp"
+#include "test.hpp"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+using namespace sight;
+
+namespace {
+
+template <typename V>
+struct Above {
+    typename V::value_type limit;
+    auto operator()(const V& v) const -> decltype(v > v) {
+        return v > V(limit);
+    }
+};
+
+template <typename V>
+void checkSearch() {
+    typedef typename V::value_type T;
+    for (size_t length : {0, 1, 3, 16, 17, 63, 64, 65, 200}) {
+        AlignedStorage<T, 64> a(length), b(length);
+        for (size_t i = 0; i < length; i++) {
+            a[i] = b[i] = static_cast<T>((i * 7) % 50);
+        }
+        const T* begin = a;
+        const T* end = begin + length;
+
+        for (int value : {0, 7, 13, 49, 50}) {
+            T x = static_cast<T>(value);
+            ASSERT_EQ(static_cast<size_t>(std::find(begin, end, x) - begin),
+                      find<V>(a, x)) << length;
+            ASSERT_EQ(static_cast<size_t>(std::count(begin, end, x)),
+                      count<V>(a, x)) << length;
+        }
+        Above<V> above = {static_cast<T>(30)};
+        ASSERT_EQ(static_cast<size_t>(std::count_if(begin, end, [](T v) {
+                      return v > 30;
+                  })),
+                  count_if<V>(a, above));
+        ASSERT_EQ(static_cast<size_t>(std::find_if(begin, end, [](T v) {
+                      return v > 30;
+                  }) - begin),
+                  find_if<V>(a, above));
+
+        ASSERT_EQ(static_cast<size_t>(std::min_element(begin, end) - begin),
+                  min_element<V>(a)) << length;
+        ASSERT_EQ(static_cast<size_t>(std::max_element(begin, end) - begin),
+                  max_element<V>(a)) << length;
+
+        ASSERT_TRUE(equal<V>(a, b));
+        for (size_t i = 0; i < length; i += 5) {
+            b[i] = static_cast<T>(b[i] + 1);
+            ASSERT_FALSE(equal<V>(a, b)) << i;
+            b[i] = a[i];
+        }
+        AlignedStorage<T, 64> longer(length + 1);
+        ASSERT_FALSE(equal<V>(a, longer));
+    }
+}
+
+template <typename V>
+void checkPrefixSum() {
+    typedef typename V::value_type T;
+    for (size_t length : {0, 1, 5, 16, 33, 100}) {
+        AlignedStorage<T, 64> a(length), r(length + 1);
+        for (size_t i = 0; i < length; i++) {
+            a[i] = static_cast<T>(i % 9) - 2;
+        }
+        r[length] = 42;
+        prefix_sum<V>(a, r);
+        T total = 0;
+        for (size_t i = 0; i < length; i++) {
+            total += a[i];
+            ASSERT_EQ(total, r[i]) << length;  // exact for small integers
+        }
+        ASSERT_EQ(42, r[length]);
+
+        prefix_sum<V>(a, a);
+        for (size_t i = 0; i < length; i++) {
+            ASSERT_EQ(r[i], a[i]);
+        }
+    }
+}
+
+}  // namespace
+
+TEST(simd, scan_movemask) {
+    ASSERT_EQ(0x5u, movemask(Vect128i(1, 0, 1, 0) == Vect128i(1)));
+    ASSERT_EQ(0xAu, movemask(Vect128f(0, 2, 0, 2) > Vect128f(1)));
+    #ifdef HAVE_SSE
+    ASSERT_EQ(0x2u, movemask(Vect128d(0, 2) > Vect128d(1)));
+    Vect128i16 shorts(0, 5, 0, 5, 0, 0, 0, 5);
+    ASSERT_EQ(0x8Au, movemask(shorts == Vect128i16(5)));
+    ASSERT_EQ(0xFFFFu, movemask(Vect128u8(3) == Vect128u8(3)));
+    #endif
+}
+
+TEST(simd, scan_search) {
+    #ifdef HAVE_SSE
+    checkSearch<Vect128u8>();
+    checkSearch<Vect128i8>();
+    checkSearch<Vect128i16>();
+    checkSearch<Vect128d>();
+    #endif
+    checkSearch<Vect128i>();
+    checkSearch<Vect128f>();
+    checkSearch<NativeVecti>();
+    checkSearch<NativeVectf>();
+}
+
+TEST(simd, scan_defaults) {
+    #ifdef HAVE_SSE
+    AlignedStorage<uint8_t, 64> text(1000);
+    std::fill(text + 0, text + 1000, 'a');
+    text[700] = '\n';
+    ASSERT_EQ(700u, find(text, '\n'));
+    ASSERT_EQ(1u, count(text, '\n'));
+    ASSERT_EQ(1000u, find(text, 'b'));
+    #endif
+
+    // NaN is skipped by min & max
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    AlignedStorage<float, 64> f(40);
+    std::fill(f + 0, f + 40, nan);
+    ASSERT_EQ(40u, min_element(f));
+    f[3] = 2;
+    f[30] = -1;
+    ASSERT_EQ(30u, min_element(f));
+    ASSERT_EQ(3u, max_element(f));
+    ASSERT_FALSE(equal(f, f));  // NaN != NaN
+}
+
+TEST(simd, scan_prefix_sum) {
+    checkPrefixSum<Vect128i>();
+    checkPrefixSum<Vect128f>();
+    checkPrefixSum<NativeVecti>();
+    checkPrefixSum<NativeVectf>();
+}
+
+#ifdef HAVE_SSE
+TEST(simd, scan_beyond_int_max) {
+    // 3 GiB column of bytes, only the written pages get memory
+    const size_t length = (size_t(3) << 30) + 5;
+    const size_t match = 2500000000u;
+    LargeMapping map(length);
+    ASSERT_NE(MAP_FAILED, map.data);
+    uint8_t* p = static_cast<uint8_t*>(map.data);
+    p[match] = '\n';
+    p[length - 2] = '\n';  // in the remainder
+    p[length - 1] = 200;
+
+    typedef Vect128u8 V;
+    detail::Equals<V> newline = {'\n'};
+    ASSERT_EQ(match, (detail::findIf<V, true>(p, length, newline)));
+    const size_t after = match + 1;
+    ASSERT_EQ(length - 2 - after,
+              (detail::findIf<V, false>(p + after, length - after, newline)));
+    ASSERT_EQ(2u, (detail::countIf<V, true>(p, length, newline)));
+    ASSERT_EQ(200, (detail::extreme<V, true, detail::Largest>(p, length)));
+}
+#endif
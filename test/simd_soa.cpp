@@ -0,0 +1,94 @@
+#include "test.hpp"
+
+using namespace sight;
+
+namespace {
+
+struct Particle {
+    float x, y;
+    int32_t id;
+    double mass;
+};
+
+}  // namespace
+
+TEST(simd, soa_layout) {
+    SoA<float, int32_t, double> soa(21);
+    ASSERT_EQ(21u, soa.size());
+    ASSERT_EQ(32u, soa.padded());
+    ASSERT_TRUE(isAligned<64>(static_cast<float*>(soa.column<0>())));
+    ASSERT_TRUE(isAligned<64>(static_cast<int32_t*>(soa.column<1>())));
+    ASSERT_TRUE(isAligned<64>(static_cast<double*>(soa.column<2>())));
+    for (size_t i = 0; i < soa.padded(); i++) {
+        ASSERT_EQ(0, soa.column<0>()[i]);
+        ASSERT_EQ(0, soa.column<2>()[i]);
+    }
+    ASSERT_EQ(0u, SoA<uint8_t>(0).padded());
+    ASSERT_EQ(64u, SoA<uint8_t>(1).padded());
+}
+
+TEST(simd, soa_aos) {
+    Particle particles[19];
+    for (int i = 0; i < 19; i++) {
+        particles[i] = {i * 0.5f, i * 2.0f, i, i * 0.25};
+    }
+    SoA<float, float, int32_t, double> soa(19);
+    soa.fromAoS(particles, 19, &Particle::x, &Particle::y, &Particle::id,
+                &Particle::mass);
+    ASSERT_EQ(9.0f, soa.column<0>()[18]);
+    ASSERT_EQ(36.0f, soa.column<1>()[18]);
+    ASSERT_EQ(18, soa.column<2>()[18]);
+    ASSERT_EQ(4.5, soa.column<3>()[18]);
+
+    // x += y, one vector at a time, through the padding
+    for (size_t i = 0; i < soa.padded(); i += Vect128f::lanes) {
+        Vect128f x = soa.load<0, Vect128f>(i), y = soa.load<1, Vect128f>(i);
+        soa.store<0>(i, x + y);
+    }
+    for (size_t i = 0; i < soa.padded(); i += NativeVecti::lanes) {
+        soa.store<2>(i, soa.load<2>(i) * NativeVecti(3));
+    }
+
+    Particle out[19] = {};
+    soa.toAoS(out, 19, &Particle::x, &Particle::y, &Particle::id,
+              &Particle::mass);
+    for (int i = 0; i < 19; i++) {
+        ASSERT_EQ(i * 2.5f, out[i].x);
+        ASSERT_EQ(i * 2.0f, out[i].y);
+        ASSERT_EQ(i * 3, out[i].id);
+        ASSERT_EQ(i * 0.25, out[i].mass);
+    }
+    ASSERT_THROW(soa.toAoS(out, 20, &Particle::x, &Particle::y, &Particle::id,
+                           &Particle::mass),
+                 std::out_of_range);
+}
+
+#ifdef HAVE_SSE
+TEST(simd, soa_double) {
+    // there are no 256 or 512 bit double vectors, the default has to fit
+    SoA<double, int32_t> soa(7);
+    for (size_t i = 0; i < 7; i++) {
+        soa.column<0>()[i] = i * 0.5;
+    }
+    typedef decltype(soa.load<0>(0)) V;
+    for (size_t i = 0; i < soa.padded(); i += V::lanes) {
+        soa.store<0>(i, soa.load<0>(i) + soa.load<0>(i));
+    }
+    for (size_t i = 0; i < 7; i++) {
+        ASSERT_EQ(i * 1.0, soa.column<0>()[i]);
+    }
+}
+#endif
+
+#ifdef HAVE_SSE
+TEST(simd, soa_beyond_int_max) {
+    // one byte per record, the columns are zeroed so this writes 2 GiB
+    SoA<uint8_t> soa(beyondIntMax);
+    const size_t i = size_t(1) << 31;
+    soa.store<0>(i, Vect128u8(7));
+    ASSERT_EQ(7, soa.column<0>()[i + 15]);
+    ASSERT_EQ(0, soa.column<0>()[i + 16]);
+    ASSERT_EQ(7, (soa.load<0, Vect128u8>(i)[0]));
+    ASSERT_EQ(0, soa.column<0>()[0]);
+}
+#endif
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+// built as its own binary, every file of a program has to agree on this
+#ifndef SIGHT_INSTRUMENT
+    #define SIGHT_INSTRUMENT
+#endif
+#include "simd.hpp"
+#include <cstring>
+
+using namespace sight;
+
+namespace {
+
+struct Twice {
+    template <typename V>
+    V operator()(const V& v) const {
+        return v + v;
+    }
+};
+
+struct Add {
+    template <typename V>
+    V operator()(const V& a, const V& b) const {
+        return a + b;
+    }
+};
+
+}  // namespace
+
+TEST(simd, stats_loads) {
+    resetStats();
+    alignas(16) float values[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    Vect128f a = Vect128f::load(values);
+    Vect128f b = Vect128f::loadu(values + 1);
+    (a + b).store(values);
+    (a + b).storeu(values + 1);
+    Vect128i::load_partial(reinterpret_cast<int32_t*>(values), 3)
+        .store_partial(reinterpret_cast<int32_t*>(values), 3);
+
+    StatsSnapshot s = statsSnapshot();
+    ASSERT_TRUE(s.enabled);
+    ASSERT_EQ(1u, s[Counter::UnalignedLoad]);
+    ASSERT_EQ(1u, s[Counter::UnalignedStore]);
+    ASSERT_EQ(1u, s[Counter::PartialLoad]);
+    ASSERT_EQ(1u, s[Counter::PartialStore]);
+    // partial loads and stores may go through an aligned buffer
+    ASSERT_LE(1u, s[Counter::AlignedLoad]);
+    ASSERT_GE(2u, s[Counter::AlignedLoad]);
+    ASSERT_EQ(0u, s[Counter::StreamStore]);
+
+    resetStats();
+    ASSERT_EQ(0u, statsSnapshot()[Counter::UnalignedLoad]);
+}
+
+TEST(simd, stats_kernels) {
+    resetStats();
+    AlignedStorage<float, 64> a(1000), b(1000), c(1000);
+    std::fill(a + 0, a + 1000, 1.0f);
+    std::fill(b + 0, b + 1000, 2.0f);
+    transform(a, c, Twice());
+    zip(a, b, a, Add());  // in place, so the remainder is zero padded
+    ASSERT_EQ(3.0f * 1000, reduce(a, 0.0f, Add()));
+
+    StatsSnapshot s = statsSnapshot();
+    ASSERT_EQ(1u, s[Kernel::Transform].calls);
+    ASSERT_EQ(1000u, s[Kernel::Transform].values);
+    ASSERT_LT(0u, s[Kernel::Transform].cycles);
+    ASSERT_EQ(1u, s[Kernel::Zip].calls);
+    ASSERT_EQ(1u, s[Kernel::Reduce].calls);
+    ASSERT_EQ(0u, s[Kernel::ParallelReduce].calls);
+    ASSERT_EQ(3u, s[Counter::AlignedRun]);
+    ASSERT_EQ(0u, s[Counter::UnalignedRun]);
+    if (1000 % NativeVectf::lanes != 0) {
+        ASSERT_EQ(1u, s[Counter::OverlappedTail]);
+        ASSERT_EQ(2u, s[Counter::PartialTail]);
+    }
+
+    // unaligned arrays, and an input shorter than a vector
+    resetStats();
+    const float* pa = a;
+    float* pc = c;
+    Twice twice;
+    detail::transformRange<NativeVectf>(pa + 1, pc + 1, 100, false, twice);
+    Add add;
+    detail::reduceRange<NativeVectf>(pa, 1, 0.0f, add);
+    s = statsSnapshot();
+    ASSERT_EQ(1u, s[Counter::UnalignedRun]);
+    ASSERT_EQ(0u, s[Counter::AlignedRun]);
+    ASSERT_EQ(1u, s[Counter::ScalarInput]);
+    ASSERT_EQ(0u, s[Kernel::Transform].calls);  // only the public kernels
+
+    resetStats();
+    ThreadPool pool(2);
+    parallelTransform(a, c, Twice(), pool);
+    ASSERT_EQ(1u, statsSnapshot()[Kernel::ParallelTransform].calls);
+    ASSERT_EQ(1000u, statsSnapshot()[Kernel::ParallelTransform].values);
+}
+
+#ifdef HAVE_SSE
+TEST(simd, stats_dispatch) {
+    resetStats();
+    int32_t a[20] = {}, b[20] = {};
+    dispatch::multiply(a, b, a, 20);
+    dispatch::lowest(a, b, a, 20);
+
+    StatsSnapshot s = statsSnapshot();
+    ASSERT_EQ(2u, s[Kernel::Dispatch].calls);
+    ASSERT_EQ(40u, s[Kernel::Dispatch].values);
+    ASSERT_EQ(2u, s.dispatched[static_cast<int>(activeIsa())]);
+}
+#endif
+
+TEST(simd, stats_names) {
+    ASSERT_STREQ("aligned_load", counterName(Counter::AlignedLoad));
+    ASSERT_STREQ("scalar_input", counterName(Counter::ScalarInput));
+    ASSERT_STREQ("transform", kernelName(Kernel::Transform));
+    ASSERT_STREQ("dispatch", kernelName(Kernel::Dispatch));
+    for (int k = 0; k < static_cast<int>(Kernel::Count); k++) {
+        ASSERT_LT(0u, strlen(kernelName(static_cast<Kernel>(k))));
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include "simd.hpp"
+#include <vector>
+
+using namespace sight;
+
+namespace {
+
+struct Lowest {
+    template <typename V>
+    V operator()(const V& a, const V& b) const {
+        return lowest(a, b);
+    }
+};
+
+template <typename V, int K>
+void checkDot() {
+    const int L = V::lanes;
+    for (size_t length : {0, 1, 7, 16, 33, 100, 1001}) {
+        AlignedStorage<float, 64> x(length), w(length);
+        float expected = 0;
+        for (size_t i = 0; i < length; i++) {
+            x[i] = static_cast<float>(i % 13) - 6;
+            w[i] = static_cast<float>(i % 5);
+            expected += x[i] * w[i];
+        }
+
+        MultiAccumulator<V, K> acc(V(0));
+        int calls = 0;
+        size_t i = unrolled<V, K>(0, length, [&](size_t j, int k) {
+            acc[k] = fma(V::loadu(x + j), V::loadu(w + j), acc[k]);
+            calls++;
+        });
+        ASSERT_EQ(length / L * L, i);
+        ASSERT_EQ(static_cast<int>(length / L), calls);
+        float total = acc.sum();
+        for (; i < length; i++) {
+            total += x[i] * w[i];
+        }
+        ASSERT_EQ(expected, total) << length;  // small integers stay exact
+    }
+}
+
+}  // namespace
+
+TEST(simd, unroll_repeat) {
+    std::vector<int> order;
+    repeat<5>([&](int k) { order.push_back(k); });
+    ASSERT_EQ(std::vector<int>({0, 1, 2, 3, 4}), order);
+    repeat<0>([&](int) { order.clear(); });
+    ASSERT_EQ(5u, order.size());
+}
+
+TEST(simd, unroll_accumulators) {
+    checkDot<Vect128f, 1>();
+    checkDot<Vect128f, 4>();
+    checkDot<NativeVectf, 3>();
+    checkDot<NativeVectf, 8>();
+
+    // groups of K, then one at a time with accumulator 0
+    std::vector<size_t> starts;
+    std::vector<int> ks;
+    size_t end = unrolled<Vect128i, 2>(4, 27, [&](size_t j, int k) {
+        starts.push_back(j);
+        ks.push_back(k);
+    });
+    ASSERT_EQ(24u, end);
+    ASSERT_EQ(std::vector<size_t>({4, 8, 12, 16, 20}), starts);
+    ASSERT_EQ(std::vector<int>({0, 1, 0, 1, 0}), ks);
+
+    MultiAccumulator<Vect128i, 3> acc(Vect128i(9));
+    acc[0] = Vect128i(4, 8, 1, 7);
+    acc[2] = Vect128i(5, 2, 6, 0);
+    ASSERT_EQ(3, acc.count);
+    Vect128i low = acc.merge(Lowest());
+    ASSERT_EQ(4, low[0]);
+    ASSERT_EQ(2, low[1]);
+    ASSERT_EQ(1, low[2]);
+    ASSERT_EQ(0, low[3]);
+    ASSERT_EQ(4 + 8 + 1 + 7 + 5 + 2 + 6 + 0 + 36, acc.sum());
+}
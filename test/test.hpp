@@ -0,0 +1,332 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "simd.hpp"
+
+template <typename T, typename B>
+void checkEqual(const T& p, const B& p1, size_t size) {
+    for (int x = 0; x < size; x++) {
+        ASSERT_EQ(p[x], p1[x]);
+    }
+}
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/// Anonymous mapping that only gets memory for the pages that are written
+struct LargeMapping {
+    size_t bytes;
+    void* data;
+
+    explicit LargeMapping(size_t bytes)
+        : bytes(bytes),
+          data(mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0)) {}
+
+    ~LargeMapping() {
+        if (data != MAP_FAILED) {
+            munmap(data, bytes);
+        }
+    }
+
+    LargeMapping(const LargeMapping&) = delete;
+    LargeMapping& operator=(const LargeMapping&) = delete;
+};
+
+/// More values than an int can count, with a remainder for any vector
+const size_t beyondIntMax = (size_t(1) << 31) + 5;
+
+/// Checks hsum, hmin, hmax and extract for any vector width
+template <typename V>
+void checkHorizontal() {
+    typedef typename V::value_type T;
+    T in[V::lanes];
+    T sum = 0, low = 1000, high = -1000;
+    for (int x = 0; x < V::lanes; x++) {
+        in[x] = static_cast<T>((x * 7) % 5 - 2);
+        sum += in[x];
+        low = std::min(low, in[x]);
+        high = std::max(high, in[x]);
+    }
+
+    V v = V::loadu(in);
+    ASSERT_EQ(sum, hsum(v));
+    ASSERT_EQ(low, hmin(v));
+    ASSERT_EQ(high, hmax(v));
+    ASSERT_EQ(in[0], sight::extract<0>(v));
+    ASSERT_EQ(in[1], sight::extract<1>(v));
+    ASSERT_EQ(in[V::lanes - 1], sight::extract<V::lanes - 1>(v));
+}
+
+/// Checks dot on float vectors of any width
+template <typename V>
+void checkDot() {
+    float a[V::lanes], b[V::lanes];
+    float expected = 0;
+    for (int x = 0; x < V::lanes; x++) {
+        a[x] = x * 0.5f - 1;
+        b[x] = 3 - x * 0.25f;
+        expected += a[x] * b[x];
+    }
+    ASSERT_FLOAT_EQ(expected, dot(V::loadu(a), V::loadu(b)));
+}
+
+/// Checks fma, fms and fnma on float vectors of any width
+template <typename V>
+void checkFma() {
+    float a[V::lanes], b[V::lanes], c[V::lanes];
+    for (int x = 0; x < V::lanes; x++) {
+        a[x] = x * 0.5f - 1;
+        b[x] = 3 - x * 0.25f;
+        c[x] = x * 2.0f;
+    }
+    V va = V::loadu(a), vb = V::loadu(b), vc = V::loadu(c);
+    V r1 = fma(va, vb, vc), r2 = fms(va, vb, vc), r3 = fnma(va, vb, vc);
+    for (int x = 0; x < V::lanes; x++) {
+        ASSERT_FLOAT_EQ(a[x] * b[x] + c[x], r1[x]);
+        ASSERT_FLOAT_EQ(a[x] * b[x] - c[x], r2[x]);
+        ASSERT_FLOAT_EQ(c[x] - a[x] * b[x], r3[x]);
+    }
+}
+
+/// Checks the precise and refined sqrt / reciprocal variants
+template <typename V>
+void checkPrecision() {
+    float in[V::lanes];
+    for (int x = 0; x < V::lanes; x++) {
+        in[x] = 0.37f + x * 12.9f;
+    }
+    V v = V::loadu(in);
+    V root = sqrt_precise(v), inv_root = rsqrt_precise(v);
+    V inv = reciprocal_precise(v);
+    V inv_root2 = rsqrt_refined(v), inv2 = reciprocal_refined(v);
+    for (int x = 0; x < V::lanes; x++) {
+        ASSERT_EQ(std::sqrt(in[x]), root[x]);
+        ASSERT_EQ(1 / std::sqrt(in[x]), inv_root[x]);
+        ASSERT_EQ(1 / in[x], inv[x]);
+
+        double exact_inv_root = 1 / std::sqrt(static_cast<double>(in[x]));
+        double exact_inv = 1 / static_cast<double>(in[x]);
+        ASSERT_NEAR(1, inv_root2[x] / exact_inv_root, 1.0 / (1 << 21));
+        ASSERT_NEAR(1, inv2[x] / exact_inv, 1.0 / (1 << 21));
+    }
+}
+
+/// Checks select, any, all and none for any vector width
+template <typename V>
+void checkSelect() {
+    typedef typename V::value_type T;
+    T a[V::lanes], b[V::lanes];
+    for (int x = 0; x < V::lanes; x++) {
+        a[x] = static_cast<T>(x);
+        b[x] = static_cast<T>(V::lanes - 1 - x);
+    }
+    V va = V::loadu(a), vb = V::loadu(b);
+    V low = select(va < vb, va, vb), high = select(va < vb, vb, va);
+    for (int x = 0; x < V::lanes; x++) {
+        ASSERT_EQ(std::min(a[x], b[x]), low[x]);
+        ASSERT_EQ(std::max(a[x], b[x]), high[x]);
+    }
+
+    ASSERT_TRUE(any(va < vb));
+    ASSERT_FALSE(all(va < vb));
+    ASSERT_FALSE(none(va < vb));
+    ASSERT_TRUE(all(va == va));
+    ASSERT_TRUE(none(va != va));
+    ASSERT_FALSE(any(va > V(static_cast<T>(V::lanes))));
+}
+
+/// Distance between a float result and the exact value in ULP of the result
+inline double ulpError(float got, double expected) {
+    float e = static_cast<float>(expected);
+    double ulp = std::nextafter(std::fabs(e), INFINITY) - std::fabs(e);
+    return std::fabs(got - expected) / ulp;
+}
+
+/// Checks exp, log, sin, cos, tanh and pow against libm for any width
+template <typename V>
+void checkMath() {
+    const float inf = std::numeric_limits<float>::infinity();
+    float in[V::lanes];
+    for (float start = -80; start < 80; start += V::lanes * 0.37f) {
+        for (int x = 0; x < V::lanes; x++) {
+            in[x] = start + x * 0.37f;
+        }
+        V v = V::loadu(in);
+        V e = sight::exp(v), l = sight::log(v), s = sight::sin(v);
+        V c = sight::cos(v), t = sight::tanh(v), p = sight::pow(V(1.5f), v);
+        for (int x = 0; x < V::lanes; x++) {
+            double d = in[x];
+            ASSERT_LE(ulpError(e[x], std::exp(d)), 1);
+            if (in[x] > 0) {
+                ASSERT_LE(ulpError(l[x], std::log(d)), 1);
+            } else {
+                ASSERT_TRUE(std::isnan(l[x]) || (in[x] == 0 && l[x] == -inf));
+            }
+            ASSERT_LE(ulpError(s[x], std::sin(d)), 2.5);
+            ASSERT_LE(ulpError(c[x], std::cos(d)), 2.5);
+            ASSERT_LE(ulpError(t[x], std::tanh(d)), 1.5);
+            double ln = std::fabs(d * std::log(1.5));
+            ASSERT_LE(ulpError(p[x], std::pow(1.5, d)), 1 + 2 * ln);
+        }
+    }
+
+    V special = V(inf), nan = V(std::numeric_limits<float>::quiet_NaN());
+    ASSERT_EQ(inf, sight::exp(special)[0]);
+    ASSERT_EQ(0, sight::exp(V(-inf))[0]);
+    ASSERT_EQ(inf, sight::exp(V(100))[0]);
+    ASSERT_EQ(inf, sight::log(special)[0]);
+    ASSERT_EQ(-inf, sight::log(V(0))[0]);
+    ASSERT_FLOAT_EQ(std::log(1e-40f), sight::log(V(1e-40f))[0]);
+    ASSERT_EQ(1, sight::tanh(special)[0]);
+    ASSERT_EQ(-1, sight::tanh(V(-inf))[0]);
+    ASSERT_EQ(1, sight::pow(V(0), V(0))[0]);
+    ASSERT_EQ(0, sight::pow(V(0), V(2))[0]);
+    ASSERT_TRUE(std::isnan(sight::exp(nan)[0]));
+    ASSERT_TRUE(std::isnan(sight::log(nan)[0]));
+    ASSERT_TRUE(std::isnan(sight::sin(special)[0]));
+    ASSERT_TRUE(std::isnan(sight::cos(nan)[0]));
+    ASSERT_TRUE(std::isnan(sight::tanh(nan)[0]));
+}
+
+/// Checks load_partial and store_partial right before an unmapped page
+template <typename V>
+void checkPartial() {
+    typedef typename V::value_type T;
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    void* map = mmap(nullptr, 2 * page, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE(MAP_FAILED, map);
+    char* pages = static_cast<char*>(map);
+    ASSERT_EQ(0, mprotect(pages + page, page, PROT_NONE));
+
+    for (int n = 0; n <= V::lanes; n++) {
+        // so reading or writing past p + n crashes
+        T* p = reinterpret_cast<T*>(pages + page) - n;
+        p[-1] = static_cast<T>(99);
+        for (int i = 0; i < n; i++) {
+            p[i] = static_cast<T>(i + 1);
+        }
+
+        V v = V::load_partial(p, n);
+        for (int i = 0; i < V::lanes; i++) {
+            ASSERT_EQ(static_cast<T>(i < n ? i + 1 : 0), v[i]) << n;
+        }
+        V(static_cast<T>(7)).store_partial(p, n);
+        for (int i = 0; i < n; i++) {
+            ASSERT_EQ(static_cast<T>(7), p[i]) << n;
+        }
+        ASSERT_EQ(static_cast<T>(99), p[-1]) << n;
+    }
+    munmap(map, 2 * page);
+}
+
+/// Checks gather and scatter of a vector type with int32 indices
+template <typename V>
+void checkGather() {
+    typedef typename V::value_type T;
+    typedef sight::Vect<int32_t, V::lanes> VI;
+    T table[64];
+    for (int i = 0; i < 64; i++) {
+        table[i] = static_cast<T>(i * 3);
+    }
+    alignas(64) int32_t idx[V::lanes];
+    for (int l = 0; l < V::lanes; l++) {
+        idx[l] = (l * 7 + 5) % 64;
+    }
+
+    V g = gather(table, VI::load(idx));
+    T out[64] = {};
+    scatter(out, VI::load(idx), g);
+    for (int l = 0; l < V::lanes; l++) {
+        ASSERT_EQ(table[idx[l]], g[l]);
+        ASSERT_EQ(table[idx[l]], out[idx[l]]);
+    }
+
+    // the last lane wins for repeated indices
+    alignas(64) T values[V::lanes];
+    for (int l = 0; l < V::lanes; l++) {
+        values[l] = static_cast<T>(l + 1);
+    }
+    scatter(out, VI(9), V::load(values));
+    ASSERT_EQ(static_cast<T>(V::lanes), out[9]);
+}
+
+inline void checkSameFloat(float expected, float got, float x) {
+    if (std::isnan(expected)) {
+        ASSERT_TRUE(std::isnan(got)) << x;
+    } else {
+        ASSERT_EQ(expected, got) << x;
+        ASSERT_EQ(std::signbit(expected), std::signbit(got)) << x;
+    }
+}
+
+template <typename V>
+void checkRounding() {
+    typedef sight::Vect<int32_t, V::lanes> VI;
+    const float inf = std::numeric_limits<float>::infinity();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float values[] = {
+        0.0f, -0.0f, 0.4f, -0.4f, 0.5f, -0.5f, 0.49999997f, -0.49999997f,
+        1.5f, -1.5f, 2.5f, -2.5f, 3.7f, -3.7f, 1e-40f, -1e-40f,
+        8388607.5f, -8388607.5f, 8388609.0f, 1e10f, -1e10f, 3e9f, 4.3e9f,
+        2147483520.0f, -2147483648.0f, inf, -inf, nan};
+    const int count = sizeof(values) / sizeof(values[0]);
+
+    for (int start = 0; start < count; start += V::lanes) {
+        alignas(64) float in[V::lanes] = {};
+        for (int l = 0; l < V::lanes && start + l < count; l++) {
+            in[l] = values[start + l];
+        }
+        V v = V::load(in);
+        V nearest = round_nearest(v), down = floor(v), up = ceil(v),
+          zero = trunc(v);
+        VI rounded = round(v), saturated = to_int_saturated(v),
+           unsigned_ = to_uint_saturated(v), fast = to_int_nearest(v);
+
+        for (int l = 0; l < V::lanes; l++) {
+            float x = in[l];
+            checkSameFloat(std::nearbyint(x), nearest[l], x);
+            checkSameFloat(std::floor(x), down[l], x);
+            checkSameFloat(std::ceil(x), up[l], x);
+            checkSameFloat(std::trunc(x), zero[l], x);
+
+            if (std::isnan(x)) {
+                ASSERT_EQ(0, saturated[l]);
+                ASSERT_EQ(0, unsigned_[l]);
+                continue;
+            }
+            if (std::fabs(x) < 2147483648.0f) {
+                ASSERT_EQ(std::lround(x), rounded[l]) << x;
+                ASSERT_EQ(static_cast<long>(std::nearbyint(x)), fast[l]) << x;
+            }
+            double clamped = std::max(-2147483648.0,
+                                      std::min(2147483647.0, double(x)));
+            ASSERT_EQ(static_cast<int32_t>(clamped), saturated[l]) << x;
+            double uclamped = std::max(0.0,
+                                       std::min(4294967295.0, double(x)));
+            ASSERT_EQ(static_cast<uint32_t>(uclamped),
+                      static_cast<uint32_t>(unsigned_[l])) << x;
+        }
+    }
+
+    const uint32_t bits[] = {0u, 1u, 0x7FFFFFFFu, 0x80000000u, 0x80000001u,
+                             0xFFFFFF7Fu, 0xFFFFFF80u, 0xFFFFFFFFu, 16777217u,
+                             123456789u, 4000000000u};
+    const int nbits = sizeof(bits) / sizeof(bits[0]);
+    for (int start = 0; start < nbits; start += V::lanes) {
+        alignas(64) int32_t in[V::lanes] = {};
+        for (int l = 0; l < V::lanes && start + l < nbits; l++) {
+            in[l] = static_cast<int32_t>(bits[start + l]);
+        }
+        V f = to_float_unsigned(VI::load(in));
+        for (int l = 0; l < V::lanes; l++) {
+            uint32_t u = static_cast<uint32_t>(in[l]);
+            ASSERT_EQ(static_cast<float>(u), f[l]) << u;
+        }
+    }
+}